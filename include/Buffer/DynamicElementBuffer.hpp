@@ -14,6 +14,15 @@ namespace GL {
 
 	};
 
+	class DynamicElementBuffer16 : public DynamicBuffer<unsigned short> {
+	public:
+
+		DynamicElementBuffer16(unsigned int length, unsigned int GPUlength, unsigned int numStackElements, bool emptyOnInit = false, float CPU_growRate = 1.5f, float GPU_growRate = 2.0f, float stack_growRate = 1.5f);
+		DynamicElementBuffer16(unsigned int length, unsigned int GPUlength, bool emptyOnInit = false, float CPU_growRate = 1.5f, float GPU_growRate = 2.0f);
+		DynamicElementBuffer16(unsigned int length, bool emptyOnInit = false, float CPU_growRate = 1.5f, float GPU_growRate = 2.0f);
+
+	};
+
 }
 
 #endif
\ No newline at end of file
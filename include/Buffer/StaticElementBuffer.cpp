@@ -1,4 +1,6 @@
 
 #include "./StaticElementBuffer.hpp"
 
-GL::StaticElementBuffer::StaticElementBuffer(unsigned int length) : StaticBuffer<unsigned int>(length, GL_ELEMENT_ARRAY_BUFFER, GL_STATIC_DRAW) { }
\ No newline at end of file
+GL::StaticElementBuffer::StaticElementBuffer(unsigned int length) : StaticBuffer<unsigned int>(length, GL_ELEMENT_ARRAY_BUFFER, GL_STATIC_DRAW) { }
+
+GL::StaticElementBuffer16::StaticElementBuffer16(unsigned int length) : StaticBuffer<unsigned short>(length, GL_ELEMENT_ARRAY_BUFFER, GL_STATIC_DRAW) { }
\ No newline at end of file
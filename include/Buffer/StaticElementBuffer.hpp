@@ -10,6 +10,11 @@ namespace GL {
 		StaticElementBuffer(unsigned int length);
 	};
 
+	class StaticElementBuffer16 : public StaticBuffer<unsigned short> {
+	public:
+		StaticElementBuffer16(unsigned int length);
+	};
+
 }
 
 #endif
\ No newline at end of file
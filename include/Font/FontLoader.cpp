@@ -87,7 +87,7 @@ void GL::FontLoader::save(const char* filepath) const {
 #ifdef NO_FREETYPE
 GL::FontLoader::FontLoader(const char* filepath) {
 
-	ReadBinaryFile rbf(filepath);
+	ReadBinaryFile rbf(filepath, 1024, true);
 
 	char verify[4];
 	for (int i = 0; i < 4; i++) verify[i] = rbf.read<char>();
@@ -114,7 +114,7 @@ GL::FontLoader::FontLoader(const char* filepath) {
 
 		int s = gInfo.size.x * gInfo.size.y;
 		gInfo.data = (s > 0) ? new uchar[s] : nullptr;
-		for (int i = 0; i < s; i++) gInfo.data[i] = rbf.read<uchar>();
+		if (s > 0) memcpy(gInfo.data, rbf.view(s), s);
 
 		info[i] = gInfo;
 
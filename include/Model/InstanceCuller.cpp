@@ -0,0 +1,240 @@
+#include "./InstanceCuller.hpp"
+
+GL::Program* GL::InstanceCuller::cullProgram = nullptr;
+
+GL::UniformTable* GL::InstanceCuller::cullUniforms = nullptr;
+
+GL::Program* GL::InstanceCuller::pyramidProgram = nullptr;
+
+GL::UniformTable* GL::InstanceCuller::pyramidUniforms = nullptr;
+
+GL::InstanceCuller::InstanceCuller() {
+
+	if (!cullProgram) {
+
+		ShaderLoader cullShader(ShaderType::COMPUTE);
+		cullShader.init(cull_cs, false);
+
+		cullProgram = new Program();
+		cullProgram->init(cullShader);
+
+		cullUniforms = new UniformTable(*cullProgram);
+		cullUniforms->init(
+			"PV", UniformType::MAT4, 1u,
+			"boxStart", UniformType::VEC3, 1u,
+			"boxEnd", UniformType::VEC3, 1u,
+			"numInstances", UniformType::UINT, 1u,
+			"usesDepthPyramid", UniformType::INT, 1u,
+			"depthPyramid", UniformType::INT, 1u,
+			"pyramidPV", UniformType::MAT4, 1u,
+			"numPyramidLevels", UniformType::INT, 1u
+		);
+		cullUniforms->set("depthPyramid", (int)_GL_InstanceCuller_textureUnit);
+
+		ShaderLoader pyramidShader(ShaderType::COMPUTE);
+		pyramidShader.init(pyramid_cs, false);
+
+		pyramidProgram = new Program();
+		pyramidProgram->init(pyramidShader);
+
+		pyramidUniforms = new UniformTable(*pyramidProgram);
+		pyramidUniforms->init(
+			"isFirstLevel", UniformType::INT, 1u,
+			"depthSampler", UniformType::INT, 1u,
+			"sourceSize", UniformType::IVEC2, 1u,
+			"destinationSize", UniformType::IVEC2, 1u
+		);
+		pyramidUniforms->set("depthSampler", (int)_GL_InstanceCuller_textureUnit);
+
+	}
+
+}
+
+void GL::InstanceCuller::cull(GL::ModelInstanceBuffer& instances, GL::BoundingBox localBB, GL::mat4 PV, unsigned int numCommands, bool useDepthPyramid) {
+
+	useDepthPyramid = useDepthPyramid && hasPyramid;
+
+	cullUniforms->set("PV", PV);
+	cullUniforms->set("boxStart", localBB.start);
+	cullUniforms->set("boxEnd", localBB.end);
+	cullUniforms->set("numInstances", instances.getLength());
+	cullUniforms->set("usesDepthPyramid", (useDepthPyramid) ? 1 : 0);
+	cullUniforms->set("pyramidPV", pyramidPV);
+	cullUniforms->set("numPyramidLevels", (int)numPyramidLevels);
+	cullUniforms->update();
+
+	if (useDepthPyramid) {
+
+		glActiveTexture(GL_TEXTURE0 + _GL_InstanceCuller_textureUnit);
+		glBindTexture(GL_TEXTURE_2D, pyramid);
+
+	}
+
+	instances.bind();
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4u, instances.commandBuffer);
+
+	cullProgram->dispatchCompute(uvec3((instances.getLength() + _GL_InstanceCuller_groupSize - 1u) / _GL_InstanceCuller_groupSize, 1u, 1u), false);
+	glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT | GL_COMMAND_BARRIER_BIT);
+
+	// The shader counts into the first command only, the other meshes draw the same instances.
+	glBindBuffer(GL_COPY_READ_BUFFER, instances.commandBuffer);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, instances.commandBuffer);
+	for (unsigned int i = 1u; i < numCommands; i++) glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, sizeof(GLuint), (5u * i + 1u) * sizeof(GLuint), sizeof(GLuint));
+
+}
+
+void GL::InstanceCuller::buildDepthPyramid(const GL::DepthStencilRenderTexture& depth, GL::mat4 PV) {
+
+	if (!pyramid || pyramidWidth != depth.width() || pyramidHeight != depth.height()) {
+
+		if (pyramid) glDeleteTextures(1, &pyramid);
+
+		pyramidWidth = depth.width();
+		pyramidHeight = depth.height();
+		numPyramidLevels = 1u;
+		while ((max(pyramidWidth, pyramidHeight) >> numPyramidLevels) > 0u) numPyramidLevels++;
+
+		glGenTextures(1, &pyramid);
+		glBindTexture(GL_TEXTURE_2D, pyramid);
+		glTexStorage2D(GL_TEXTURE_2D, numPyramidLevels, GL_R32F, pyramidWidth, pyramidHeight);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+	}
+
+	glActiveTexture(GL_TEXTURE0 + _GL_InstanceCuller_textureUnit);
+	glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, depth.getID());
+
+	for (unsigned int level = 0u; level < numPyramidLevels; level++) {
+
+		uvec2 destinationSize(max(pyramidWidth >> level, 1u), max(pyramidHeight >> level, 1u));
+		uvec2 sourceSize = (level) ? uvec2(max(pyramidWidth >> (level - 1u), 1u), max(pyramidHeight >> (level - 1u), 1u)) : destinationSize;
+
+		pyramidUniforms->set("isFirstLevel", (level) ? 0 : 1);
+		pyramidUniforms->set("sourceSize", ivec2(sourceSize.x, sourceSize.y));
+		pyramidUniforms->set("destinationSize", ivec2(destinationSize.x, destinationSize.y));
+		pyramidUniforms->update();
+
+		if (level) glBindImageTexture(0u, pyramid, level - 1u, GL_FALSE, 0, GL_READ_ONLY, GL_R32F);
+		glBindImageTexture(1u, pyramid, level, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+
+		uvec3 numWorkGroups((destinationSize.x + _GL_InstanceCuller_pyramidGroupSize - 1u) / _GL_InstanceCuller_pyramidGroupSize, (destinationSize.y + _GL_InstanceCuller_pyramidGroupSize - 1u) / _GL_InstanceCuller_pyramidGroupSize, 1u);
+		pyramidProgram->dispatchCompute(numWorkGroups, false);
+		glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+
+	}
+
+	glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+
+	pyramidPV = PV;
+	hasPyramid = true;
+
+}
+
+void GL::InstanceCuller::invalidateDepthPyramid() { hasPyramid = false; }
+
+GL::InstanceCuller::~InstanceCuller() { if (pyramid) glDeleteTextures(1, &pyramid); }
+
+const char* GL::InstanceCuller::cull_cs = \
+\
+"#version 430 core\n \
+\
+layout(local_size_x = 64) in; \
+\
+layout(std430, binding = 0) readonly buffer modelMatrixInstances { mat4 modelMatrices[]; }; \
+layout(std430, binding = 3) writeonly buffer visibleInstanceList { uint visibleInstances[]; }; \
+layout(std430, binding = 4) buffer cullCommands { uint commands[]; }; \
+\
+uniform mat4 PV; \
+uniform vec3 boxStart; \
+uniform vec3 boxEnd; \
+uniform uint numInstances; \
+uniform int usesDepthPyramid; \
+uniform sampler2D depthPyramid; \
+uniform mat4 pyramidPV; \
+uniform int numPyramidLevels; \
+\
+vec4 getCorner(uint i) { return vec4(mix(boxStart, boxEnd, vec3(float(i & 1u), float((i >> 1u) & 1u), float((i >> 2u) & 1u))), 1.0f); } \
+\
+bool isOutsideFrustum(mat4 model) { \
+	mat4 M = PV * model; \
+	uint outside = 63u; \
+	for (uint i = 0u; i < 8u; i++) { \
+		vec4 corner = M * getCorner(i); \
+		uint code = 0u; \
+		if (corner.x < -corner.w) code |= 1u; \
+		if (corner.x > corner.w) code |= 2u; \
+		if (corner.y < -corner.w) code |= 4u; \
+		if (corner.y > corner.w) code |= 8u; \
+		if (corner.z < -corner.w) code |= 16u; \
+		if (corner.z > corner.w) code |= 32u; \
+		outside &= code; \
+	} \
+	return outside != 0u; \
+} \
+\
+bool isOccluded(mat4 model) { \
+	mat4 M = pyramidPV * model; \
+	vec2 minimum = vec2(1.0f); \
+	vec2 maximum = vec2(0.0f); \
+	float nearest = 1.0f; \
+	for (uint i = 0u; i < 8u; i++) { \
+		vec4 corner = M * getCorner(i); \
+		if (corner.w <= 0.0f) return false; \
+		vec3 position = corner.xyz / corner.w * 0.5f + 0.5f; \
+		minimum = min(minimum, position.xy); \
+		maximum = max(maximum, position.xy); \
+		nearest = min(nearest, position.z); \
+	} \
+	minimum = clamp(minimum, 0.0f, 1.0f); \
+	maximum = clamp(maximum, 0.0f, 1.0f); \
+	vec2 size = (maximum - minimum) * vec2(textureSize(depthPyramid, 0)); \
+	int level = clamp(int(ceil(log2(max(max(size.x, size.y), 1.0f)))), 0, numPyramidLevels - 1); \
+	ivec2 levelSize = textureSize(depthPyramid, level); \
+	ivec2 start = clamp(ivec2(minimum * vec2(levelSize)), ivec2(0), levelSize - 1); \
+	ivec2 end = clamp(ivec2(maximum * vec2(levelSize)), ivec2(0), levelSize - 1); \
+	float farthest = max( \
+		max(texelFetch(depthPyramid, start, level).r, texelFetch(depthPyramid, ivec2(end.x, start.y), level).r), \
+		max(texelFetch(depthPyramid, ivec2(start.x, end.y), level).r, texelFetch(depthPyramid, end, level).r) \
+	); \
+	return nearest > farthest; \
+} \
+\
+void main() { \
+	uint instance = gl_GlobalInvocationID.x; \
+	if (instance >= numInstances) return; \
+	mat4 model = modelMatrices[instance]; \
+	if (isOutsideFrustum(model)) return; \
+	if (usesDepthPyramid == 1 && isOccluded(model)) return; \
+	visibleInstances[atomicAdd(commands[1], 1u)] = instance; \
+}";
+
+const char* GL::InstanceCuller::pyramid_cs = \
+\
+"#version 430 core\n \
+\
+layout(local_size_x = 8, local_size_y = 8) in; \
+\
+layout(r32f, binding = 0) readonly uniform image2D sourceLevel; \
+layout(r32f, binding = 1) writeonly uniform image2D destinationLevel; \
+uniform sampler2DMS depthSampler; \
+uniform int isFirstLevel; \
+uniform ivec2 sourceSize; \
+uniform ivec2 destinationSize; \
+\
+void main() { \
+	ivec2 position = ivec2(gl_GlobalInvocationID.xy); \
+	if (position.x >= destinationSize.x || position.y >= destinationSize.y) return; \
+	float depth = 0.0f; \
+	if (isFirstLevel == 1) { \
+		for (int i = 0; i < 4; i++) depth = max(depth, texelFetch(depthSampler, position, i).r); \
+	} \
+	else { \
+		ivec2 start = (position * sourceSize) / destinationSize; \
+		ivec2 end = max(((position + 1) * sourceSize + destinationSize - 1) / destinationSize, start + 1); \
+		for (int y = start.y; y < end.y; y++) for (int x = start.x; x < end.x; x++) depth = max(depth, imageLoad(sourceLevel, ivec2(x, y)).r); \
+	} \
+	imageStore(destinationLevel, position, vec4(depth)); \
+}";
@@ -0,0 +1,53 @@
+#ifndef INSTANCECULLER_HPP
+#define INSTANCECULLER_HPP
+
+#include "./../util/util.hpp"
+#include "./../Program/Program.hpp"
+#include "./../Uniform/UniformTable.hpp"
+#include "./../Framebuffer/RenderTexture.hpp"
+#include "./ModelInstanceBuffer.hpp"
+#include "./ModelStructs.hpp"
+
+#define _GL_InstanceCuller_groupSize 64u
+#define _GL_InstanceCuller_pyramidGroupSize 8u
+#define _GL_InstanceCuller_textureUnit 15u
+
+namespace GL {
+
+	// Culls the instances of a ModelInstanceBuffer on the GPU. The indices of the instances whose bounding box is inside the frustum
+	// (and, if a depth pyramid of the last frame exists, not behind its depth) are compacted into the visible instance list and
+	// counted into the instanceCount of the indirect draw commands, so no instance data goes back to the CPU.
+	class InstanceCuller : public _util {
+	public:
+
+		InstanceCuller();
+
+		void cull(ModelInstanceBuffer& instances, BoundingBox localBB, mat4 PV, unsigned int numCommands, bool useDepthPyramid);
+
+		// Builds a max depth mip chain from a multisampled depth texture, used for occlusion culling in the next frame.
+		void buildDepthPyramid(const DepthStencilRenderTexture& depth, mat4 PV);
+
+		void invalidateDepthPyramid();
+
+		~InstanceCuller();
+
+	private:
+
+		GLuint pyramid = 0u;
+		unsigned int pyramidWidth = 0u, pyramidHeight = 0u, numPyramidLevels = 0u;
+		mat4 pyramidPV;
+		bool hasPyramid = false;
+
+		static Program* cullProgram;
+		static UniformTable* cullUniforms;
+		static Program* pyramidProgram;
+		static UniformTable* pyramidUniforms;
+
+		static const char* cull_cs;
+		static const char* pyramid_cs;
+
+	};
+
+}
+
+#endif
@@ -0,0 +1,513 @@
+#include "./MeshOptimizer.hpp"
+
+#ifdef BUILD_MODEL_CONVERTER
+
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+#include <unordered_map>
+
+void GL::MeshOptimizer::optimizeVertexCache(unsigned int* indices, unsigned int numIndices, unsigned int numVertices, std::vector<unsigned int>* clusters) {
+
+	unsigned int numTriangles = numIndices / 3u;
+	if (clusters) clusters->assign(1u, 0u);
+	if (numTriangles == 0u) return;
+
+	std::vector<unsigned int> adjacencyOffsets(numVertices + 1u, 0u);
+	for (unsigned int i = 0u; i < 3u * numTriangles; i++) adjacencyOffsets[indices[i] + 1u]++;
+	for (unsigned int i = 0u; i < numVertices; i++) adjacencyOffsets[i + 1u] += adjacencyOffsets[i];
+
+	std::vector<unsigned int> adjacency(3u * numTriangles);
+	std::vector<unsigned int> adjacencyFill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+	for (unsigned int i = 0u; i < 3u * numTriangles; i++) adjacency[adjacencyFill[indices[i]]++] = i / 3u;
+
+	std::vector<int> liveTriangles(numVertices);
+	for (unsigned int i = 0u; i < numVertices; i++) liveTriangles[i] = (int)(adjacencyOffsets[i + 1u] - adjacencyOffsets[i]);
+
+	std::vector<unsigned int> cacheTimes(numVertices, 0u);
+	std::vector<bool> emitted(numTriangles, false);
+	std::vector<unsigned int> deadEnds;
+	std::vector<unsigned int> candidates;
+	std::vector<unsigned int> output;
+	output.reserve(3u * numTriangles);
+
+	unsigned int timestamp = _GL_MeshOptimizer_cacheSize + 1u;
+	unsigned int cursor = 0u;
+	int fanningVertex = (int)indices[0];
+
+	while (fanningVertex >= 0) {
+
+		candidates.clear();
+
+		for (unsigned int i = adjacencyOffsets[fanningVertex]; i < adjacencyOffsets[fanningVertex + 1]; i++) {
+
+			unsigned int triangle = adjacency[i];
+			if (emitted[triangle]) continue;
+
+			for (unsigned int j = 0u; j < 3u; j++) {
+
+				unsigned int vertex = indices[3u * triangle + j];
+
+				output.push_back(vertex);
+				deadEnds.push_back(vertex);
+				candidates.push_back(vertex);
+				liveTriangles[vertex]--;
+
+				if (timestamp - cacheTimes[vertex] > _GL_MeshOptimizer_cacheSize) cacheTimes[vertex] = timestamp++;
+
+			}
+
+			emitted[triangle] = true;
+
+		}
+
+		int nextVertex = -1;
+		int bestPriority = -1;
+
+		for (unsigned int i = 0u; i < candidates.size(); i++) {
+
+			unsigned int vertex = candidates[i];
+			if (liveTriangles[vertex] <= 0) continue;
+
+			int priority = 0;
+			if (timestamp - cacheTimes[vertex] + 2u * (unsigned int)liveTriangles[vertex] <= _GL_MeshOptimizer_cacheSize) priority = (int)(timestamp - cacheTimes[vertex]);
+
+			if (priority > bestPriority) {
+
+				bestPriority = priority;
+				nextVertex = (int)vertex;
+
+			}
+
+		}
+
+		if (nextVertex == -1) {
+
+			while (!deadEnds.empty() && nextVertex == -1) {
+
+				unsigned int vertex = deadEnds.back();
+				deadEnds.pop_back();
+				if (liveTriangles[vertex] > 0) nextVertex = (int)vertex;
+
+			}
+
+			while (cursor < numVertices && nextVertex == -1) {
+
+				if (liveTriangles[cursor] > 0) nextVertex = (int)cursor;
+				cursor++;
+
+			}
+
+			if (nextVertex != -1 && clusters) clusters->push_back(output.size() / 3u);
+
+		}
+
+		fanningVertex = nextVertex;
+
+	}
+
+	memcpy(indices, output.data(), sizeof(unsigned int) * output.size());
+
+}
+
+void GL::MeshOptimizer::optimizeOverdraw(unsigned int* indices, unsigned int numIndices, const vec3* positions, std::vector<unsigned int>& clusters) {
+
+	unsigned int numTriangles = numIndices / 3u;
+	if (numTriangles == 0u || clusters.empty()) return;
+
+	unsigned int numVertices = 0u;
+	for (unsigned int i = 0u; i < 3u * numTriangles; i++) if (indices[i] + 1u > numVertices) numVertices = indices[i] + 1u;
+
+	float ACMR, ATVR;
+	simulateVertexCache(indices, 3u * numTriangles, numVertices, ACMR, ATVR);
+	float threshold = ACMR * _GL_MeshOptimizer_softBoundaryThreshold;
+
+	std::vector<unsigned int> cacheTimes(numVertices, 0u);
+	unsigned int timestamp = _GL_MeshOptimizer_cacheSize + 1u;
+	std::vector<unsigned int> softClusters;
+
+	for (unsigned int i = 0u; i < clusters.size(); i++) {
+
+		unsigned int end = (i + 1u < clusters.size()) ? clusters[i + 1u] : numTriangles;
+		unsigned int clusterStart = clusters[i];
+		unsigned int clusterMisses = 0u;
+
+		timestamp += _GL_MeshOptimizer_cacheSize + 1u;
+		softClusters.push_back(clusterStart);
+
+		for (unsigned int j = clusters[i]; j < end; j++) {
+
+			clusterMisses += countCacheMisses(indices + 3u * j, 3u, cacheTimes, timestamp);
+
+			if (j + 1u < end && (float)clusterMisses <= threshold * (float)(j + 1u - clusterStart)) {
+
+				clusterStart = j + 1u;
+				clusterMisses = 0u;
+				timestamp += _GL_MeshOptimizer_cacheSize + 1u;
+				softClusters.push_back(clusterStart);
+
+			}
+
+		}
+
+	}
+
+	vec3 meshCenter;
+	float meshArea = 0.0f;
+	std::vector<float> sortKeys(softClusters.size());
+	std::vector<vec3> clusterCenters(softClusters.size());
+	std::vector<vec3> clusterNormals(softClusters.size());
+
+	for (unsigned int i = 0u; i < softClusters.size(); i++) {
+
+		unsigned int end = (i + 1u < softClusters.size()) ? softClusters[i + 1u] : numTriangles;
+		float clusterArea = 0.0f;
+
+		for (unsigned int j = softClusters[i]; j < end; j++) {
+
+			vec3 a = positions[indices[3u * j]], b = positions[indices[3u * j + 1u]], c = positions[indices[3u * j + 2u]];
+			vec3 normal = cross(b - a, c - a);
+			float area = length(normal);
+
+			clusterCenters[i] += (a + b + c) * (area / 3.0f);
+			clusterNormals[i] += normal;
+			clusterArea += area;
+
+		}
+
+		meshCenter += clusterCenters[i];
+		meshArea += clusterArea;
+		if (clusterArea > 0.0f) clusterCenters[i] /= clusterArea;
+
+	}
+
+	if (meshArea > 0.0f) meshCenter /= meshArea;
+
+	for (unsigned int i = 0u; i < softClusters.size(); i++) {
+
+		float normalLength = length(clusterNormals[i]);
+		sortKeys[i] = (normalLength > 0.0f) ? dot(clusterCenters[i] - meshCenter, clusterNormals[i] / normalLength) : 0.0f;
+
+	}
+
+	std::vector<unsigned int> order(softClusters.size());
+	for (unsigned int i = 0u; i < order.size(); i++) order[i] = i;
+	std::stable_sort(order.begin(), order.end(), [&sortKeys](unsigned int a, unsigned int b) { return sortKeys[a] > sortKeys[b]; });
+
+	std::vector<unsigned int> output;
+	output.reserve(3u * numTriangles);
+	clusters.clear();
+
+	for (unsigned int i = 0u; i < order.size(); i++) {
+
+		unsigned int start = softClusters[order[i]];
+		unsigned int end = (order[i] + 1u < softClusters.size()) ? softClusters[order[i] + 1u] : numTriangles;
+
+		clusters.push_back(output.size() / 3u);
+		output.insert(output.end(), indices + 3u * start, indices + 3u * end);
+
+	}
+
+	memcpy(indices, output.data(), sizeof(unsigned int) * output.size());
+
+}
+
+unsigned int GL::MeshOptimizer::optimizeVertexFetch(char* vertexData, unsigned int vertexSize, unsigned int numVertices, unsigned int* indices, unsigned int numIndices) {
+
+	std::vector<unsigned int> remap(numVertices, ~0u);
+	unsigned int numUsedVertices = 0u;
+
+	for (unsigned int i = 0u; i < numIndices; i++) {
+
+		if (remap[indices[i]] == ~0u) remap[indices[i]] = numUsedVertices++;
+		indices[i] = remap[indices[i]];
+
+	}
+
+	char* reordered = new char[numUsedVertices * vertexSize];
+	for (unsigned int i = 0u; i < numVertices; i++) if (remap[i] != ~0u) memcpy(reordered + remap[i] * vertexSize, vertexData + i * vertexSize, vertexSize);
+
+	memcpy(vertexData, reordered, numUsedVertices * vertexSize);
+	delete[] reordered;
+
+	return numUsedVertices;
+
+}
+
+void GL::MeshOptimizer::simulateVertexCache(const unsigned int* indices, unsigned int numIndices, unsigned int numVertices, float& ACMR, float& ATVR) {
+
+	std::vector<unsigned int> cacheTimes(numVertices, 0u);
+	unsigned int timestamp = _GL_MeshOptimizer_cacheSize + 1u;
+	unsigned int misses = countCacheMisses(indices, numIndices, cacheTimes, timestamp);
+
+	std::vector<bool> used(numVertices, false);
+	unsigned int numUsedVertices = 0u;
+	for (unsigned int i = 0u; i < numIndices; i++) if (!used[indices[i]]) { used[indices[i]] = true; numUsedVertices++; }
+
+	ACMR = (numIndices >= 3u) ? (float)misses / (float)(numIndices / 3u) : 0.0f;
+	ATVR = (numUsedVertices) ? (float)misses / (float)numUsedVertices : 0.0f;
+
+}
+
+unsigned int GL::MeshOptimizer::simplify(unsigned int* destination, const unsigned int* indices, unsigned int numIndices, const vec3* positions, unsigned int numVertices, unsigned int targetNumIndices, float& error) {
+
+	error = 0.0f;
+	std::vector<unsigned int> result(indices, indices + 3u * (numIndices / 3u));
+
+	std::vector<unsigned int> sortedVertices(numVertices);
+	for (unsigned int i = 0u; i < numVertices; i++) sortedVertices[i] = i;
+
+	auto lessPosition = [positions](unsigned int a, unsigned int b) {
+
+		if (positions[a].x != positions[b].x) return positions[a].x < positions[b].x;
+		if (positions[a].y != positions[b].y) return positions[a].y < positions[b].y;
+		return positions[a].z < positions[b].z;
+
+	};
+
+	std::sort(sortedVertices.begin(), sortedVertices.end(), lessPosition);
+
+	std::vector<unsigned int> canonical(numVertices);
+	std::vector<unsigned int> numWedges(numVertices, 0u);
+
+	for (unsigned int i = 0u; i < numVertices; i++) {
+
+		unsigned int vertex = sortedVertices[i];
+		canonical[vertex] = (i && !lessPosition(sortedVertices[i - 1u], vertex)) ? canonical[sortedVertices[i - 1u]] : vertex;
+		numWedges[canonical[vertex]]++;
+
+	}
+
+	auto edgeKey = [&canonical](unsigned int a, unsigned int b) {
+
+		a = canonical[a];
+		b = canonical[b];
+		return (a < b) ? (((unsigned long long)a << 32) | b) : (((unsigned long long)b << 32) | a);
+
+	};
+
+	std::unordered_map<unsigned long long, unsigned int> edgeUses;
+	for (unsigned int i = 0u; i < result.size(); i++) edgeUses[edgeKey(result[i], result[3u * (i / 3u) + (i + 1u) % 3u])]++;
+
+	std::vector<unsigned int> numBorderEdges(numVertices, 0u);
+	std::vector<Quadric> quadrics(numVertices);
+
+	for (unsigned int i = 0u; i < result.size(); i += 3u) {
+
+		vec3 normal = cross(positions[result[i + 1u]] - positions[result[i]], positions[result[i + 2u]] - positions[result[i]]);
+		float area = length(normal);
+		if (area > 0.0f) normal /= area;
+
+		for (unsigned int k = 0u; k < 3u; k++) {
+
+			unsigned int a = result[i + k], b = result[i + (k + 1u) % 3u];
+			if (area > 0.0f) quadrics[canonical[a]].addPlane(normal, -dot(normal, positions[a]), 0.5 * area);
+			if (edgeUses[edgeKey(a, b)] != 1u) continue;
+
+			numBorderEdges[canonical[a]]++;
+			numBorderEdges[canonical[b]]++;
+
+			vec3 edge = positions[b] - positions[a];
+			vec3 borderNormal = cross(edge, normal);
+			float borderLength = length(borderNormal);
+			if (area == 0.0f || borderLength == 0.0f) continue;
+
+			borderNormal /= borderLength;
+			quadrics[canonical[a]].addPlane(borderNormal, -dot(borderNormal, positions[a]), _GL_MeshOptimizer_borderWeight * dot(edge, edge));
+			quadrics[canonical[b]].addPlane(borderNormal, -dot(borderNormal, positions[a]), _GL_MeshOptimizer_borderWeight * dot(edge, edge));
+
+		}
+
+	}
+
+	// 0: collapses freely, 1: border vertex that collapses along border edges only, 2: locked
+	std::vector<unsigned char> kinds(numVertices, 2u);
+	for (unsigned int i = 0u; i < numVertices; i++) if (canonical[i] == i && numWedges[i] == 1u) {
+
+		if (numBorderEdges[i] == 0u) kinds[i] = 0u;
+		else if (numBorderEdges[i] == 2u) kinds[i] = 1u;
+
+	}
+
+	struct Collapse { unsigned int from, to; double cost; };
+	std::vector<Collapse> collapses;
+	std::vector<unsigned int> adjacencyOffsets, adjacencyFill, adjacency;
+	std::vector<unsigned int> remap(numVertices);
+	std::vector<bool> locked;
+	double maxCost = 0.0;
+
+	for (unsigned int pass = 0u; pass < _GL_MeshOptimizer_maxSimplifyPasses && result.size() > targetNumIndices; pass++) {
+
+		adjacencyOffsets.assign(numVertices + 1u, 0u);
+		for (unsigned int i = 0u; i < result.size(); i++) adjacencyOffsets[canonical[result[i]] + 1u]++;
+		for (unsigned int i = 0u; i < numVertices; i++) adjacencyOffsets[i + 1u] += adjacencyOffsets[i];
+
+		adjacency.resize(result.size());
+		adjacencyFill.assign(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+		for (unsigned int i = 0u; i < result.size(); i++) adjacency[adjacencyFill[canonical[result[i]]]++] = i / 3u;
+
+		edgeUses.clear();
+		for (unsigned int i = 0u; i < result.size(); i++) edgeUses[edgeKey(result[i], result[3u * (i / 3u) + (i + 1u) % 3u])]++;
+
+		collapses.clear();
+		for (unsigned int i = 0u; i < result.size(); i++) {
+
+			unsigned int ends[2] = { result[i], result[3u * (i / 3u) + (i + 1u) % 3u] };
+
+			for (unsigned int j = 0u; j < 2u; j++) {
+
+				unsigned int from = ends[j], to = ends[1u - j];
+				unsigned char kind = kinds[canonical[from]];
+
+				if (kind == 2u || canonical[from] == canonical[to]) continue;
+				if (kind == 1u && edgeUses[edgeKey(from, to)] != 1u) continue;
+
+				collapses.push_back(Collapse{ from, to, quadrics[canonical[from]].evaluate(positions[to]) });
+
+			}
+
+		}
+
+		std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) { return a.cost < b.cost; });
+
+		for (unsigned int i = 0u; i < numVertices; i++) remap[i] = i;
+		locked.assign(numVertices, false);
+
+		unsigned int numTrianglesToRemove = (result.size() - targetNumIndices + 2u) / 3u;
+		unsigned int numTrianglesRemoved = 0u;
+		unsigned int numCollapses = 0u;
+
+		for (unsigned int i = 0u; i < collapses.size() && numTrianglesRemoved < numTrianglesToRemove; i++) {
+
+			unsigned int from = canonical[collapses[i].from], to = canonical[collapses[i].to];
+			if (locked[from] || locked[to]) continue;
+
+			bool flips = false;
+
+			for (unsigned int j = adjacencyOffsets[from]; j < adjacencyOffsets[from + 1u] && !flips; j++) {
+
+				const unsigned int* triangle = &result[3u * adjacency[j]];
+				unsigned int corner = 0u;
+				bool degenerates = false;
+
+				for (unsigned int k = 0u; k < 3u; k++) {
+
+					if (canonical[triangle[k]] == from) corner = k;
+					if (canonical[triangle[k]] == to) degenerates = true;
+
+				}
+
+				if (!degenerates) flips = flipsTriangle(positions[triangle[0]], positions[triangle[1]], positions[triangle[2]], positions[collapses[i].to], corner);
+
+			}
+
+			if (flips) continue;
+
+			for (unsigned int j = adjacencyOffsets[from]; j < adjacencyOffsets[from + 1u]; j++) {
+
+				for (unsigned int k = 0u; k < 3u; k++) locked[canonical[result[3u * adjacency[j] + k]]] = true;
+
+			}
+
+			locked[to] = true;
+			remap[collapses[i].from] = collapses[i].to;
+			quadrics[to].add(quadrics[from]);
+			maxCost = std::max(maxCost, collapses[i].cost);
+
+			numTrianglesRemoved += (kinds[from] == 1u) ? 1u : 2u;
+			numCollapses++;
+
+		}
+
+		if (numCollapses == 0u) break;
+
+		unsigned int numKept = 0u;
+
+		for (unsigned int i = 0u; i < result.size(); i += 3u) {
+
+			unsigned int a = remap[result[i]], b = remap[result[i + 1u]], c = remap[result[i + 2u]];
+			if (canonical[a] == canonical[b] || canonical[b] == canonical[c] || canonical[c] == canonical[a]) continue;
+
+			result[numKept++] = a;
+			result[numKept++] = b;
+			result[numKept++] = c;
+
+		}
+
+		result.resize(numKept);
+
+	}
+
+	error = (float)std::sqrt(maxCost);
+	if (!result.empty()) memcpy(destination, result.data(), sizeof(unsigned int) * result.size());
+
+	return result.size();
+
+}
+
+unsigned int GL::MeshOptimizer::countCacheMisses(const unsigned int* indices, unsigned int numIndices, std::vector<unsigned int>& cacheTimes, unsigned int& timestamp) {
+
+	unsigned int misses = 0u;
+
+	for (unsigned int i = 0u; i < numIndices; i++) if (timestamp - cacheTimes[indices[i]] > _GL_MeshOptimizer_cacheSize) {
+
+		cacheTimes[indices[i]] = timestamp++;
+		misses++;
+
+	}
+
+	return misses;
+
+}
+
+void GL::MeshOptimizer::Quadric::addPlane(GL::vec3 normal, float distance, double planeWeight) {
+
+	double a = normal.x, b = normal.y, c = normal.z, d = distance;
+
+	a2 += planeWeight * a * a;
+	b2 += planeWeight * b * b;
+	c2 += planeWeight * c * c;
+	d2 += planeWeight * d * d;
+	ab += planeWeight * a * b;
+	ac += planeWeight * a * c;
+	ad += planeWeight * a * d;
+	bc += planeWeight * b * c;
+	bd += planeWeight * b * d;
+	cd += planeWeight * c * d;
+	weight += planeWeight;
+
+}
+
+void GL::MeshOptimizer::Quadric::add(const GL::MeshOptimizer::Quadric& other) {
+
+	a2 += other.a2; b2 += other.b2; c2 += other.c2; d2 += other.d2;
+	ab += other.ab; ac += other.ac; ad += other.ad;
+	bc += other.bc; bd += other.bd; cd += other.cd;
+	weight += other.weight;
+
+}
+
+double GL::MeshOptimizer::Quadric::evaluate(GL::vec3 position) const {
+
+	if (weight <= 0.0) return 0.0;
+
+	double x = position.x, y = position.y, z = position.z;
+	double error = a2 * x * x + b2 * y * y + c2 * z * z + d2 + 2.0 * (ab * x * y + ac * x * z + ad * x + bc * y * z + bd * y + cd * z);
+
+	return std::max(error / weight, 0.0);
+
+}
+
+bool GL::MeshOptimizer::flipsTriangle(GL::vec3 a, GL::vec3 b, GL::vec3 c, GL::vec3 replacement, unsigned int replacedCorner) {
+
+	vec3 corners[3] = { a, b, c };
+	vec3 before = cross(b - a, c - a);
+
+	corners[replacedCorner] = replacement;
+	vec3 after = cross(corners[1] - corners[0], corners[2] - corners[0]);
+
+	return dot(before, after) <= 0.0f;
+
+}
+
+#endif
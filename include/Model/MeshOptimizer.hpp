@@ -0,0 +1,62 @@
+#ifndef MESHOPTIMIZER_HPP
+#define MESHOPTIMIZER_HPP
+
+#ifdef BUILD_MODEL_CONVERTER
+
+#include <vector>
+
+#include "./../util/GL-math.hpp"
+
+#define _GL_MeshOptimizer_cacheSize 16u
+#define _GL_MeshOptimizer_softBoundaryThreshold 1.05f
+#define _GL_MeshOptimizer_borderWeight 10.0
+#define _GL_MeshOptimizer_maxSimplifyPasses 100u
+
+namespace GL {
+
+	class MeshOptimizer {
+	public:
+
+		// Reorders the triangles for post-transform vertex cache locality (Tipsify). If clusters is given,
+		// it receives the index of the first triangle of every cluster, starting a new one wherever the cache was flushed.
+		static void optimizeVertexCache(unsigned int* indices, unsigned int numIndices, unsigned int numVertices, std::vector<unsigned int>* clusters = nullptr);
+
+		// Splits the clusters further where the vertex cache is warm enough, then draws those facing away from the mesh center first.
+		static void optimizeOverdraw(unsigned int* indices, unsigned int numIndices, const vec3* positions, std::vector<unsigned int>& clusters);
+
+		// Renumbers the vertices in the order they are first used and drops unused ones, returns the new number of vertices.
+		static unsigned int optimizeVertexFetch(char* vertexData, unsigned int vertexSize, unsigned int numVertices, unsigned int* indices, unsigned int numIndices);
+
+		// Simulates a FIFO vertex cache, giving the average cache miss ratio per triangle (ACMR) and per used vertex (ATVR).
+		static void simulateVertexCache(const unsigned int* indices, unsigned int numIndices, unsigned int numVertices, float& ACMR, float& ATVR);
+
+		// Collapses edges onto existing vertices in order of quadric error until at most targetNumIndices remain, so the result
+		// can share the vertex buffer of the source mesh. Border vertices only slide along the border, seam vertices are kept.
+		// Writes the new indices to destination (numIndices large), returns their number and the largest collapse error (in mesh units).
+		static unsigned int simplify(unsigned int* destination, const unsigned int* indices, unsigned int numIndices, const vec3* positions, unsigned int numVertices, unsigned int targetNumIndices, float& error);
+
+	private:
+
+		struct Quadric {
+
+			double a2 = 0.0, b2 = 0.0, c2 = 0.0, d2 = 0.0;
+			double ab = 0.0, ac = 0.0, ad = 0.0, bc = 0.0, bd = 0.0, cd = 0.0;
+			double weight = 0.0;
+
+			void addPlane(vec3 normal, float distance, double planeWeight);
+			void add(const Quadric& other);
+			double evaluate(vec3 position) const;
+
+		};
+
+		static bool flipsTriangle(vec3 a, vec3 b, vec3 c, vec3 replacement, unsigned int replacedCorner);
+
+		static unsigned int countCacheMisses(const unsigned int* indices, unsigned int numIndices, std::vector<unsigned int>& cacheTimes, unsigned int& timestamp);
+
+	};
+
+}
+
+#endif
+
+#endif
@@ -25,6 +25,10 @@ void GL::Model::setAmbientOcclusion(float value) { ao = clamp(value, 0.0f, 1.0f)
 
 void GL::Model::setShadowOcclusion(float value) { shadowOcclusion = clamp(value, 0.0f, 1.0f); }
 
+void GL::Model::setLodTolerance(float tolerance) { lodTolerance = std::max(tolerance, 0.0f); }
+
+void GL::Model::setShadowLodBias(unsigned int numLevels) { shadowLodBias = numLevels; }
+
 void GL::Model::setInstanceBuffer(GL::ModelInstanceBuffer& instances) { instancesBuf = &instances; shouldUseInstances = true; }
 
 void GL::Model::useInstances(bool use) { shouldUseInstances = use; }
@@ -41,6 +45,10 @@ float GL::Model::getAmbientOcclusion() const { return ao; }
 
 float GL::Model::getShadowOcclusion() const { return shadowOcclusion; }
 
+float GL::Model::getLodTolerance() const { return lodTolerance; }
+
+unsigned int GL::Model::getShadowLodBias() const { return shadowLodBias; }
+
 unsigned int GL::Model::getNumAnimations() const { return modelData[thisModelDataIndex].numAnimations; }
 
 GL::BoundingBox GL::Model::getBoundingBox() const {
@@ -55,10 +63,17 @@ GL::BoundingBox GL::Model::getWorldSpaceBoundingBoxApproximation() const {
 	if (modelData[thisModelDataIndex].numAnimations) throw Exception("An animated model has no default bounding box.");
 	
 	BoundingBox bb = modelData[thisModelDataIndex].bbox;
-	return BoundingBox(
-		(this->getModelMatrix() * toVec4(bb.start))(0, 1, 2),
-		(this->getModelMatrix() * toVec4(bb.end))(0, 1, 2)
-	);
+	vec3 start, end;
+
+	for (unsigned int i = 0u; i < 8u; i++) {
+
+		vec3 corner = (this->getModelMatrix() * vec4((i & 1u) ? bb.end.x : bb.start.x, (i & 2u) ? bb.end.y : bb.start.y, (i & 4u) ? bb.end.z : bb.start.z, 1.0f))(0, 1, 2);
+		start = (i == 0u) ? corner : min(start, corner);
+		end = (i == 0u) ? corner : max(end, corner);
+
+	}
+
+	return BoundingBox(start, end);
 
 }
 
@@ -75,17 +90,138 @@ void GL::Model::playAnimation(unsigned int index, bool loop) {
 	isAnimationFinished = false;
 	t0 = 0.0f;
 	timer.reset();
+	poseVersion++;
 
 }
 
-void GL::Model::stopAnimation() { isAnimationPlaying = false; isAnimationFinished = true; }
+void GL::Model::stopAnimation() { isAnimationPlaying = false; isAnimationFinished = true; poseVersion++; }
 
-void GL::Model::resetAnimation() { animationIndex = 0u; t = 0.0f; t0 = 0.0f; isAnimationPlaying = false; isAnimationFinished = false; }
+void GL::Model::resetAnimation() { animationIndex = 0u; t = 0.0f; t0 = 0.0f; isAnimationPlaying = false; isAnimationFinished = false; poseVersion++; }
 
 bool GL::Model::isAnimationDone() const { return isAnimationFinished; }
 
+unsigned int GL::Model::addAnimationLayer(unsigned int animationIndex, float weight, bool additive) {
+
+	if (!modelData[thisModelDataIndex].numAnimations) throw Exception("The model has no animations.");
+
+	Model_types::AnimationLayer layer;
+	layer.animation = animationIndex % modelData[thisModelDataIndex].numAnimations;
+	layer.weight = weight;
+	layer.additive = additive;
+	animationLayers.push_back(layer);
+	poseVersion++;
+
+	return animationLayers.size() - 1u;
+
+}
+
+void GL::Model::setAnimationLayer(unsigned int layer, unsigned int animationIndex, float time) {
+
+	if (layer >= animationLayers.size()) throw Exception("Invalid animation layer " + std::to_string(layer) + ".");
+
+	Model_types::AnimationLayer& l = animationLayers[layer];
+	l.animation = animationIndex % modelData[thisModelDataIndex].numAnimations;
+	l.time = time;
+	l.fadeDuration = 0.0f;
+	poseVersion++;
+
+}
+
+void GL::Model::setAnimationLayerWeight(unsigned int layer, float weight) {
+
+	if (layer >= animationLayers.size()) throw Exception("Invalid animation layer " + std::to_string(layer) + ".");
+
+	animationLayers[layer].weight = weight;
+	poseVersion++;
+
+}
+
+void GL::Model::setAnimationLayerMask(unsigned int layer, unsigned int boneNode) {
+
+	if (layer >= animationLayers.size()) throw Exception("Invalid animation layer " + std::to_string(layer) + ".");
+	if (boneNode != _GL_Model_noBoneMask && boneNode >= modelData[thisModelDataIndex].numBoneNodes) throw Exception("The bone node of the mask does not exist.");
+
+	animationLayers[layer].maskNode = boneNode;
+	poseVersion++;
+
+}
+
+void GL::Model::crossfadeAnimationLayer(unsigned int layer, unsigned int animationIndex, float seconds) {
+
+	if (layer >= animationLayers.size()) throw Exception("Invalid animation layer " + std::to_string(layer) + ".");
+
+	Model_types::AnimationLayer& l = animationLayers[layer];
+	l.fadeAnimation = l.animation;
+	l.fadeTime = l.time;
+	l.fadeDuration = max(seconds, 0.0f);
+	l.fadeElapsed = 0.0f;
+	l.animation = animationIndex % modelData[thisModelDataIndex].numAnimations;
+	l.time = 0.0f;
+	poseVersion++;
+
+}
+
+void GL::Model::advanceAnimationLayers(float seconds) {
+
+	for (unsigned int i = 0u; i < animationLayers.size(); i++) {
+
+		Model_types::AnimationLayer& l = animationLayers[i];
+		l.time += seconds;
+		l.fadeTime += seconds;
+		l.fadeElapsed += seconds;
+		if (l.fadeElapsed >= l.fadeDuration) l.fadeDuration = 0.0f;
+
+	}
+
+	if (!animationLayers.empty()) poseVersion++;
+
+}
+
+void GL::Model::clearAnimationLayers() { animationLayers.clear(); poseVersion++; }
+
+unsigned int GL::Model::getNumAnimationLayers() const { return animationLayers.size(); }
+
+const GL::Model_types::AnimationLayer& GL::Model::getAnimationLayer(unsigned int layer) const {
+
+	if (layer >= animationLayers.size()) throw Exception("Invalid animation layer " + std::to_string(layer) + ".");
+	return animationLayers[layer];
+
+}
+
+bool GL::Model::isPoseChanging() const { return isAnimationPlaying || hasInstancePoses(); }
+
+unsigned int GL::Model::getPoseVersion() const { return poseVersion; }
+
 bool GL::Model::isInstanced() const { return instancesBuf && shouldUseInstances; }
 
+unsigned int GL::Model::getInstanceVersion() const { return (isInstanced()) ? instancesBuf->getChangeVersion() : 0u; }
+
+bool GL::Model::hasInstancePoses() const { return isInstanced() && instancesBuf->hasAnimations() && modelData[thisModelDataIndex].numAnimations; }
+
+void GL::Model::useGpuSkinning(bool use) { gpuSkinning = use; skinnedPoseVersion = ~0u; }
+
+bool GL::Model::usesGpuSkinning() const { return gpuSkinning; }
+
+unsigned int GL::Model::getShadowLodKey(GL::Scene& scene) const {
+
+	float projectedSize = getProjectedSize(scene);
+	unsigned int key = 0u;
+
+	for (unsigned int i = 0u; i < modelData[thisModelDataIndex].numMeshes; i++) {
+
+		if (modelData[thisModelDataIndex].lods[i].empty()) continue;
+
+		const Model_types::LevelOfDetail& lod = selectLod(i, projectedSize, shadowLodBias);
+		key = key * 31u + (unsigned int)(&lod - modelData[thisModelDataIndex].lods[i].data());
+
+	}
+
+	return key;
+
+}
+
+bool GL::Model::isPreSkinned() const { return gpuSkinning && isAnimated() && modelData[thisModelDataIndex].numAnimations && !isInstanced(); }
+
 void GL::Model::setSamplingFactor3D(GL::TextureType type, float value) {
 
 	if (value <= 0.0f) value = _GL_Model_defaultStretch;
@@ -122,6 +258,11 @@ void GL::Model::draw(GL::Scene& scene, GL::SampleSettings reqSettings) {
 
 	}
 
+	float projectedSize = getProjectedSize(scene);
+
+	bool isCulled = !program && usesInstanceCulling();
+	if (isCulled) cullInstances(scene, projectedSize);
+
 	for (int i = 0; i < modelData[thisModelDataIndex].numMeshes; i++) {
 
 		if (!modelData[thisModelDataIndex].vaos[i]) continue;
@@ -156,19 +297,20 @@ void GL::Model::draw(GL::Scene& scene, GL::SampleSettings reqSettings) {
 			if (mat.metallicRoughnessTex) program->markUnitAsOccupied(METALLIC_ROUGHNESS_TEXTURE_UNIT, true);
 			for (unsigned int j = 0u; j < scene.getNumPointLights(); j++) program->markUnitAsOccupied(8u + j, true);
 			if (scene.getOverheadShadowFarPlane() > 0.0f) program->markUnitAsOccupied(14u, true);
-			if (scene.getOverheadOuterShadowFarPlane() > 0.0f) program->markUnitAsOccupied(15u, true);
 			
 			ModelFormat format;
 			format.hasAlbedoMap = mat.baseTex;
 			format.hasMetallicRoughnessMap = mat.metallicRoughnessTex;
 			format.hasNormalMap = mat.normalTex;
 			format.hasShadowMap = scene.getNumPointLights() || (scene.getOverheadShadowFarPlane() > 0.0f);
-			format.isAnimated = isAnimated();
+			format.isAnimated = isAnimated() && !isPreSkinned();
 
 			program->prepareForUse(format);
 			UniformTable& ut = program->getUniformTable();
 
 			ut.set("isInstanced", (instances) ? 1 : 0);
+			ut.set("_hasInstancePoses", (hasInstancePoses()) ? 1 : 0);
+			ut.set("_derivesNormalMatrix", (instances && instances->derivesNormalMatrices()) ? 1 : 0);
 			ut.set("_color", customColor ? (upscale<vec4>(albedoColor) + vec4(0.0f, 0.0f, 0.0f, 1.0f)) : mat.baseColor);
 			ut.set("metallic", metallic);
 			ut.set("roughness", roughness);
@@ -176,14 +318,13 @@ void GL::Model::draw(GL::Scene& scene, GL::SampleSettings reqSettings) {
 			if (format.hasShadowMap) {
 
 				for (unsigned int j = 0u; j < 6u; j++) ut.setElement("_hasShadowSampler", j, (j < scene.getNumPointLights()) ? 1 : 0);
-				ut.setElement("_overheadPVMatrix", 0u, scene.getOverheadShadowPVMatrix());
-				ut.setElement("_overheadFarPlane", 0u, scene.getOverheadShadowFarPlane());
-				ut.setElement("_bboxStart", 0u, scene.getOverheadShadowBoundingBox().start);
-				ut.setElement("_bboxEnd", 0u, scene.getOverheadShadowBoundingBox().end);
-				ut.setElement("_overheadPVMatrix", 1u, scene.getOverheadOuterShadowPVMatrix());
-				ut.setElement("_overheadFarPlane", 1u, scene.getOverheadOuterShadowFarPlane());
-				ut.setElement("_bboxStart", 1u, scene.getOverheadOuterShadowBoundingBox().start);
-				ut.setElement("_bboxEnd", 1u, scene.getOverheadOuterShadowBoundingBox().end);
+				ut.set("_numOverheadShadowMaps", (int)scene.getNumOverheadShadowMaps());
+				for (unsigned int j = 0u; j < scene.getNumOverheadShadowMaps(); j++) {
+
+					ut.setElement("_overheadPVMatrix", j, scene.getOverheadShadowPVMatrix(j));
+					ut.setElement("_overheadFarPlane", j, scene.getOverheadShadowFarPlane(j));
+
+				}
 				ut.set("overheadLightDirection", scene.getOverheadLightDirection());
 				ut.set("overheadLightColor", scene.getOverheadLightColor());
 
@@ -195,45 +336,117 @@ void GL::Model::draw(GL::Scene& scene, GL::SampleSettings reqSettings) {
 		}
 		else {
 
-			int idx = getProgramIndex((bool)modelData[thisModelDataIndex].boneNodes, scene.hasBackground(), albedoType, normalType, (mat.metallicRoughnessTex > 0u), metallicType, roughnessType);
+			int idx = getProgramIndex(isAnimated() && !isPreSkinned(), scene.hasBackground(), albedoType, normalType, (mat.metallicRoughnessTex > 0u), metallicType, roughnessType);
 			compileProgram(idx);
 
-			PBR_uniforms[idx]->set("metallic", metallic);
-			PBR_uniforms[idx]->set("roughness", roughness);
-			PBR_uniforms[idx]->set("ao", ao);
-			PBR_uniforms[idx]->set("shadowOcclusion", shadowOcclusion);
-			PBR_uniforms[idx]->set("albedoStretch", albedoStretch);
-			PBR_uniforms[idx]->set("metallicStretch", metallicStretch);
-			PBR_uniforms[idx]->set("roughnessStretch", roughnessStretch);
-			PBR_uniforms[idx]->set("normalStretch", normalStretch);
-			PBR_uniforms[idx]->set("inColor", customColor ? (upscale<vec4>(albedoColor) + vec4(0.0f, 0.0f, 0.0f, 1.0f)) : mat.baseColor);
-			PBR_uniforms[idx]->set("bgColor", scene.getBackgroundColor());
-			PBR_uniforms[idx]->set("bgBrightness", scene.getBackgroundBrightness());
-			for (unsigned int j = 0u; j < 6u; j++) PBR_uniforms[idx]->setElement("hasShadowSampler", j, (j < scene.getNumPointLights()) ? 1 : 0);
-			PBR_uniforms[idx]->setElement("overheadPVMatrix", 0u, scene.getOverheadShadowPVMatrix());
-			PBR_uniforms[idx]->setElement("overheadFarPlane", 0u, scene.getOverheadShadowFarPlane());
-			PBR_uniforms[idx]->setElement("bboxStart", 0u, scene.getOverheadShadowBoundingBox().start);
-			PBR_uniforms[idx]->setElement("bboxEnd", 0u, scene.getOverheadShadowBoundingBox().end);
-			PBR_uniforms[idx]->setElement("overheadPVMatrix", 1u, scene.getOverheadOuterShadowPVMatrix());
-			PBR_uniforms[idx]->setElement("overheadFarPlane", 1u, scene.getOverheadOuterShadowFarPlane());
-			PBR_uniforms[idx]->setElement("bboxStart", 1u, scene.getOverheadOuterShadowBoundingBox().start);
-			PBR_uniforms[idx]->setElement("bboxEnd", 1u, scene.getOverheadOuterShadowBoundingBox().end);
-			PBR_uniforms[idx]->set("overheadLightDirection", scene.getOverheadLightDirection());
-			PBR_uniforms[idx]->set("overheadLightColor", scene.getOverheadLightColor());
-			PBR_uniforms[idx]->set("isInstanced", (instances) ? 1 : 0);
+			PBR_uniforms[idx]->set(PBR_handles[idx].metallic, metallic);
+			PBR_uniforms[idx]->set(PBR_handles[idx].roughness, roughness);
+			PBR_uniforms[idx]->set(PBR_handles[idx].ao, ao);
+			PBR_uniforms[idx]->set(PBR_handles[idx].shadowOcclusion, shadowOcclusion);
+			PBR_uniforms[idx]->set(PBR_handles[idx].albedoStretch, albedoStretch);
+			PBR_uniforms[idx]->set(PBR_handles[idx].metallicStretch, metallicStretch);
+			PBR_uniforms[idx]->set(PBR_handles[idx].roughnessStretch, roughnessStretch);
+			PBR_uniforms[idx]->set(PBR_handles[idx].normalStretch, normalStretch);
+			PBR_uniforms[idx]->set(PBR_handles[idx].inColor, customColor ? (upscale<vec4>(albedoColor) + vec4(0.0f, 0.0f, 0.0f, 1.0f)) : mat.baseColor);
+			setSceneUniforms(idx, scene);
+			PBR_uniforms[idx]->set(PBR_handles[idx].isInstanced, (instances) ? ((isCulled) ? 3 : 1) : 0);
+			PBR_uniforms[idx]->set(PBR_handles[idx].derivesNormalMatrix, (instances && instances->derivesNormalMatrices()) ? 1 : 0);
+			PBR_uniforms[idx]->set(PBR_handles[idx].hasInstancePoses, (hasInstancePoses()) ? 1 : 0);
 			PBR_uniforms[idx]->update();
 			PBR_programs[idx]->use();
 
 		}
 
-		glBindVertexArray(modelData[thisModelDataIndex].vaos[i]);
-		if (instances) glDrawElementsInstanced(GL_TRIANGLES, modelData[thisModelDataIndex].numElements[i], GL_UNSIGNED_INT, nullptr, instances->getLength());
-		else glDrawElements(GL_TRIANGLES, modelData[thisModelDataIndex].numElements[i], GL_UNSIGNED_INT, nullptr);
+		const Model_types::LevelOfDetail& lod = selectLod(i, projectedSize, 0u);
+		GLenum indexType = modelData[thisModelDataIndex].indexTypes[i];
+		const void* firstIndex = (const void*)(size_t)(lod.firstIndex * ((indexType == GL_UNSIGNED_SHORT) ? sizeof(unsigned short) : sizeof(unsigned int)));
+
+		if (isPreSkinned()) {
+
+			glBindVertexArray(skinnedVertices->getVertexArray(i));
+			setVertexQuantization(Model_types::VertexQuantization());
+
+		}
+		else {
+
+			glBindVertexArray(modelData[thisModelDataIndex].vaos[i]);
+			setVertexQuantization(modelData[thisModelDataIndex].quantization[i]);
+
+		}
+
+		if (isCulled) {
+
+			glBindBuffer(GL_DRAW_INDIRECT_BUFFER, instances->commandBuffer);
+			glDrawElementsIndirect(GL_TRIANGLES, indexType, (const void*)(i * sizeof(RenderQueue_types::IndirectCommand)));
+
+		}
+		else if (instances) glDrawElementsInstanced(GL_TRIANGLES, lod.numElements, indexType, firstIndex, instances->getLength());
+		else glDrawElements(GL_TRIANGLES, lod.numElements, indexType, firstIndex);
 
 	}
 
 }
 
+bool GL::Model::enqueue(GL::RenderQueue& queue, GL::Scene& scene, GL::SampleSettings reqSettings) {
+
+	if (shouldUseProg || modelData[thisModelDataIndex].boneNodes) return false;
+	if (isInstanced() && isPhysicsModel) throw Exception("Physics models cannot be instanced.");
+
+	float projectedSize = getProjectedSize(scene);
+	float depth = 0.0f;
+
+	if (!isInstanced()) {
+
+		BoundingBox bb = getWorldSpaceBoundingBoxApproximation();
+		depth = length((bb.start + bb.end) * 0.5f - scene.getCameraPosition());
+
+	}
+
+	for (int i = 0; i < modelData[thisModelDataIndex].numMeshes; i++) {
+
+		if (!modelData[thisModelDataIndex].vaos[i]) continue;
+
+		Model_types::Material& mat = modelData[thisModelDataIndex].mats[modelData[thisModelDataIndex].matIndices[i]];
+
+		Model_types::SampleType albedoType = mat.baseTex ? Model_types::SampleType::TEXTURE_2D : (reqSettings.albedoTex3D ? Model_types::SampleType::TEXTURE_3D : Model_types::SampleType::UNIFORM);
+		Model_types::SampleType normalType = mat.normalTex ? Model_types::SampleType::TEXTURE_2D : (reqSettings.normalTex3D ? Model_types::SampleType::TEXTURE_3D : Model_types::SampleType::UNIFORM);
+		Model_types::SampleType metallicType = reqSettings.metallicTex3D ? Model_types::SampleType::TEXTURE_3D : Model_types::SampleType::UNIFORM;
+		Model_types::SampleType roughnessType = reqSettings.roughnessTex3D ? Model_types::SampleType::TEXTURE_3D : Model_types::SampleType::UNIFORM;
+
+		int idx = getProgramIndex(false, scene.hasBackground(), albedoType, normalType, (mat.metallicRoughnessTex > 0u), metallicType, roughnessType);
+		compileProgram(idx);
+
+		const Model_types::LevelOfDetail& lod = selectLod(i, projectedSize, 0u);
+		GLenum indexType = modelData[thisModelDataIndex].indexTypes[i];
+
+		RenderQueue_types::Item item;
+		item.model = this;
+		item.mesh = i;
+		item.program = idx;
+		item.textures[0] = mat.baseTex;
+		item.textures[1] = mat.metallicRoughnessTex;
+		item.textures[2] = mat.normalTex;
+		item.vao = modelData[thisModelDataIndex].vaos[i];
+		item.depth = depth;
+		item.numElements = lod.numElements;
+		item.indexType = indexType;
+		item.firstIndexOffset = lod.firstIndex * ((indexType == GL_UNSIGNED_SHORT) ? sizeof(unsigned short) : sizeof(unsigned int));
+
+		unsigned int pool = modelData[thisModelDataIndex].meshPools[i];
+		item.isIndirect = queue.usesIndirectDraws() && pool != _GL_Model_noMeshPool && !isInstanced();
+		item.meshVao = item.vao;
+		item.firstIndex = lod.firstIndex;
+		item.baseVertex = modelData[thisModelDataIndex].baseVertices[i];
+		if (item.isIndirect) item.vao = meshPools[pool].vao;
+
+		queue.push(item);
+
+	}
+
+	return true;
+
+}
+
 void GL::Model::drawShadow(GL::mat4 PV, GL::mat4 model, GL::Scene& scene) {
 
 	ModelInstanceBuffer* instances = nullptr;
@@ -244,11 +457,29 @@ void GL::Model::drawShadow(GL::mat4 PV, GL::mat4 model, GL::Scene& scene) {
 
 	if (instancesBuf) { instancesBuf->bind(); instancesBuf->update(); }
 
+	float projectedSize = getProjectedSize(scene);
+
 	for (unsigned int i = 0u; i < modelData[thisModelDataIndex].numMeshes; i++) {
 
-		glBindVertexArray(modelData[thisModelDataIndex].vaos_shadow[i]);
-		if (instances) glDrawElementsInstanced(GL_TRIANGLES, modelData[thisModelDataIndex].numElements[i], GL_UNSIGNED_INT, nullptr, instances->getLength());
-		else glDrawElements(GL_TRIANGLES, modelData[thisModelDataIndex].numElements[i], GL_UNSIGNED_INT, nullptr);
+		const Model_types::LevelOfDetail& lod = selectLod(i, projectedSize, shadowLodBias);
+		GLenum indexType = modelData[thisModelDataIndex].indexTypes[i];
+		const void* firstIndex = (const void*)(size_t)(lod.firstIndex * ((indexType == GL_UNSIGNED_SHORT) ? sizeof(unsigned short) : sizeof(unsigned int)));
+
+		if (isPreSkinned()) {
+
+			glBindVertexArray(skinnedVertices->getVertexArray(i));
+			setVertexQuantization(Model_types::VertexQuantization());
+
+		}
+		else {
+
+			glBindVertexArray(modelData[thisModelDataIndex].vaos_shadow[i]);
+			setVertexQuantization(modelData[thisModelDataIndex].quantization[i]);
+
+		}
+
+		if (instances) glDrawElementsInstanced(GL_TRIANGLES, lod.numElements, indexType, firstIndex, instances->getLength());
+		else glDrawElements(GL_TRIANGLES, lod.numElements, indexType, firstIndex);
 
 	}
 
@@ -256,119 +487,265 @@ void GL::Model::drawShadow(GL::mat4 PV, GL::mat4 model, GL::Scene& scene) {
 
 GL::Model::~Model() {
 		
+	if (boneModelMatrices) {
+
+		delete[] boneModelMatrices;
+		delete[] boneNormalMatrices;
+
+	}
+
+	if (skinnedVertices) delete skinnedVertices;
+	if (boneDataOwner == this) boneDataOwner = nullptr;
+
+	// A model whose load failed has already released its data.
+	if (thisModelDataIndex == _GL_Model_noModelData) return;
+
 	modelData[thisModelDataIndex].referenceCount--;
-	if (modelData[thisModelDataIndex].referenceCount == 0u) {
-		
-		modelData[thisModelDataIndex].name = nullptr;
+	if (modelData[thisModelDataIndex].referenceCount == 0u) evictModelData(thisModelDataIndex);
 
-		if (modelData[thisModelDataIndex].mats) {
+}
 
-			for (int i = 0; i < modelData[thisModelDataIndex].numMats; i++) {
+void GL::Model::releaseModelData(GL::Model_types::ModelData& data) {
 
-				if (modelData[thisModelDataIndex].mats[i].baseTex) glDeleteTextures(1, &modelData[thisModelDataIndex].mats[i].baseTex);
-				if (modelData[thisModelDataIndex].mats[i].normalTex) glDeleteTextures(1, &modelData[thisModelDataIndex].mats[i].normalTex);
-				if (modelData[thisModelDataIndex].mats[i].metallicRoughnessTex) glDeleteTextures(1, &modelData[thisModelDataIndex].mats[i].metallicRoughnessTex);
+	if (data.mats) {
 
-			}
+		for (int i = 0; i < data.numMats; i++) {
 
-			delete[] modelData[thisModelDataIndex].mats;
-			delete[] modelData[thisModelDataIndex].matFormats;
+			if (data.mats[i].baseTex) glDeleteTextures(1, &data.mats[i].baseTex);
+			if (data.mats[i].normalTex) glDeleteTextures(1, &data.mats[i].normalTex);
+			if (data.mats[i].metallicRoughnessTex) glDeleteTextures(1, &data.mats[i].metallicRoughnessTex);
 
 		}
 
-		if (modelData[thisModelDataIndex].vaos) {
+		delete[] data.mats;
+		delete[] data.matFormats;
 
-			for (unsigned int i = 0u; i < modelData[thisModelDataIndex].numMeshes; i++) if (modelData[thisModelDataIndex].vaos[i]) {
+	}
 
-				glDeleteVertexArrays(1, &modelData[thisModelDataIndex].vaos[i]);
-				glDeleteVertexArrays(1, &modelData[thisModelDataIndex].vaos_shadow[i]);
-				glDeleteBuffers(1, &modelData[thisModelDataIndex].vbos[i]);
-				glDeleteBuffers(1, &modelData[thisModelDataIndex].ebos[i]);
+	if (data.vaos) {
 
-			}
+		for (unsigned int i = 0u; i < data.numMeshes; i++) if (data.vaos[i]) {
 
-			delete[] modelData[thisModelDataIndex].vaos;
-			delete[] modelData[thisModelDataIndex].vaos_shadow;
-			delete[] modelData[thisModelDataIndex].vbos;
-			delete[] modelData[thisModelDataIndex].ebos;
-			delete[] modelData[thisModelDataIndex].numElements;
-			delete[] modelData[thisModelDataIndex].matIndices;
+			glDeleteVertexArrays(1, &data.vaos[i]);
+			glDeleteVertexArrays(1, &data.vaos_shadow[i]);
+
+			if (data.meshPools[i] != _GL_Model_noMeshPool) releaseMeshPool(data.meshPools[i]);
+			else {
+
+				glDeleteBuffers(1, &data.vbos[i]);
+				glDeleteBuffers(1, &data.ebos[i]);
+
+			}
 
 		}
 
-		if (modelData[thisModelDataIndex].boneNodes) {
+		delete[] data.vaos;
+		delete[] data.vaos_shadow;
+		delete[] data.vbos;
+		delete[] data.ebos;
+		delete[] data.numElements;
+		delete[] data.indexTypes;
+		delete[] data.matIndices;
+		delete[] data.quantization;
+		delete[] data.vertexLayouts;
+		delete[] data.lods;
+		delete[] data.meshPools;
+		delete[] data.baseVertices;
 
-			for (unsigned int i = 0u; i < modelData[thisModelDataIndex].numBoneNodes; i++) {
+	}
 
-				if (modelData[thisModelDataIndex].boneNodes[i].childIndices) delete[] modelData[thisModelDataIndex].boneNodes[i].childIndices;
-				if (modelData[thisModelDataIndex].boneNodes[i].animations) {
+	if (data.boneNodes) {
 
-					for (unsigned int j = 0u; j < modelData[thisModelDataIndex].numAnimations; j++) if (modelData[thisModelDataIndex].boneNodes[i].animations[j]) {
+		data.boneHierarchy.clear();
 
-						if (modelData[thisModelDataIndex].boneNodes[i].animations[j]->translations) delete[] modelData[thisModelDataIndex].boneNodes[i].animations[j]->translations;
-						if (modelData[thisModelDataIndex].boneNodes[i].animations[j]->rots) delete[] modelData[thisModelDataIndex].boneNodes[i].animations[j]->rots;
-						if (modelData[thisModelDataIndex].boneNodes[i].animations[j]->scalings) delete[] modelData[thisModelDataIndex].boneNodes[i].animations[j]->scalings;
+		for (unsigned int i = 0u; i < data.numBoneNodes; i++) {
 
-						delete[] modelData[thisModelDataIndex].boneNodes[i].animations[j];
+			if (data.boneNodes[i].childIndices) delete[] data.boneNodes[i].childIndices;
+			if (data.boneNodes[i].animations) {
 
-					}
+				for (unsigned int j = 0u; j < data.numAnimations; j++) if (data.boneNodes[i].animations[j]) {
 
-					delete[] modelData[thisModelDataIndex].boneNodes[i].animations;
+					if (data.boneNodes[i].animations[j]->translations) delete[] data.boneNodes[i].animations[j]->translations;
+					if (data.boneNodes[i].animations[j]->rots) delete[] data.boneNodes[i].animations[j]->rots;
+					if (data.boneNodes[i].animations[j]->scalings) delete[] data.boneNodes[i].animations[j]->scalings;
+
+					delete[] data.boneNodes[i].animations[j];
 
 				}
 
-			}
+				delete[] data.boneNodes[i].animations;
 
-			delete[] modelData[thisModelDataIndex].boneNodes;
+			}
 
 		}
 
-		if (modelData[thisModelDataIndex].animationData) delete[] modelData[thisModelDataIndex].animationData;
+		delete[] data.boneNodes;
+
+	}
+
+	if (data.animationData) delete[] data.animationData;
+
+}
+
+bool GL::Model::findModelData(const std::string& name, unsigned int& index) {
+
+	std::unordered_map<std::string, unsigned int>::iterator it = modelDataIndices.find(name);
+	if (it == modelDataIndices.end()) return false;
+
+	index = it->second;
+	return true;
+
+}
+
+unsigned int GL::Model::insertModelData(const std::string& name) {
+
+	unsigned int index;
+
+	if (freeModelDataIndices.size()) {
+
+		index = freeModelDataIndices.back();
+		freeModelDataIndices.pop_back();
+
+	}
+	else {
+
+		index = modelData.size();
+		modelData.push_back(Model_types::ModelData{ });
+
+	}
+
+	modelData[index].name = name;
+	modelData[index].referenceCount = 0u;
+	modelDataIndices[name] = index;
+	return index;
+
+}
+
+void GL::Model::evictModelData(unsigned int index) {
+
+	modelDataIndices.erase(modelData[index].name);
+	releaseModelData(modelData[index]);
+
+	modelData[index] = Model_types::ModelData{ };
+	freeModelDataIndices.push_back(index);
+
+}
+
+GL::Model_types::ModelFileInfo GL::Model::verifyModelFile(ReadBinaryFile& rbf, const char* filePath) {
+
+	Model_types::ModelFileInfo info;
+	info.version = 1u;
+
+	if (rbf.getFileLength() >= 5) {
+
+		const char* verify = rbf.view(5);
+		if (verify[0] == 'm' && verify[1] == 'o' && verify[2] == 'd' && verify[3] == 'e' && verify[4] == 'l') return info;
+
+	}
+
+	rbf.seek(0);
+	if (rbf.getFileLength() < (int)_GL_ModelFile_headerSize || memcmp(rbf.view(_GL_ModelFile_magicLength), _GL_ModelFile_magic, _GL_ModelFile_magicLength) != 0) throw Exception("Model file \"" + std::string(filePath) + "\" verification failed.");
+
+	info.version = rbf.read<unsigned int>();
+	if (info.version < 2u || info.version > _GL_ModelFile_version) throw Exception("Model file \"" + std::string(filePath) + "\" has unsupported version " + std::to_string(info.version) + ".");
+
+	unsigned int numChunks = rbf.read<unsigned int>();
+	rbf.seek(_GL_ModelFile_headerSize);
+
+	for (unsigned int i = 0u; i < numChunks; i++) {
+
+		Model_types::ModelFileChunk chunk;
+		chunk.id = rbf.read<unsigned int>();
+		chunk.offset = rbf.read<unsigned int>();
+		chunk.size = rbf.read<unsigned int>();
+		rbf.read<unsigned int>();
+
+		if ((unsigned long long)chunk.offset + chunk.size > (unsigned long long)rbf.getFileLength()) throw Exception("Model file \"" + std::string(filePath) + "\" has a corrupt chunk table.");
+		info.chunks.push_back(chunk);
+
+	}
+
+	return info;
+
+}
+
+bool GL::Model::seekModelFileChunk(ReadBinaryFile& rbf, const GL::Model_types::ModelFileInfo& info, unsigned int id, bool required) {
+
+	if (info.version < 2u) return required;
+
+	for (unsigned int i = 0u; i < info.chunks.size(); i++) if (info.chunks[i].id == id) {
+
+		rbf.seek(info.chunks[i].offset);
+		return true;
+
+	}
+
+	if (required) throw Exception("Model file is missing a required chunk.");
+	return false;
+
+}
+
+GL::BoundingBox GL::Model::getFileBoundingBox(const char* filePath) {
+
+	ReadBinaryFile rbf(filePath, 1024, true);
+	Model_types::ModelFileInfo info = verifyModelFile(rbf, filePath);
+
+	if (seekModelFileChunk(rbf, info, _GL_ModelFile_chunk_boundingBox, false)) {
+
+		BoundingBox bbox;
+		for (int i = 0; i < 3; i++) bbox.start[i] = rbf.read<float>();
+		for (int i = 0; i < 3; i++) bbox.end[i] = rbf.read<float>();
+		return bbox;
 
 	}
 
+	Model_types::ModelData data;
+	Model_types::ModelStaging staging;
+	data.fileVersion = info.version;
+
+	seekModelFileChunk(rbf, info, _GL_ModelFile_chunk_materials);
+	loadMaterials(rbf, data, staging);
+	seekModelFileChunk(rbf, info, _GL_ModelFile_chunk_boneNodes);
+	loadBoneNodes(rbf, data);
+
+	BoundingBox bbox = data.bbox;
+	bool isAnimated = data.numAnimations > 0u;
+	releaseModelData(data);
+
+	if (isAnimated) throw Exception("An animated model has no default bounding box.");
+	return bbox;
+
 }
 
+void GL::Model::useMeshPacking(bool use) { meshPacking = use; }
+
+bool GL::Model::usesMeshPacking() { return meshPacking; }
+
 #define _GL_Model_loadMaterialData(matType, numComps, unit, format) \
 idx = rbf.read<int>(); \
 w = rbf.read<unsigned int>(); h = rbf.read<unsigned int>(); \
 \
-if (idx >= 0) modelData[thisModelDataIndex].mats[i].matType ## Tex = modelData[thisModelDataIndex].mats[idx].matType ## Tex; \
+data.mats[i].matType ## Idx = idx; \
+if (idx >= 0) staging.textures.push_back(Model_types::TextureStaging{ i, unit, idx, nullptr, 0u, 0u, GL_ ## format ## 16F, GL_ ## format }); \
 else if (w * h != 0u) { \
 	\
-	char* texData = new char[w * h * numComps]; \
-	for (unsigned int i = 0u; i < w * h * numComps; i++) texData[i] = rbf.readByte(); \
-	\
-	GLuint tex; glGenTextures(1, &tex); \
-	glActiveTexture(GL_TEXTURE0 + unit); \
-	glBindTexture(GL_TEXTURE_2D, tex); \
-	\
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_ ## format ## 16F, w, h, 0, GL_ ## format, GL_UNSIGNED_BYTE, texData); \
-	glGenerateMipmap(GL_TEXTURE_2D); \
-	\
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT); \
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT); \
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR); \
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR); \
+	if (data.fileVersion >= 2u) rbf.align(_GL_ModelFile_alignment); \
+	staging.textures.push_back(Model_types::TextureStaging{ i, unit, -1, rbf.view(w * h * numComps), w, h, GL_ ## format ## 16F, GL_ ## format }); \
 	\
-	delete[] texData; \
-	modelData[thisModelDataIndex].mats[i].matType ## Tex = tex; \
-	\
-} \
-else modelData[thisModelDataIndex].mats[i].matType ## Tex = 0u;
+}
 
-void GL::Model::loadMaterials(ReadBinaryFile& rbf) {
+void GL::Model::loadMaterials(ReadBinaryFile& rbf, GL::Model_types::ModelData& data, GL::Model_types::ModelStaging& staging) {
 
-	modelData[thisModelDataIndex].numMats = rbf.read<unsigned int>();
-	if (modelData[thisModelDataIndex].numMats) {
+	data.numMats = rbf.read<unsigned int>();
+	if (data.numMats) {
 
-		modelData[thisModelDataIndex].mats = new Model_types::Material[modelData[thisModelDataIndex].numMats];
-		modelData[thisModelDataIndex].matFormats = new Model_types::MaterialFormat[modelData[thisModelDataIndex].numMats];
+		data.mats = new Model_types::Material[data.numMats];
+		data.matFormats = new Model_types::MaterialFormat[data.numMats];
 
-		for (unsigned int i = 0u; i < modelData[thisModelDataIndex].numMats; i++) {
+		for (unsigned int i = 0u; i < data.numMats; i++) {
 
-			modelData[thisModelDataIndex].matFormats[i] = (Model_types::MaterialFormat)rbf.read<unsigned int>();
-			for (int j = 0; j < 4; j++) modelData[thisModelDataIndex].mats[i].baseColor[j] = rbf.read<float>();
+			data.matFormats[i] = (Model_types::MaterialFormat)rbf.read<unsigned int>();
+			for (int j = 0; j < 4; j++) data.mats[i].baseColor[j] = rbf.read<float>();
 
 			unsigned int w, h; int idx;
 			_GL_Model_loadMaterialData(base, 4, 0u, RGBA);
@@ -395,30 +772,28 @@ if (animation.num ## AnimationType) { \
 	\
 }
 
-void GL::Model::loadBoneNodes(ReadBinaryFile& rbf) {
-
-	modelData[thisModelDataIndex].numAnimations = rbf.read<unsigned int>();
-	if (modelData[thisModelDataIndex].numAnimations) {
+void GL::Model::loadBoneNodes(ReadBinaryFile& rbf, GL::Model_types::ModelData& data) {
 
-		if (isPhysicsModel) throw Exception("A physics model cannot be animated.");
+	data.numAnimations = rbf.read<unsigned int>();
+	if (data.numAnimations) {
 
-		modelData[thisModelDataIndex].numBones = rbf.read<unsigned int>();
-		modelData[thisModelDataIndex].numBoneNodes = rbf.read<unsigned int>();
+		data.numBones = rbf.read<unsigned int>();
+		data.numBoneNodes = rbf.read<unsigned int>();
 
-		modelData[thisModelDataIndex].animationData = new Model_types::AnimationData[modelData[thisModelDataIndex].numAnimations];
+		data.animationData = new Model_types::AnimationData[data.numAnimations];
 
-		for (unsigned int i = 0u; i < modelData[thisModelDataIndex].numAnimations; i++) {
+		for (unsigned int i = 0u; i < data.numAnimations; i++) {
 
-			modelData[thisModelDataIndex].animationData[i].duration = rbf.read<float>();
-			modelData[thisModelDataIndex].animationData[i].TPS = rbf.read<float>();
+			data.animationData[i].duration = rbf.read<float>();
+			data.animationData[i].TPS = rbf.read<float>();
 
 		}
 
-		modelData[thisModelDataIndex].boneNodes = new Model_types::BoneNode[modelData[thisModelDataIndex].numBoneNodes];
+		data.boneNodes = new Model_types::BoneNode[data.numBoneNodes];
 		
-		for (unsigned int i = 0u; i < modelData[thisModelDataIndex].numBoneNodes; i++) {
+		for (unsigned int i = 0u; i < data.numBoneNodes; i++) {
 
-			Model_types::BoneNode& boneNode = modelData[thisModelDataIndex].boneNodes[i];
+			Model_types::BoneNode& boneNode = data.boneNodes[i];
 			
 			boneNode.glIndex = rbf.read<unsigned int>();
 			boneNode.numChildren = rbf.read<unsigned int>();
@@ -436,13 +811,13 @@ void GL::Model::loadBoneNodes(ReadBinaryFile& rbf) {
 
 			if (hasAnimations) {
 
-				boneNode.animations = new Model_types::Animation*[modelData[thisModelDataIndex].numAnimations];
-				for (unsigned int j = 0u; j < modelData[thisModelDataIndex].numAnimations; j++) {
+				boneNode.animations = new Model_types::Animation*[data.numAnimations]();
+				for (unsigned int j = 0u; j < data.numAnimations; j++) {
 
 					bool animationExists = rbf.read<bool>();
 					if (animationExists) {
 
-						boneNode.animations[j] = new Model_types::Animation;
+						boneNode.animations[j] = new Model_types::Animation{ };
 						Model_types::Animation& animation = *(boneNode.animations[j]);
 
 						_GL_Model_loadAnimationData(scaling, Scalings, 3);
@@ -458,35 +833,372 @@ void GL::Model::loadBoneNodes(ReadBinaryFile& rbf) {
 			else boneNode.animations = nullptr;
 
 		}
+
+		data.boneHierarchy.init(data.boneNodes, data.numBoneNodes);
+
 	}
 	else for (int i = 0; i < 3; i++) {
 		
-		modelData[thisModelDataIndex].bbox.start[i] = rbf.read<float>();
-		modelData[thisModelDataIndex].bbox.end[i] = rbf.read<float>();
+		data.bbox.start[i] = rbf.read<float>();
+		data.bbox.end[i] = rbf.read<float>();
 		
 	}
 
 }
 
-void GL::Model::loadMeshes(ReadBinaryFile& rbf) { _GL_Model_loadMeshes(,,); }
+void GL::Model::loadMeshData(ReadBinaryFile& rbf, GL::Model_types::ModelData& data, GL::Model_types::ModelStaging& staging) { _GL_Model_loadMeshes(,,); }
+
+void GL::Model::loadMeshes(ReadBinaryFile& rbf, GL::Model_types::ModelData& data, GL::Model_types::ModelStaging& staging) { loadMeshData(rbf, data, staging); }
+
+void GL::Model::uploadTexture(GL::Model_types::ModelData& data, const GL::Model_types::TextureStaging& tex) {
+
+	GLuint& target = (tex.unit == 0u) ? data.mats[tex.material].baseTex : ((tex.unit == 1u) ? data.mats[tex.material].metallicRoughnessTex : data.mats[tex.material].normalTex);
+
+	if (tex.sourceMaterial >= 0) {
+
+		target = (tex.unit == 0u) ? data.mats[tex.sourceMaterial].baseTex : ((tex.unit == 1u) ? data.mats[tex.sourceMaterial].metallicRoughnessTex : data.mats[tex.sourceMaterial].normalTex);
+		return;
+
+	}
+
+	GLuint texture; glGenTextures(1, &texture);
+	glActiveTexture(GL_TEXTURE0 + tex.unit);
+	glBindTexture(GL_TEXTURE_2D, texture);
+
+	glTexImage2D(GL_TEXTURE_2D, 0, tex.internalFormat, tex.w, tex.h, 0, tex.format, GL_UNSIGNED_BYTE, tex.data);
+	glGenerateMipmap(GL_TEXTURE_2D);
+
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+
+	target = texture;
+
+}
+
+void GL::Model::uploadMesh(GL::Model_types::ModelData& data, const GL::Model_types::MeshStaging& mesh) {
+
+	unsigned int i = mesh.meshIndex;
+	unsigned int vertexSize = mesh.vertexSize;
+	unsigned int indexBytes = mesh.indexSize * mesh.numIndices;
+
+	Model_types::Material& m = data.mats[data.matIndices[i]];
+	bool hasTextures = m.baseTex > 0u || m.normalTex > 0u || m.metallicRoughnessTex > 0u;
+
+	bool compact = data.quantization[i].compact;
+	GLboolean normalized = compact ? GL_TRUE : GL_FALSE;
+	GLenum positionType = compact ? GL_UNSIGNED_SHORT : GL_FLOAT;
+	unsigned int positionSize = compact ? 4u * sizeof(unsigned short) : sizeof(vec3);
+	unsigned int directionSize = compact ? 2u * sizeof(short) : sizeof(vec3);
+	unsigned int boneDataSize = compact ? 4u * sizeof(unsigned char) : sizeof(ivec4);
+
+	size_t baseOffset = 0u;
+	data.meshPools[i] = _GL_Model_noMeshPool;
+	data.baseVertices[i] = 0;
+
+	if (meshPacking) {
+
+		Model_types::MeshPool format;
+		format.vertexSize = vertexSize;
+		format.indexType = data.indexTypes[i];
+		format.compact = compact;
+		format.hasTextures = hasTextures;
+		format.hasNormalMap = mesh.hasNormalMap;
+		format.isAnimated = data.boneNodes;
+
+		unsigned int vertexBytes = ((mesh.dataSize + vertexSize - 1u) / vertexSize) * vertexSize;
+		unsigned int poolIndex = allocateMeshPool(format, vertexBytes, indexBytes);
+		Model_types::MeshPool& pool = meshPools[poolIndex];
+
+		baseOffset = pool.vertexBytesUsed;
+		unsigned int firstIndex = pool.indexBytesUsed / mesh.indexSize;
+
+		glBindBuffer(GL_COPY_WRITE_BUFFER, pool.vbo);
+		glBufferSubData(GL_COPY_WRITE_BUFFER, pool.vertexBytesUsed, mesh.dataSize, mesh.vertexData);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, pool.ebo);
+		glBufferSubData(GL_COPY_WRITE_BUFFER, pool.indexBytesUsed, indexBytes, mesh.indexData);
+
+		pool.vertexBytesUsed += vertexBytes;
+		pool.indexBytesUsed += indexBytes;
+		pool.numMeshes++;
+
+		data.vbos[i] = pool.vbo;
+		data.ebos[i] = pool.ebo;
+		data.meshPools[i] = poolIndex;
+		data.baseVertices[i] = (int)(baseOffset / vertexSize);
+		for (unsigned int j = 0u; j < data.lods[i].size(); j++) data.lods[i][j].firstIndex += firstIndex;
+
+	}
+	else {
+
+		glGenBuffers(1, &data.vbos[i]);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, data.vbos[i]);
+		glBufferData(GL_COPY_WRITE_BUFFER, mesh.dataSize, mesh.vertexData, GL_STATIC_DRAW);
+
+		glGenBuffers(1, &data.ebos[i]);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, data.ebos[i]);
+		glBufferData(GL_COPY_WRITE_BUFFER, indexBytes, mesh.indexData, GL_STATIC_DRAW);
+
+	}
+
+	data.vertexLayouts[i].vertexSize = vertexSize;
+	data.vertexLayouts[i].numVertices = mesh.dataSize / vertexSize;
+	data.vertexLayouts[i].baseOffset = baseOffset;
+	data.vertexLayouts[i].hasTextures = hasTextures;
+	data.vertexLayouts[i].hasNormalMap = mesh.hasNormalMap;
+
+	glGenVertexArrays(1, &data.vaos[i]);
+	glBindVertexArray(data.vaos[i]);
+
+	glBindBuffer(GL_ARRAY_BUFFER, data.vbos[i]);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, data.ebos[i]);
+	setVertexAttributes(vertexSize, compact, hasTextures, mesh.hasNormalMap, data.boneNodes, baseOffset);
+
+	glGenVertexArrays(1, &data.vaos_shadow[i]);
+	glBindVertexArray(data.vaos_shadow[i]);
+
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, data.ebos[i]);
+
+	glVertexAttribPointer(0, 3, positionType, normalized, vertexSize, (void*)baseOffset);
+	glEnableVertexAttribArray(0);
+
+	if (data.boneNodes) {
+
+		size_t boneDataOffset = baseOffset + positionSize + directionSize;
+		if (hasTextures) boneDataOffset += compact ? 2u * sizeof(unsigned short) : sizeof(vec2);
+		if (mesh.hasNormalMap) boneDataOffset += 2u * directionSize;
+
+		glVertexAttribIPointer(5, 4, compact ? GL_UNSIGNED_BYTE : GL_INT, vertexSize, (void*)boneDataOffset); boneDataOffset += boneDataSize;
+		glVertexAttribPointer(6, 4, compact ? GL_UNSIGNED_BYTE : GL_FLOAT, normalized, vertexSize, (void*)boneDataOffset);
+		glEnableVertexAttribArray(5);
+		glEnableVertexAttribArray(6);
+
+	}
+
+	glBindVertexArray(0);
+
+}
+
+void GL::Model::setVertexAttributes(unsigned int vertexSize, bool compact, bool hasTextures, bool hasNormalMap, bool isAnimated, size_t baseOffset) {
+
+	size_t offset = baseOffset;
+
+	GLboolean normalized = compact ? GL_TRUE : GL_FALSE;
+	GLenum positionType = compact ? GL_UNSIGNED_SHORT : GL_FLOAT;
+	GLenum directionType = compact ? GL_SHORT : GL_FLOAT;
+	int directionComponents = compact ? 2 : 3;
+	unsigned int positionSize = compact ? 4u * sizeof(unsigned short) : sizeof(vec3);
+	unsigned int directionSize = compact ? 2u * sizeof(short) : sizeof(vec3);
+	unsigned int boneDataSize = compact ? 4u * sizeof(unsigned char) : sizeof(ivec4);
+
+	glVertexAttribPointer(0, 3, positionType, normalized, vertexSize, (void*)offset); offset += positionSize;
+	glVertexAttribPointer(1, directionComponents, directionType, normalized, vertexSize, (void*)offset); offset += directionSize;
+	glEnableVertexAttribArray(0);
+	glEnableVertexAttribArray(1);
+
+	if (hasTextures) {
+
+		glVertexAttribPointer(2, 2, compact ? GL_HALF_FLOAT : GL_FLOAT, GL_FALSE, vertexSize, (void*)offset); offset += compact ? 2u * sizeof(unsigned short) : sizeof(vec2);
+		glEnableVertexAttribArray(2);
+
+	}
+
+	if (hasNormalMap) {
+
+		glVertexAttribPointer(3, directionComponents, directionType, normalized, vertexSize, (void*)offset); offset += directionSize;
+		glVertexAttribPointer(4, directionComponents, directionType, normalized, vertexSize, (void*)offset); offset += directionSize;
+		glEnableVertexAttribArray(3);
+		glEnableVertexAttribArray(4);
+
+	}
+
+	if (isAnimated) {
+
+		glVertexAttribIPointer(5, 4, compact ? GL_UNSIGNED_BYTE : GL_INT, vertexSize, (void*)offset); offset += boneDataSize;
+		glVertexAttribPointer(6, 4, compact ? GL_UNSIGNED_BYTE : GL_FLOAT, normalized, vertexSize, (void*)offset);
+		glEnableVertexAttribArray(5);
+		glEnableVertexAttribArray(6);
+
+	}
+
+}
+
+unsigned int GL::Model::allocateMeshPool(const GL::Model_types::MeshPool& format, unsigned int vertexBytes, unsigned int indexBytes) {
+
+	unsigned int freeIndex = meshPools.size();
+
+	for (unsigned int i = 0u; i < meshPools.size(); i++) {
+
+		Model_types::MeshPool& pool = meshPools[i];
+
+		if (!pool.vbo) { if (freeIndex == meshPools.size()) freeIndex = i; continue; }
+		if (
+			pool.vertexSize != format.vertexSize || pool.indexType != format.indexType || pool.compact != format.compact ||
+			pool.hasTextures != format.hasTextures || pool.hasNormalMap != format.hasNormalMap || pool.isAnimated != format.isAnimated
+		) continue;
+
+		if (pool.vertexCapacity - pool.vertexBytesUsed >= vertexBytes && pool.indexCapacity - pool.indexBytesUsed >= indexBytes) return i;
+
+	}
+
+	if (!indirectDrawIndexBuffer) {
+
+		std::vector<GLint> drawIndices(_GL_Model_maxIndirectDraws);
+		for (unsigned int i = 0u; i < _GL_Model_maxIndirectDraws; i++) drawIndices[i] = (GLint)i;
+
+		glGenBuffers(1, &indirectDrawIndexBuffer);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, indirectDrawIndexBuffer);
+		glBufferData(GL_COPY_WRITE_BUFFER, sizeof(GLint) * _GL_Model_maxIndirectDraws, drawIndices.data(), GL_STATIC_DRAW);
+
+	}
+
+	if (freeIndex == meshPools.size()) meshPools.push_back(Model_types::MeshPool());
+	Model_types::MeshPool& pool = meshPools[freeIndex];
+	pool = format;
+
+	pool.vertexCapacity = std::max(vertexBytes, (_GL_Model_meshPoolVertexBytes / format.vertexSize) * format.vertexSize);
+	pool.indexCapacity = std::max(indexBytes, (unsigned int)_GL_Model_meshPoolIndexBytes);
+	pool.vertexBytesUsed = 0u;
+	pool.indexBytesUsed = 0u;
+	pool.numMeshes = 0u;
+
+	glGenBuffers(1, &pool.vbo);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, pool.vbo);
+	glBufferData(GL_COPY_WRITE_BUFFER, pool.vertexCapacity, nullptr, GL_STATIC_DRAW);
+
+	glGenBuffers(1, &pool.ebo);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, pool.ebo);
+	glBufferData(GL_COPY_WRITE_BUFFER, pool.indexCapacity, nullptr, GL_STATIC_DRAW);
+
+	glGenVertexArrays(1, &pool.vao);
+	glBindVertexArray(pool.vao);
+
+	glBindBuffer(GL_ARRAY_BUFFER, pool.vbo);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, pool.ebo);
+	setVertexAttributes(pool.vertexSize, pool.compact, pool.hasTextures, pool.hasNormalMap, pool.isAnimated, 0u);
+
+	glBindBuffer(GL_ARRAY_BUFFER, indirectDrawIndexBuffer);
+	glVertexAttribIPointer(9, 1, GL_INT, sizeof(GLint), (void*)0);
+	glVertexAttribDivisor(9, 1);
+	glEnableVertexAttribArray(9);
+
+	glBindVertexArray(0);
+
+	return freeIndex;
+
+}
+
+void GL::Model::releaseMeshPool(unsigned int index) {
+
+	Model_types::MeshPool& pool = meshPools[index];
+	if (--pool.numMeshes) return;
+
+	glDeleteVertexArrays(1, &pool.vao);
+	glDeleteBuffers(1, &pool.vbo);
+	glDeleteBuffers(1, &pool.ebo);
+	pool.vao = 0u;
+	pool.vbo = 0u;
+	pool.ebo = 0u;
+
+}
+
+void GL::Model::setVertexQuantization(const GL::Model_types::VertexQuantization& quantization) {
+
+	glVertexAttrib4f(7, quantization.positionOffset.x, quantization.positionOffset.y, quantization.positionOffset.z, quantization.compact ? 1.0f : 0.0f);
+	glVertexAttrib4f(8, quantization.positionScale.x, quantization.positionScale.y, quantization.positionScale.z, 0.0f);
+
+}
+
+float GL::Model::getProjectedSize(GL::Scene& scene) const {
+
+	if (modelData[thisModelDataIndex].numAnimations || isInstanced()) return -1.0f;
+
+	BoundingBox bb = getWorldSpaceBoundingBoxApproximation();
+	mat4 PV = scene.getPerspectiveMatrix();
+	vec2 minimum, maximum;
+
+	for (unsigned int i = 0u; i < 8u; i++) {
+
+		vec4 corner = PV * vec4((i & 1u) ? bb.end.x : bb.start.x, (i & 2u) ? bb.end.y : bb.start.y, (i & 4u) ? bb.end.z : bb.start.z, 1.0f);
+		if (corner.w <= 0.0f) return -1.0f;
+
+		vec2 projected(corner.x / corner.w, corner.y / corner.w);
+		if (i == 0u) { minimum = projected; maximum = projected; }
+
+		minimum = vec2(std::min(minimum.x, projected.x), std::min(minimum.y, projected.y));
+		maximum = vec2(std::max(maximum.x, projected.x), std::max(maximum.y, projected.y));
+
+	}
+
+	return 0.5f * std::max(maximum.x - minimum.x, maximum.y - minimum.y);
+
+}
+
+bool GL::Model::usesInstanceCulling() const { return isInstanced() && instancesBuf->usesGpuCulling() && !modelData[thisModelDataIndex].numAnimations; }
+
+void GL::Model::cullInstances(GL::Scene& scene, float projectedSize) {
+
+	const Model_types::ModelData& data = modelData[thisModelDataIndex];
+	ModelInstanceBuffer& instances = *instancesBuf;
+
+	std::vector<RenderQueue_types::IndirectCommand> commands(data.numMeshes);
+	for (unsigned int i = 0u; i < data.numMeshes; i++) {
+
+		if (!data.vaos[i]) { commands[i] = { 0u, 0u, 0u, 0, 0u }; continue; }
+
+		const Model_types::LevelOfDetail& lod = selectLod(i, projectedSize, 0u);
+		commands[i] = { lod.numElements, 0u, lod.firstIndex, 0, 0u };
+
+	}
+
+	if (!instances.commandBuffer) glGenBuffers(1, &instances.commandBuffer);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, instances.commandBuffer);
+
+	if (instances.commandCapacity < data.numMeshes) {
+
+		glBufferData(GL_DRAW_INDIRECT_BUFFER, data.numMeshes * sizeof(RenderQueue_types::IndirectCommand), commands.data(), GL_DYNAMIC_DRAW);
+		instances.commandCapacity = data.numMeshes;
+
+	}
+	else glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, data.numMeshes * sizeof(RenderQueue_types::IndirectCommand), commands.data());
+
+	scene.cullInstances(instances, data.bbox, data.numMeshes);
+
+}
+
+const GL::Model_types::LevelOfDetail& GL::Model::selectLod(unsigned int meshIndex, float projectedSize, unsigned int bias) const {
+
+	const std::vector<Model_types::LevelOfDetail>& lods = modelData[thisModelDataIndex].lods[meshIndex];
+	unsigned int level = 0u;
+
+	if (projectedSize >= 0.0f) while (level + 1u < lods.size() && lods[level + 1u].error * projectedSize <= lodTolerance) level++;
+
+	return lods[std::min(level + bias, (unsigned int)lods.size() - 1u)];
+
+}
 
 void GL::Model::updateUBOs(GL::mat4 PV, GL::mat4 modelMatrix, GL::mat3 normalMatrix, GL::Scene& scene, bool drawingShadow) {
 
-	PBR_commonUniforms->set("trans", PV);
-	PBR_commonUniforms->set("modelMat", modelMatrix);
-	for (unsigned int j = 0u; j < 16u; j++) PBR_commonUniforms->setElement("lightPositions", j, scene.getLightPosition(j));
+	PBR_commonUniforms->set(PBR_commonHandles.trans, PV);
+	PBR_commonUniforms->set(PBR_commonHandles.modelMat, modelMatrix);
+	for (unsigned int j = 0u; j < 16u; j++) PBR_commonUniforms->setElement(PBR_commonHandles.lightPositions, j, scene.getLightPosition(j));
 	
 	if (!drawingShadow) {
 
-		PBR_commonUniforms->set("normalMat", normalMatrix);
-		PBR_commonUniforms->set("camPos", scene.getCameraPosition());
-		for (unsigned int j = 0u; j < 16u; j++) PBR_commonUniforms->setElement("lightColors", j, scene.getLightColor(j));
+		PBR_commonUniforms->set(PBR_commonHandles.normalMat, normalMatrix);
+		PBR_commonUniforms->set(PBR_commonHandles.camPos, scene.getCameraPosition());
+		for (unsigned int j = 0u; j < 16u; j++) PBR_commonUniforms->setElement(PBR_commonHandles.lightColors, j, scene.getLightColor(j));
 
 	}
 
 	PBR_commonUniforms->update();
 
 	if (modelData[thisModelDataIndex].boneNodes && modelData[thisModelDataIndex].numAnimations) {
+
+		// Pre-skinned vertices stay valid for the whole frame, or until the pose changes if no animation is playing.
+		bool preSkinned = isPreSkinned();
+		if (preSkinned && skinnedPoseVersion == poseVersion && (!isAnimationPlaying || skinnedFrame == scene.getFrameIndex())) return;
 	
 		if (isAnimationPlaying) {
 		
@@ -508,40 +1220,124 @@ void GL::Model::updateUBOs(GL::mat4 PV, GL::mat4 modelMatrix, GL::mat3 normalMat
 					t = duration;
 					isAnimationPlaying = false;
 					isAnimationFinished = true;
+					poseVersion++;
 				
 				}
 			}
 		}
 	
-		updateModelMatrices(0u, mat4());
-	
-		for (unsigned int i = 0u; i < modelData[thisModelDataIndex].numBoneNodes; i++)
-		
-			if (modelData[thisModelDataIndex].boneNodes[i].glIndex < 64u) {
-			
-				PBR_animationMatrices->setElement("boneModelMatrices", modelData[thisModelDataIndex].boneNodes[i].glIndex, modelData[thisModelDataIndex].boneNodes[i].modelMatrix);
-				PBR_animationMatrices->setElement("boneNormalMatrices", modelData[thisModelDataIndex].boneNodes[i].glIndex, modelData[thisModelDataIndex].boneNodes[i].normalMatrix);
-			
+		// The pose belongs to this model, the bone nodes of the shared model data are only read.
+		if ((isAnimationPlaying && animationLayers.empty()) || evaluatedPoseVersion != poseVersion) {
+
+			if (!boneModelMatrices) {
+
+				boneModelMatrices = new mat4[_GL_Model_maxBones];
+				boneNormalMatrices = new unsigned char[_GL_Model_maxBones * _GL_Model_boneNormalStride]();
+
 			}
-	
-		PBR_animationMatrices->update();
+
+			Model_types::BoneHierarchy& boneHierarchy = modelData[thisModelDataIndex].boneHierarchy;
+			if (animationLayers.empty()) {
+
+				if (animationCursors.size() < boneHierarchy.numNodes) animationCursors.resize(boneHierarchy.numNodes);
+				boneHierarchy.evaluate(modelData[thisModelDataIndex].boneNodes, animationIndex, isAnimationPlaying, t, animationCursors.data(), boneModelMatrices, boneNormalMatrices);
+
+			}
+			else {
+
+				updateAnimationSamples();
+				if (animationCursors.size() < animationSamples.size() * boneHierarchy.numNodes) animationCursors.resize(animationSamples.size() * boneHierarchy.numNodes);
+				boneHierarchy.evaluate(modelData[thisModelDataIndex].boneNodes, animationSamples.data(), animationSamples.size(), animationCursors.data(), boneModelMatrices, boneNormalMatrices);
+
+			}
+			evaluatedPoseVersion = poseVersion;
+			boneDataVersion++;
+
+		}
+
+		// The shared buffer still holds these palettes if this model was the last to upload and its pose was not evaluated since.
+		if (boneDataOwner != this || boneDataOwnerVersion != boneDataVersion) {
+
+			std::memcpy(PBR_animationMatrices->getElementData(PBR_commonHandles.boneModelMatrices), boneModelMatrices, _GL_Model_maxBones * sizeof(mat4));
+			std::memcpy(PBR_animationMatrices->getElementData(PBR_commonHandles.boneNormalMatrices), boneNormalMatrices, _GL_Model_maxBones * _GL_Model_boneNormalStride);
+			PBR_animationMatrices->markElementsAsChanged(PBR_commonHandles.boneModelMatrices, 0u, _GL_Model_maxBones);
+			PBR_animationMatrices->markElementsAsChanged(PBR_commonHandles.boneNormalMatrices, 0u, _GL_Model_maxBones);
+			PBR_animationMatrices->update();
+
+			boneDataOwner = this;
+			boneDataOwnerVersion = boneDataVersion;
+
+		}
+		else PBR_animationMatrices->bind();
+
+		if (hasInstancePoses()) updateInstancePoses();
+
+		if (preSkinned) {
+
+			if (!skinnedVertices) skinnedVertices = new SkinnedVertexBuffer(modelData[thisModelDataIndex]);
+			skinnedVertices->skin(modelData[thisModelDataIndex]);
+			skinnedFrame = scene.getFrameIndex();
+			skinnedPoseVersion = poseVersion;
+
+		}
 	
 	}
 
 }
 
-void GL::Model::updateModelMatrices(unsigned int idx, GL::mat4 globalTransform) {
-	
-	Model_types::BoneNode& boneNode = modelData[thisModelDataIndex].boneNodes[idx];
-	
-	mat4 localTransform = boneNode.trans;
-	if (isAnimationPlaying && boneNode.animations) if (boneNode.animations[animationIndex]) localTransform = boneNode.animations[animationIndex]->getMatrix(t);
-	globalTransform = globalTransform * localTransform;
+void GL::Model::updateAnimationSamples() {
 
-	boneNode.modelMatrix = globalTransform * boneNode.offset;
-	boneNode.normalMatrix = transpose(inverse(mat3(boneNode.modelMatrix)));
+	animationSamples.clear();
 
-	for (unsigned int i = 0u; i < boneNode.numChildren; i++) updateModelMatrices(boneNode.childIndices[i], globalTransform);
+	for (unsigned int i = 0u; i < animationLayers.size(); i++) {
+
+		const Model_types::AnimationLayer& l = animationLayers[i];
+		float fade = (l.fadeDuration > 0.0f) ? l.fadeElapsed / l.fadeDuration : 1.0f;
+
+		if (fade < 1.0f) animationSamples.push_back({ l.fadeAnimation, getAnimationTicks(l.fadeAnimation, l.fadeTime), l.weight * (1.0f - fade), l.additive, l.maskNode });
+		animationSamples.push_back({ l.animation, getAnimationTicks(l.animation, l.time), l.weight * fade, l.additive, l.maskNode });
+
+	}
+
+}
+
+float GL::Model::getAnimationTicks(unsigned int animation, float seconds) const {
+
+	const Model_types::AnimationData& data = modelData[thisModelDataIndex].animationData[animation];
+	float ticks = seconds * data.TPS;
+	if (data.duration > 0.0f) ticks -= std::floor(ticks / data.duration) * data.duration;
+
+	return ticks;
+
+}
+
+void GL::Model::updateInstancePoses() {
+
+	ModelInstanceBuffer& instances = *instancesBuf;
+	if (!instances.posesChanged) return;
+
+	Model_types::ModelData& data = modelData[thisModelDataIndex];
+	mat4* modelPalettes = (mat4*)instances.boneModelTable.getElementData("instanceBoneModelMatrices");
+	unsigned char* normalPalettes = instances.boneNormalTable.getElementData("instanceBoneNormalMatrices");
+	unsigned int numNodes = data.boneHierarchy.numNodes;
+	if (instanceAnimationCursors.size() < instances.getLength() * numNodes) instanceAnimationCursors.resize(instances.getLength() * numNodes);
+
+	for (unsigned int i = 0u; i < instances.getLength(); i++) {
+
+		unsigned int animation = instances.animationIndices[i] % data.numAnimations;
+		float duration = data.animationData[animation].duration;
+		float time = instances.animationTimes[i] * data.animationData[animation].TPS;
+		if (duration > 0.0f) time -= std::floor(time / duration) * duration;
+
+		data.boneHierarchy.evaluate(data.boneNodes, animation, true, time, instanceAnimationCursors.data() + i * numNodes, modelPalettes + i * _GL_Model_maxBones, normalPalettes + i * _GL_Model_maxBones * _GL_Model_boneNormalStride);
+
+	}
+
+	instances.boneModelTable.markElementsAsChanged("instanceBoneModelMatrices", 0u, instances.getLength() * _GL_Model_maxBones);
+	instances.boneNormalTable.markElementsAsChanged("instanceBoneNormalMatrices", 0u, instances.getLength() * _GL_Model_maxBones);
+	instances.boneModelTable.update();
+	instances.boneNormalTable.update();
+	instances.posesChanged = false;
 
 }
 
@@ -573,6 +1369,187 @@ int GL::Model::getProgramIndex(unsigned int materialIndex, bool skybox) {
 #define _GL_Model_extractCoefficient(name) \
 unsigned int name ## Mode = tempIdx / _GL_Model_programBase_ ## name; tempIdx %= _GL_Model_programBase_ ## name;
 
+void GL::Model::setSceneUniforms(unsigned int idx, GL::Scene& scene) {
+
+	PBR_uniforms[idx]->set(PBR_handles[idx].bgColor, scene.getBackgroundColor());
+	PBR_uniforms[idx]->set(PBR_handles[idx].bgBrightness, scene.getBackgroundBrightness());
+	for (unsigned int j = 0u; j < 6u; j++) PBR_uniforms[idx]->setElement(PBR_handles[idx].hasShadowSampler, j, (j < scene.getNumPointLights()) ? 1 : 0);
+	PBR_uniforms[idx]->set(PBR_handles[idx].numOverheadShadowMaps, (int)scene.getNumOverheadShadowMaps());
+	for (unsigned int j = 0u; j < scene.getNumOverheadShadowMaps(); j++) {
+
+		PBR_uniforms[idx]->setElement(PBR_handles[idx].overheadPVMatrix, j, scene.getOverheadShadowPVMatrix(j));
+		PBR_uniforms[idx]->setElement(PBR_handles[idx].overheadFarPlane, j, scene.getOverheadShadowFarPlane(j));
+
+	}
+	PBR_uniforms[idx]->set(PBR_handles[idx].overheadLightDirection, scene.getOverheadLightDirection());
+	PBR_uniforms[idx]->set(PBR_handles[idx].overheadLightColor, scene.getOverheadLightColor());
+
+}
+
+void GL::Model::beginQueuedDraws(GL::Scene& scene) {
+
+	scene.drawBackground();
+	scene.use();
+
+	initUBOs();
+	PBR_commonUniforms->set(PBR_commonHandles.trans, scene.getPerspectiveMatrix());
+	PBR_commonUniforms->set(PBR_commonHandles.camPos, scene.getCameraPosition());
+	for (unsigned int j = 0u; j < 16u; j++) PBR_commonUniforms->setElement(PBR_commonHandles.lightPositions, j, scene.getLightPosition(j));
+	for (unsigned int j = 0u; j < 16u; j++) PBR_commonUniforms->setElement(PBR_commonHandles.lightColors, j, scene.getLightColor(j));
+	PBR_commonUniforms->update();
+
+}
+
+void GL::Model::drawQueued(const GL::RenderQueue_types::Item& item, GL::RenderQueue& queue, GL::Scene& scene) {
+
+	if (queue.useModel(this)) {
+
+		mat3 normalMatrix(getModelMatrix());
+		PBR_commonUniforms->set(PBR_commonHandles.modelMat, getModelMatrix());
+		PBR_commonUniforms->set(PBR_commonHandles.normalMat, transpose(inverse(normalMatrix)));
+		PBR_commonUniforms->update();
+
+		if (isInstanced()) {
+
+			instancesBuf->update();
+			instancesBuf->bind();
+
+		}
+
+		if (usesInstanceCulling()) {
+
+			cullInstances(scene, getProjectedSize(scene));
+			queue.invalidateProgram();
+
+		}
+
+	}
+
+	for (unsigned int i = 0u; i < 3u; i++) queue.bindTexture(i, item.textures[i]);
+
+	Model_types::Material& mat = modelData[thisModelDataIndex].mats[modelData[thisModelDataIndex].matIndices[item.mesh]];
+	bool uniformsChanged = false;
+
+	if (queue.prepareProgram(item.program)) {
+
+		setSceneUniforms(item.program, scene);
+		uniformsChanged = true;
+
+	}
+
+	RenderQueue_types::MeshUniforms meshUniforms;
+	meshUniforms.metallic = metallic;
+	meshUniforms.roughness = roughness;
+	meshUniforms.ao = ao;
+	meshUniforms.shadowOcclusion = shadowOcclusion;
+	meshUniforms.albedoStretch = albedoStretch;
+	meshUniforms.metallicStretch = metallicStretch;
+	meshUniforms.roughnessStretch = roughnessStretch;
+	meshUniforms.normalStretch = normalStretch;
+	meshUniforms.color = customColor ? (upscale<vec4>(albedoColor) + vec4(0.0f, 0.0f, 0.0f, 1.0f)) : mat.baseColor;
+	meshUniforms.isInstanced = isInstanced() ? (usesInstanceCulling() ? 3 : 1) : 0;
+	meshUniforms.derivesNormalMatrix = (isInstanced() && instancesBuf->derivesNormalMatrices()) ? 1 : 0;
+
+	if (queue.setMeshUniforms(item.program, meshUniforms)) {
+
+		UniformTable& ut = *PBR_uniforms[item.program];
+		const Model_types::ProgramHandles& handles = PBR_handles[item.program];
+		ut.set(handles.metallic, meshUniforms.metallic);
+		ut.set(handles.roughness, meshUniforms.roughness);
+		ut.set(handles.ao, meshUniforms.ao);
+		ut.set(handles.shadowOcclusion, meshUniforms.shadowOcclusion);
+		ut.set(handles.albedoStretch, meshUniforms.albedoStretch);
+		ut.set(handles.metallicStretch, meshUniforms.metallicStretch);
+		ut.set(handles.roughnessStretch, meshUniforms.roughnessStretch);
+		ut.set(handles.normalStretch, meshUniforms.normalStretch);
+		ut.set(handles.inColor, meshUniforms.color);
+		ut.set(handles.isInstanced, meshUniforms.isInstanced);
+		ut.set(handles.derivesNormalMatrix, meshUniforms.derivesNormalMatrix);
+		uniformsChanged = true;
+
+	}
+
+	queue.useProgram(PBR_programs[item.program]->getID());
+	if (uniformsChanged) PBR_uniforms[item.program]->update();
+
+	if (queue.bindVertexArray(item.vao)) setVertexQuantization(modelData[thisModelDataIndex].quantization[item.mesh]);
+	if (usesInstanceCulling()) {
+
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, instancesBuf->commandBuffer);
+		glDrawElementsIndirect(GL_TRIANGLES, item.indexType, (const void*)(item.mesh * sizeof(RenderQueue_types::IndirectCommand)));
+
+	}
+	else if (isInstanced()) glDrawElementsInstanced(GL_TRIANGLES, item.numElements, item.indexType, (const void*)item.firstIndexOffset, instancesBuf->getLength());
+	else glDrawElements(GL_TRIANGLES, item.numElements, item.indexType, (const void*)item.firstIndexOffset);
+
+}
+
+void GL::Model::getIndirectDrawData(const GL::RenderQueue_types::Item& item, GL::RenderQueue_types::DrawData& drawData) const {
+
+	Model_types::Material& mat = modelData[thisModelDataIndex].mats[modelData[thisModelDataIndex].matIndices[item.mesh]];
+	const Model_types::VertexQuantization& quantization = modelData[thisModelDataIndex].quantization[item.mesh];
+	mat3 normalMatrix(getModelMatrix());
+
+	drawData.modelMatrix = getModelMatrix();
+	drawData.normalMatrix = upscale<mat4>(transpose(inverse(normalMatrix)));
+	drawData.positionOffset = vec4(quantization.positionOffset.x, quantization.positionOffset.y, quantization.positionOffset.z, quantization.compact ? 1.0f : 0.0f);
+	drawData.positionScale = vec4(quantization.positionScale.x, quantization.positionScale.y, quantization.positionScale.z, 0.0f);
+	drawData.color = customColor ? (upscale<vec4>(albedoColor) + vec4(0.0f, 0.0f, 0.0f, 1.0f)) : mat.baseColor;
+	drawData.material = vec4(metallic, roughness, ao, shadowOcclusion);
+	drawData.stretch = vec4(albedoStretch, metallicStretch, roughnessStretch, normalStretch);
+
+}
+
+void GL::Model::uploadIndirectDraws(const GL::RenderQueue_types::IndirectCommand* commands, const GL::RenderQueue_types::DrawData* drawData, unsigned int numDraws) {
+
+	if (!indirectCommandBuffer) {
+
+		glGenBuffers(1, &indirectCommandBuffer);
+		glGenBuffers(1, &indirectDrawDataBuffer);
+
+	}
+
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectCommandBuffer);
+	glBufferData(GL_DRAW_INDIRECT_BUFFER, sizeof(RenderQueue_types::IndirectCommand) * numDraws, commands, GL_STREAM_DRAW);
+
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, indirectDrawDataBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(RenderQueue_types::DrawData) * numDraws, drawData, GL_STREAM_DRAW);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2u, indirectDrawDataBuffer);
+
+}
+
+void GL::Model::drawIndirect(const GL::RenderQueue_types::Item& item, unsigned int firstCommand, unsigned int numCommands, GL::RenderQueue& queue, GL::Scene& scene) {
+
+	for (unsigned int i = 0u; i < 3u; i++) queue.bindTexture(i, item.textures[i]);
+
+	bool uniformsChanged = false;
+
+	if (queue.prepareProgram(item.program)) {
+
+		setSceneUniforms(item.program, scene);
+		uniformsChanged = true;
+
+	}
+
+	RenderQueue_types::MeshUniforms meshUniforms = { };
+	meshUniforms.isInstanced = 2;
+
+	if (queue.setMeshUniforms(item.program, meshUniforms)) {
+
+		PBR_uniforms[item.program]->set(PBR_handles[item.program].isInstanced, meshUniforms.isInstanced);
+		uniformsChanged = true;
+
+	}
+
+	queue.useProgram(PBR_programs[item.program]->getID());
+	if (uniformsChanged) PBR_uniforms[item.program]->update();
+
+	queue.bindVertexArray(item.vao);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectCommandBuffer);
+	glMultiDrawElementsIndirect(GL_TRIANGLES, item.indexType, (const void*)(firstCommand * sizeof(RenderQueue_types::IndirectCommand)), numCommands, 0);
+
+}
+
 void GL::Model::initUBOs() {
 
 	if (!PBR_commonUniforms) {
@@ -586,6 +1563,14 @@ void GL::Model::initUBOs() {
 			"trans", UniformType::MAT4, 1,
 			"camPos", UniformType::VEC3, 1
 		);
+		if (BufferTable::isStreamingSupported()) PBR_commonUniforms->useStreaming(true);
+
+		PBR_commonHandles.modelMat = PBR_commonUniforms->handle<mat4>("modelMat");
+		PBR_commonHandles.normalMat = PBR_commonUniforms->handle<mat3>("normalMat");
+		PBR_commonHandles.lightPositions = PBR_commonUniforms->handle<vec3>("lightPositions");
+		PBR_commonHandles.lightColors = PBR_commonUniforms->handle<vec3>("lightColors");
+		PBR_commonHandles.trans = PBR_commonUniforms->handle<mat4>("trans");
+		PBR_commonHandles.camPos = PBR_commonUniforms->handle<vec3>("camPos");
 
 	}
 
@@ -593,9 +1578,13 @@ void GL::Model::initUBOs() {
 
 		PBR_animationMatrices = new UniformBufferTable(1u);
 		PBR_animationMatrices->init(
-			"boneModelMatrices", UniformType::MAT4, 64,
-			"boneNormalMatrices", UniformType::MAT3, 64
+			"boneModelMatrices", UniformType::MAT4, _GL_Model_maxBones,
+			"boneNormalMatrices", UniformType::MAT3, _GL_Model_maxBones
 		);
+		if (BufferTable::isStreamingSupported()) PBR_animationMatrices->useStreaming(true, _GL_Model_animationStreamingRegionSize);
+
+		PBR_commonHandles.boneModelMatrices = PBR_animationMatrices->handle<mat4>("boneModelMatrices");
+		PBR_commonHandles.boneNormalMatrices = PBR_animationMatrices->handle<mat3>("boneNormalMatrices");
 
 	}
 
@@ -693,15 +1682,16 @@ void GL::Model::compileProgram(unsigned int idx) {
 		"shadowSamplers", UniformType::INT, 6,
 		"hasShadowSampler", UniformType::INT, 6,
 
-		"overheadShadowSampler", UniformType::INT, 2,
-		"overheadPVMatrix", UniformType::MAT4, 2,
-		"overheadFarPlane", UniformType::FLOAT, 2,
-		"bboxStart", UniformType::VEC3, 2,
-		"bboxEnd", UniformType::VEC3, 2,
+		"overheadShadowSampler", UniformType::INT, 1,
+		"overheadPVMatrix", UniformType::MAT4, _GL_OverheadShadowRenderer_maxMaps,
+		"overheadFarPlane", UniformType::FLOAT, _GL_OverheadShadowRenderer_maxMaps,
+		"numOverheadShadowMaps", UniformType::INT, 1,
 		"overheadLightDirection", UniformType::VEC3, 1,
 		"overheadLightColor", UniformType::VEC3, 1,
 
-		"isInstanced", UniformType::INT, 1
+		"isInstanced", UniformType::INT, 1,
+		"derivesNormalMatrix", UniformType::INT, 1,
+		"hasInstancePoses", UniformType::INT, 1
 
 	);
 	PBR_uniforms[idx]->set<int>("albedoSampler", 0);
@@ -718,11 +1708,37 @@ void GL::Model::compileProgram(unsigned int idx) {
 		PBR_uniforms[idx]->setElement<int>("hasShadowSampler", i, 0);
 		
 	}
-	for (unsigned int i = 0u; i < 2u; i++) PBR_uniforms[idx]->setElement<int>("overheadShadowSampler", i, (int)(14u + i));
+	PBR_uniforms[idx]->set<int>("overheadShadowSampler", 14);
+	PBR_uniforms[idx]->set<int>("numOverheadShadowMaps", 0);
+
+	UniformTable& ut = *PBR_uniforms[idx];
+	Model_types::ProgramHandles& handles = PBR_handles[idx];
+	handles.inColor = ut.handle<vec4>("inColor");
+	handles.metallic = ut.handle<float>("metallic");
+	handles.roughness = ut.handle<float>("roughness");
+	handles.ao = ut.handle<float>("ao");
+	handles.shadowOcclusion = ut.handle<float>("shadowOcclusion");
+	handles.albedoStretch = ut.handle<float>("albedoStretch");
+	handles.metallicStretch = ut.handle<float>("metallicStretch");
+	handles.roughnessStretch = ut.handle<float>("roughnessStretch");
+	handles.normalStretch = ut.handle<float>("normalStretch");
+	handles.isInstanced = ut.handle<int>("isInstanced");
+	handles.derivesNormalMatrix = ut.handle<int>("derivesNormalMatrix");
+	handles.hasInstancePoses = ut.handle<int>("hasInstancePoses");
+	handles.bgColor = ut.handle<vec3>("bgColor");
+	handles.bgBrightness = ut.handle<float>("bgBrightness");
+	handles.hasShadowSampler = ut.handle<int>("hasShadowSampler");
+	handles.numOverheadShadowMaps = ut.handle<int>("numOverheadShadowMaps");
+	handles.overheadPVMatrix = ut.handle<mat4>("overheadPVMatrix");
+	handles.overheadFarPlane = ut.handle<float>("overheadFarPlane");
+	handles.overheadLightDirection = ut.handle<vec3>("overheadLightDirection");
+	handles.overheadLightColor = ut.handle<vec3>("overheadLightColor");
 
 }
 
 std::vector<GL::Model_types::ModelData> GL::Model::modelData;
+std::unordered_map<std::string, unsigned int> GL::Model::modelDataIndices;
+std::vector<unsigned int> GL::Model::freeModelDataIndices;
 
 GL::ShaderLoader* GL::Model::PBR_vertShaders[];
 GL::ShaderLoader* GL::Model::PBR_fragShaders[];
@@ -730,8 +1746,20 @@ GL::Program* GL::Model::PBR_programs[];
 GL::UniformTable* GL::Model::PBR_uniforms[];
 GL::UniformBufferTable* GL::Model::PBR_commonUniforms = nullptr;
 GL::UniformBufferTable* GL::Model::PBR_animationMatrices = nullptr;
+GL::Model_types::ProgramHandles GL::Model::PBR_handles[];
+GL::Model_types::CommonUniformHandles GL::Model::PBR_commonHandles;
+
+const GL::Model* GL::Model::boneDataOwner = nullptr;
+
+unsigned int GL::Model::boneDataOwnerVersion = 0u;
 bool GL::Model::PBR_initialized = false;
 
+std::vector<GL::Model_types::MeshPool> GL::Model::meshPools;
+bool GL::Model::meshPacking = false;
+GLuint GL::Model::indirectDrawIndexBuffer = 0u;
+GLuint GL::Model::indirectCommandBuffer = 0u;
+GLuint GL::Model::indirectDrawDataBuffer = 0u;
+
 const char* GL::Model::PBR_vert_variable_code[] = {
 
 	"\n",
@@ -793,17 +1821,54 @@ const char* GL::Model::PBR_frag_variable_code[] = {
 
 const char* GL::Model::PBR_vert_base_code = \
 \
-"layout(location = 0) in vec3 pos; \
-layout(location = 1) in vec3 normal; \
+"layout(location = 0) in vec3 encodedPos; \
+layout(location = 1) in vec3 encodedNormal; \
 \
 layout(location = 2) in vec2 texCoords; \
 out vec2 tCoords; \
 \
 \n#ifdef NORMAL_MAP\n \
-layout(location = 3) in vec3 tangent; \
-layout(location = 4) in vec3 bitangent; \
+layout(location = 3) in vec3 encodedTangent; \
+layout(location = 4) in vec3 encodedBitangent; \
 \n#endif\n \
 \
+layout(location = 7) in vec4 positionOffset; \
+layout(location = 8) in vec4 positionScale; \
+layout(location = 9) in int drawIndex; \
+\
+struct DrawData { \
+	\
+	mat4 modelMatrix; \
+	mat4 normalMatrix; \
+	vec4 positionOffset; \
+	vec4 positionScale; \
+	vec4 color; \
+	vec4 material; \
+	vec4 stretch; \
+	\
+}; \
+\
+layout(std430, binding = 2) buffer drawDataBuffer { DrawData draws[]; }; \
+\
+uniform int isInstanced; \
+uniform int derivesNormalMatrix; \
+vec4 meshPositionOffset = (isInstanced == 2) ? draws[drawIndex].positionOffset : positionOffset; \
+vec4 meshPositionScale = (isInstanced == 2) ? draws[drawIndex].positionScale : positionScale; \
+\
+flat out vec4 drawColor; \
+flat out vec4 drawMaterial; \
+flat out vec4 drawStretch; \
+\
+vec3 decodeDirection(vec3 direction) { \
+	\
+	if (meshPositionOffset.w == 0.0f) return direction; \
+	vec3 n = vec3(direction.xy, 1.0f - abs(direction.x) - abs(direction.y)); \
+	float t = max(-n.z, 0.0f); \
+	n.xy += vec2((n.x >= 0.0f) ? -t : t, (n.y >= 0.0f) ? -t : t); \
+	return normalize(n); \
+	\
+} \
+\
 \n#ifdef ANIMATED\n \
 layout(location = 5) in ivec4 boneIndices; \
 layout(location = 6) in vec4 boneWeights; \
@@ -811,6 +1876,7 @@ layout(location = 6) in vec4 boneWeights; \
 \
 layout(std430, binding = 0) buffer modelMatrixInstances { mat4 modelMatrices[]; }; \
 layout(std430, binding = 1) buffer normalMatrixInstances { mat3 normalMatrices[]; }; \
+layout(std430, binding = 3) buffer visibleInstanceList { uint visibleInstances[]; }; \
 \
 layout(std140, binding = 0) uniform PBR_inputs { \
 	\
@@ -823,9 +1889,9 @@ layout(std140, binding = 0) uniform PBR_inputs { \
 	\
 }; \
 \
-uniform int isInstanced; \
-mat4 modelMatrix = (isInstanced == 1) ? modelMatrices[gl_InstanceID] : modelMat; \
-mat3 normalMatrix = (isInstanced == 1) ? normalMatrices[gl_InstanceID] : normalMat; \
+int instanceIndex = (isInstanced == 3) ? int(visibleInstances[gl_InstanceID]) : gl_InstanceID; \
+mat4 modelMatrix = (isInstanced == 1 || isInstanced == 3) ? modelMatrices[instanceIndex] : ((isInstanced == 2) ? draws[drawIndex].modelMatrix : modelMat); \
+mat3 normalMatrix = (isInstanced == 1 || isInstanced == 3) ? ((derivesNormalMatrix == 1) ? transpose(inverse(mat3(modelMatrix))) : normalMatrices[instanceIndex]) : ((isInstanced == 2) ? mat3(draws[drawIndex].normalMatrix) : normalMat); \
 \
 \n#ifdef ANIMATED\n \
 layout(std140, binding = 1) uniform boneData { \
@@ -834,6 +1900,10 @@ layout(std140, binding = 1) uniform boneData { \
 	mat3 boneNormalMatrices[64]; \
 	\
 }; \
+\
+layout(std430, binding = 5) buffer instanceBoneModelPalettes { mat4 instanceBoneModelMatrices[]; }; \
+layout(std430, binding = 6) buffer instanceBoneNormalPalettes { mat3 instanceBoneNormalMatrices[]; }; \
+uniform int hasInstancePoses; \
 \n#endif\n \
 \
 out vec3 fragPos; \
@@ -847,16 +1917,36 @@ out vec3 N; \
 \
 void main() { \
 	\
+	vec3 pos = meshPositionOffset.xyz + encodedPos * meshPositionScale.xyz; \
+	vec3 normal = decodeDirection(encodedNormal); \
 	tCoords = texCoords; \
 	\
+	if (isInstanced == 2) { \
+		\
+		drawColor = draws[drawIndex].color; \
+		drawMaterial = draws[drawIndex].material; \
+		drawStretch = draws[drawIndex].stretch; \
+		\
+	} \
+	\
 	\n#ifdef ANIMATED\n \
 	mat4 boneModelMatrix = mat4(0.0f); \
 	mat3 boneNormalMatrix = mat3(0.0f); \
 	\
 	for (uint i = 0u; i < 4u; i++) { \
 		\
-		boneModelMatrix += boneModelMatrices[boneIndices[i]] * boneWeights[i]; \
-		boneNormalMatrix += boneNormalMatrices[boneIndices[i]] * boneWeights[i]; \
+		if (hasInstancePoses == 1) { \
+			\
+			boneModelMatrix += instanceBoneModelMatrices[instanceIndex * 64 + boneIndices[i]] * boneWeights[i]; \
+			boneNormalMatrix += instanceBoneNormalMatrices[instanceIndex * 64 + boneIndices[i]] * boneWeights[i]; \
+			\
+		} \
+		else { \
+			\
+			boneModelMatrix += boneModelMatrices[boneIndices[i]] * boneWeights[i]; \
+			boneNormalMatrix += boneNormalMatrices[boneIndices[i]] * boneWeights[i]; \
+			\
+		} \
 		\
 	} \
 	\
@@ -868,7 +1958,7 @@ void main() { \
 	\n#endif\n \
 	\
 	\n#ifdef NORMAL_MAP\n \
-	TBN = finalNormalMatrix * mat3(tangent, bitangent, normal); \
+	TBN = finalNormalMatrix * mat3(decodeDirection(encodedTangent), decodeDirection(encodedBitangent), normal); \
 	\n#else\n \
 	N = normalize(finalNormalMatrix * normal); \
 	\n#endif\n \
@@ -888,6 +1978,11 @@ in vec3 localFragPos; \
 \
 in vec2 tCoords; \
 \
+uniform int isInstanced; \
+flat in vec4 drawColor; \
+flat in vec4 drawMaterial; \
+flat in vec4 drawStretch; \
+\
 layout(std140, binding = 0) uniform PBR_inputs { \
 	\
 	mat4 modelMat; \
@@ -957,11 +2052,10 @@ uniform sampler2D BRDFSampler; \
 uniform samplerCube shadowSamplers[6]; \
 uniform int hasShadowSampler[6]; \
 \
-uniform sampler2D overheadShadowSampler[2]; \
-uniform mat4 overheadPVMatrix[2]; \
-uniform float overheadFarPlane[2]; \
-uniform vec3 bboxStart[2]; \
-uniform vec3 bboxEnd[2]; \
+uniform sampler2DArray overheadShadowSampler; \
+uniform mat4 overheadPVMatrix[8]; \
+uniform float overheadFarPlane[8]; \
+uniform int numOverheadShadowMaps; \
 uniform vec3 overheadLightDirection; \
 uniform vec3 overheadLightColor; \
 \
@@ -982,6 +2076,7 @@ const float numOverheadSamples = 6.0f; \
 const float overheadIncrement = 2.0f * overheadSampleDist / (numOverheadSamples - 1.0f); \
 const float overheadShadowDecay = 4.0f; \
 const float overheadCutoff = 0.6f; \
+const float overheadBlendWidth = 0.1f; \
 const float lightThreshold = 0.001f; \
 \
 const vec3 offsets[numSamples] = vec3[]( \
@@ -1027,7 +2122,7 @@ float getOverheadShadowValue_atIndex(uint i) { \
 			for (float y = -overheadSampleDist; y <= overheadSampleDist * bufferValue; y += overheadIncrement) { \
 				\
 				vec3 shadowNDC = clamp((overheadPVMatrix[i] * vec4(fragPos, 1.0f)).xyz * 0.5f + 0.5f, 0.0f, 1.0f); \
-				float shadowMapDist = texture(overheadShadowSampler[i], shadowNDC.xy + vec2(x, y)).x; \
+				float shadowMapDist = texture(overheadShadowSampler, vec3(shadowNDC.xy + vec2(x, y), float(i))).x; \
 				float dist = shadowNDC.z; \
 				totalShadowValue += (dist <= shadowMapDist) ? 1.0 : 0.0; \
 				totalNumSamples += 1.0f; \
@@ -1043,16 +2138,20 @@ float getOverheadShadowValue_atIndex(uint i) { \
 \
 float getOverheadShadowValue() {  \
 	\
-	if (overheadFarPlane[1] == 0.0f) return getOverheadShadowValue_atIndex(0u); \
-	\
-	vec3 t = (fragPos - bboxStart[0]) / (bboxEnd[0] - bboxStart[0]); \
-	t = 20.0f * min(t, 1.0f - t); \
-	t = 1.0f - clamp(t, 0.0f, 1.0f); \
-	float ts = max(t.x, max(t.y, t.z)); \
+	for (int i = 0; i < numOverheadShadowMaps; i++) { \
+		\
+		vec3 NDC = (overheadPVMatrix[i] * vec4(fragPos, 1.0f)).xyz; \
+		float border = 1.0f - max(abs(NDC.x), abs(NDC.y)); \
+		bool isLast = i == numOverheadShadowMaps - 1; \
+		if (border <= 0.0f && !isLast) continue; \
+		\
+		float shadowValue = getOverheadShadowValue_atIndex(uint(i)); \
+		if (border >= overheadBlendWidth || isLast) return shadowValue; \
+		else return mix(getOverheadShadowValue_atIndex(uint(i + 1)), shadowValue, border / overheadBlendWidth); \
+		\
+	} \
 	\
-	if (ts == 0.0f) return getOverheadShadowValue_atIndex(0u); \
-	else if (ts == 1.0f) return getOverheadShadowValue_atIndex(1u); \
-	else return mix(getOverheadShadowValue_atIndex(0u), getOverheadShadowValue_atIndex(1u), ts); \
+	return 1.0f; \
 	\
 } \
 \
@@ -1178,45 +2277,56 @@ vec3 calc_PBR_color(vec3 albedo, float metallic, float roughness, float ao, floa
 } \
 \
 void main() { \
+	\
+	bool isIndirect = isInstanced == 2; \
 	\
 	\n#ifdef ALBEDO_2D_TEXTURE\n \
-	vec4 inColor = texture(albedoSampler, tCoords); \
+	vec4 baseColor = texture(albedoSampler, tCoords); \
 	\n#elif defined ALBEDO_3D_TEXTURE\n \
-	vec4 inColor = texture(albedoSampler, localFragPos * albedoStretch); \
+	vec4 baseColor = texture(albedoSampler, localFragPos * (isIndirect ? drawStretch.x : albedoStretch)); \
+	\n#else\n \
+	vec4 baseColor = isIndirect ? drawColor : inColor; \
 	\n#endif\n \
 	\
 	\n#ifdef NORMAL_2D_TEXTURE\n \
 	vec3 N_final = normalize(TBN * (2.0f * texture(normalSampler, tCoords).xyz - 1.0f)); \
 	\n#elif defined NORMAL_3D_TEXTURE\n \
-	vec3 N_final = normalize(N + texture(normalSampler, localFragPos * normalStretch).xyz); \
+	vec3 N_final = normalize(N + texture(normalSampler, localFragPos * (isIndirect ? drawStretch.w : normalStretch)).xyz); \
 	\n#else\n \
 	vec3 N_final = N; \
 	\n#endif\n \
 	\
 	\n#ifdef METALLIC_ROUGHNESS_SAMPLER\n \
 	vec2 metallicRoughness = texture(metallicRoughnessSampler, tCoords).rg; \
-	float metallic = metallicRoughness.r; \
-	float roughness = metallicRoughness.g; \
+	float metallicValue = metallicRoughness.r; \
+	float roughnessValue = metallicRoughness.g; \
 	\n#endif\n \
 	\
-	\n#ifdef METALLIC_2D_TEXTURE\n \
-	float metallic = texture(metallicSampler, tCoords).r; \
+	\n#ifdef METALLIC_UNIFORM\n \
+	float metallicValue = isIndirect ? drawMaterial.x : metallic; \
+	\n#elif defined METALLIC_2D_TEXTURE\n \
+	float metallicValue = texture(metallicSampler, tCoords).r; \
 	\n#elif defined METALLIC_3D_TEXTURE\n \
-	float metallic = texture(metallicSampler, localFragPos * metallicStretch).r; \
+	float metallicValue = texture(metallicSampler, localFragPos * (isIndirect ? drawStretch.y : metallicStretch)).r; \
 	\n#endif\n \
 	\
-	\n#ifdef ROUGHNESS_2D_TEXTURE\n \
-	float roughness = texture(roughnessSampler, tCoords).r; \
+	\n#ifdef ROUGHNESS_UNIFORM\n \
+	float roughnessValue = isIndirect ? drawMaterial.y : roughness; \
+	\n#elif defined ROUGHNESS_2D_TEXTURE\n \
+	float roughnessValue = texture(roughnessSampler, tCoords).r; \
 	\n#elif defined ROUGHNESS_3D_TEXTURE\n \
-	float roughness = texture(roughnessSampler, localFragPos * roughnessStretch).r; \
+	float roughnessValue = texture(roughnessSampler, localFragPos * (isIndirect ? drawStretch.z : roughnessStretch)).r; \
 	\n#endif\n \
 	\
-	vec3 albedo = pow(inColor.rgb, vec3(2.2f)); \
+	vec3 albedo = pow(baseColor.rgb, vec3(2.2f)); \
 	vec3 V = normalize(camPos - fragPos); \
 	\
-	vec3 color = calc_PBR_color(albedo, metallic, roughness, ao, shadowOcclusion, N_final, V, fragPos); \
+	float aoValue = isIndirect ? drawMaterial.z : ao; \
+	float shadowOcclusionValue = isIndirect ? drawMaterial.w : shadowOcclusion; \
+	\
+	vec3 color = calc_PBR_color(albedo, metallicValue, roughnessValue, aoValue, shadowOcclusionValue, N_final, V, fragPos); \
 	color = color / (color + vec3(1.0f)); \
 	color = pow(color, vec3(1.0f / 2.2f)); \
-	fragColor = vec4(color, inColor.a); \
+	fragColor = vec4(color, baseColor.a); \
 	\
 }";
@@ -2,6 +2,8 @@
 #define MODEL_HPP
 
 #include <vector>
+#include <string>
+#include <unordered_map>
 
 #include "./../Texture/Image.hpp"
 #include "./../util/util.hpp"
@@ -13,8 +15,13 @@
 #include "./Scene.hpp"
 #include "./../util/Timer.hpp"
 #include "./Model_types.hpp"
+#include "./ModelFile.hpp"
 #include "./ModelInstanceBuffer.hpp"
 #include "./ModelProgram.hpp"
+#include "./SkinnedVertexBuffer.hpp"
+
+// Index held by a model whose load failed and whose model data was already evicted.
+#define _GL_Model_noModelData 0xFFFFFFFFu
 
 namespace GL {
 
@@ -39,6 +46,10 @@ namespace GL {
 
 		void setShadowOcclusion(float value);
 
+		void setLodTolerance(float tolerance);
+
+		void setShadowLodBias(unsigned int numLevels);
+
 		void setInstanceBuffer(ModelInstanceBuffer& instances);
 
 		void useInstances(bool use);
@@ -55,12 +66,24 @@ namespace GL {
 
 		float getShadowOcclusion() const;
 
+		float getLodTolerance() const;
+
+		unsigned int getShadowLodBias() const;
+
 		unsigned int getNumAnimations() const;
 
 		BoundingBox getBoundingBox() const;
 
 		BoundingBox getWorldSpaceBoundingBoxApproximation() const;
 
+		static BoundingBox getFileBoundingBox(const char* filePath);
+
+		// Models loaded afterwards store their meshes in buffers shared by all meshes of the same vertex format,
+		// which lets a scene's render queue draw them with glMultiDrawElementsIndirect.
+		static void useMeshPacking(bool use);
+
+		static bool usesMeshPacking();
+
 		bool isAnimated() const;
 
 		void playAnimation(unsigned int index, bool loop);
@@ -71,14 +94,63 @@ namespace GL {
 
 		bool isAnimationDone() const;
 
+		// Adds a clip to the animation mixer and returns its layer. The layers are blended in the local bone transforms before the
+		// hierarchy is concatenated once, so the cost grows with the number of layers and not with the loaded animations. Override
+		// layers are averaged by weight, additive layers are added on top as their difference to the bind pose. While layers exist
+		// they replace the animation started by playAnimation.
+		unsigned int addAnimationLayer(unsigned int animationIndex, float weight = 1.0f, bool additive = false);
+
+		// Time is in seconds and the clips loop.
+		void setAnimationLayer(unsigned int layer, unsigned int animationIndex, float time);
+
+		void setAnimationLayerWeight(unsigned int layer, float weight);
+
+		// Limits the layer to a bone node (in model file order) and its children, _GL_Model_noBoneMask blends the whole skeleton.
+		void setAnimationLayerMask(unsigned int layer, unsigned int boneNode);
+
+		// Fades the layer from its current clip to the new one, which starts at time 0.
+		void crossfadeAnimationLayer(unsigned int layer, unsigned int animationIndex, float seconds);
+
+		void advanceAnimationLayers(float seconds);
+
+		void clearAnimationLayers();
+
+		unsigned int getNumAnimationLayers() const;
+
+		const Model_types::AnimationLayer& getAnimationLayer(unsigned int layer) const;
+
+		bool isPoseChanging() const;
+
+		unsigned int getPoseVersion() const;
+
 		bool isInstanced() const;
 
+		// The change version of the instance buffer (see ModelInstanceBuffer::getChangeVersion), 0 if the model is not instanced.
+		unsigned int getInstanceVersion() const;
+
+		// True if the instance buffer gives every instance its own animation (see ModelInstanceBuffer::setAnimation).
+		bool hasInstancePoses() const;
+
+		// Skins the vertices of a non-instanced animated model once per frame with a compute shader, every pass of the frame then draws
+		// the skinned vertices with the non-animated shaders. Enabled by default.
+		void useGpuSkinning(bool use);
+
+		bool usesGpuSkinning() const;
+
+		bool isPreSkinned() const;
+
+		// Identifies the levels of detail the shadow passes currently select, cached shadow maps are redrawn when it changes.
+		unsigned int getShadowLodKey(Scene& scene) const;
+
 		void setSamplingFactor3D(TextureType type, float value);
 
 		void draw(Scene& scene, SampleSettings reqSettings = SampleSettings{ });
 		
 		void drawShadow(mat4 PV, mat4 model, Scene& scene);
 
+		// Adds the meshes of the model to the queue instead of drawing them, returns false if the model has to be drawn directly.
+		bool enqueue(RenderQueue& queue, Scene& scene, SampleSettings reqSettings = SampleSettings{ });
+
 		~Model();
 
 	protected:
@@ -90,6 +162,23 @@ namespace GL {
 		bool isAnimationPlaying = false;
 		bool isAnimationLooped;
 		bool isAnimationFinished = false;
+		unsigned int poseVersion = 0u;
+		unsigned int evaluatedPoseVersion = ~0u;
+		unsigned int boneDataVersion = 0u;
+		mat4* boneModelMatrices = nullptr;
+		unsigned char* boneNormalMatrices = nullptr;
+
+		std::vector<Model_types::AnimationLayer> animationLayers;
+		std::vector<Model_types::AnimationSample> animationSamples;
+
+		// Keyframe cursors of the bone nodes, per animation sample for the pose of the model and per instance for instance poses.
+		std::vector<Model_types::AnimationCursor> animationCursors;
+		std::vector<Model_types::AnimationCursor> instanceAnimationCursors;
+
+		bool gpuSkinning = true;
+		SkinnedVertexBuffer* skinnedVertices = nullptr;
+		unsigned int skinnedFrame = 0u;
+		unsigned int skinnedPoseVersion = ~0u;
 
 		mat4 model;
 		ModelInstanceBuffer* instancesBuf = nullptr;
@@ -106,6 +195,9 @@ namespace GL {
 		float ao = 1.0f;
 		float shadowOcclusion = 0.45f;
 
+		float lodTolerance = _GL_Model_defaultLodTolerance;
+		unsigned int shadowLodBias = 1u;
+
 		float albedoStretch = _GL_Model_defaultStretch;
 		float normalStretch = _GL_Model_defaultStretch;
 		float metallicStretch = _GL_Model_defaultStretch;
@@ -113,8 +205,10 @@ namespace GL {
 
 		bool isPhysicsModel;
 		
-		unsigned int thisModelDataIndex;
+		unsigned int thisModelDataIndex = _GL_Model_noModelData;
 		static std::vector<Model_types::ModelData> modelData;
+		static std::unordered_map<std::string, unsigned int> modelDataIndices;
+		static std::vector<unsigned int> freeModelDataIndices;
 
 		static ShaderLoader* PBR_vertShaders[_GL_Model_numVertShaders];
 		static ShaderLoader* PBR_fragShaders[_GL_Model_numFragShaders];
@@ -122,8 +216,20 @@ namespace GL {
 		static UniformTable* PBR_uniforms[_GL_Model_numPrograms];
 		static UniformBufferTable* PBR_commonUniforms;
 		static UniformBufferTable* PBR_animationMatrices;
+		static Model_types::ProgramHandles PBR_handles[_GL_Model_numPrograms];
+		static Model_types::CommonUniformHandles PBR_commonHandles;
+
+		// The model and bone data version whose palettes are currently in the bone uniform buffer.
+		static const Model* boneDataOwner;
+		static unsigned int boneDataOwnerVersion;
 		static bool PBR_initialized;
 
+		static std::vector<Model_types::MeshPool> meshPools;
+		static bool meshPacking;
+		static GLuint indirectDrawIndexBuffer;
+		static GLuint indirectCommandBuffer;
+		static GLuint indirectDrawDataBuffer;
+
 		static const char* PBR_vert_variable_code[_GL_Model_vertShaderVarCodeArrayLength];
 		static const char* PBR_frag_variable_code[_GL_Model_fragShaderVarCodeArrayLength];
 		static const char* PBR_vert_base_code;
@@ -131,15 +237,54 @@ namespace GL {
 
 		Model() { }
 
-		void loadMaterials(ReadBinaryFile& rbf);
+		static Model_types::ModelFileInfo verifyModelFile(ReadBinaryFile& rbf, const char* filePath);
+
+		static bool seekModelFileChunk(ReadBinaryFile& rbf, const Model_types::ModelFileInfo& info, unsigned int id, bool required = true);
+
+		static void loadMaterials(ReadBinaryFile& rbf, Model_types::ModelData& data, Model_types::ModelStaging& staging);
+
+		static void loadBoneNodes(ReadBinaryFile& rbf, Model_types::ModelData& data);
+
+		static void loadMeshData(ReadBinaryFile& rbf, Model_types::ModelData& data, Model_types::ModelStaging& staging);
+
+		virtual void loadMeshes(ReadBinaryFile& rbf, Model_types::ModelData& data, Model_types::ModelStaging& staging);
+
+		static void uploadTexture(Model_types::ModelData& data, const Model_types::TextureStaging& tex);
+
+		static void uploadMesh(Model_types::ModelData& data, const Model_types::MeshStaging& mesh);
+
+		static void releaseModelData(Model_types::ModelData& data);
+
+		static void setVertexQuantization(const Model_types::VertexQuantization& quantization);
+
+		static void setVertexAttributes(unsigned int vertexSize, bool compact, bool hasTextures, bool hasNormalMap, bool isAnimated, size_t baseOffset);
+
+		static unsigned int allocateMeshPool(const Model_types::MeshPool& format, unsigned int vertexBytes, unsigned int indexBytes);
+
+		static void releaseMeshPool(unsigned int index);
+
+		static bool findModelData(const std::string& name, unsigned int& index);
+
+		static unsigned int insertModelData(const std::string& name);
 
-		void loadBoneNodes(ReadBinaryFile& rbf);
+		static void evictModelData(unsigned int index);
 
-		virtual void loadMeshes(ReadBinaryFile& rbf);
+		float getProjectedSize(Scene& scene) const;
+
+		const Model_types::LevelOfDetail& selectLod(unsigned int meshIndex, float projectedSize, unsigned int bias) const;
+
+		bool usesInstanceCulling() const;
+
+		void cullInstances(Scene& scene, float projectedSize);
 
 		void updateUBOs(mat4 PV, mat4 modelMatrix, mat3 normalMatrix, Scene& scene, bool drawingShadow);
 
-		void updateModelMatrices(unsigned int idx, mat4 globalTransform);
+		void updateInstancePoses();
+
+		void updateAnimationSamples();
+
+		float getAnimationTicks(unsigned int animation, float seconds) const;
+
 
 		int getProgramIndex(bool isAnimated, bool hasSkybox, Model_types::SampleType albedo, Model_types::SampleType normal, bool hasMetallicRoughnessTex, Model_types::SampleType metallic, Model_types::SampleType roughness);
 
@@ -149,35 +294,52 @@ namespace GL {
 
 		static void compileProgram(unsigned int idx);
 
+		static void setSceneUniforms(unsigned int idx, Scene& scene);
+
+		static void beginQueuedDraws(Scene& scene);
+
+		void drawQueued(const RenderQueue_types::Item& item, RenderQueue& queue, Scene& scene);
+
+		void getIndirectDrawData(const RenderQueue_types::Item& item, RenderQueue_types::DrawData& drawData) const;
+
+		static void uploadIndirectDraws(const RenderQueue_types::IndirectCommand* commands, const RenderQueue_types::DrawData* drawData, unsigned int numDraws);
+
+		static void drawIndirect(const RenderQueue_types::Item& item, unsigned int firstCommand, unsigned int numCommands, RenderQueue& queue, Scene& scene);
+
+		friend class ModelLoader;
+		friend class RenderQueue;
+
 	};
 
 }
 
 #define _GL_Model_constructor(bboxDeclaration) \
-thisModelDataIndex = modelData.size(); \
-for (unsigned int i = 0u; i < modelData.size(); i++) \
-\
-if (strcmp(modelData[i].name, filePath) == 0) { \
-	\
-	thisModelDataIndex = i; \
-	break; \
-	\
-} \
-\
-if (thisModelDataIndex == modelData.size()) { \
+if (!findModelData(filePath, thisModelDataIndex)) { \
 	\
-	modelData.push_back(Model_types::ModelData{ }); \
-	modelData[thisModelDataIndex].name = filePath; \
+	thisModelDataIndex = insertModelData(filePath); \
 	\
-	ReadBinaryFile rbf(filePath, 1024 * 512); \
-	\
-	static char verify[5]; for (int i = 0; i < 5; i++) verify[i] = rbf.readByte(); \
-	if (verify[0] != 'm' || verify[1] != 'o' || verify[2] != 'd' || verify[3] != 'e' || verify[4] != 'l') throw Exception("Model file \"" + std::string(filePath) + "\" verification failed."); \
-	\
-	loadMaterials(rbf); \
-	loadBoneNodes(rbf); \
-	bboxDeclaration \
-	loadMeshes(rbf); \
+	try { \
+		\
+		ReadBinaryFile rbf(filePath, 1024 * 512, true); \
+		Model_types::ModelStaging staging; \
+		\
+		Model_types::ModelFileInfo info = verifyModelFile(rbf, filePath); \
+		modelData[thisModelDataIndex].fileVersion = info.version; \
+		\
+		seekModelFileChunk(rbf, info, _GL_ModelFile_chunk_materials); \
+		loadMaterials(rbf, modelData[thisModelDataIndex], staging); \
+		seekModelFileChunk(rbf, info, _GL_ModelFile_chunk_boneNodes); \
+		loadBoneNodes(rbf, modelData[thisModelDataIndex]); \
+		if (isPhysicsModel && modelData[thisModelDataIndex].numAnimations) throw Exception("A physics model cannot be animated."); \
+		bboxDeclaration \
+		seekModelFileChunk(rbf, info, _GL_ModelFile_chunk_meshes); \
+		loadMeshes(rbf, modelData[thisModelDataIndex], staging); \
+		\
+		for (unsigned int i = 0u; i < staging.textures.size(); i++) uploadTexture(modelData[thisModelDataIndex], staging.textures[i]); \
+		for (unsigned int i = 0u; i < staging.meshes.size(); i++) uploadMesh(modelData[thisModelDataIndex], staging.meshes[i]); \
+		\
+	} \
+	catch (...) { evictModelData(thisModelDataIndex); thisModelDataIndex = _GL_Model_noModelData; throw; } \
 	\
 	if (!PBR_initialized) { \
 		\
@@ -200,114 +362,102 @@ if (thisModelDataIndex == modelData.size()) { \
 modelData[thisModelDataIndex].referenceCount++;
 
 #define _GL_Model_loadMeshes(physicsCode0, physicsCode1, physicsCode2) \
-modelData[thisModelDataIndex].numMeshes = rbf.read<unsigned int>(); \
-if (modelData[thisModelDataIndex].numMeshes) { \
+data.numMeshes = rbf.read<unsigned int>(); \
+if (data.numMeshes) { \
 	\
 	physicsCode0 \
 	\
-	modelData[thisModelDataIndex].vaos = new GLuint[modelData[thisModelDataIndex].numMeshes]; \
-	modelData[thisModelDataIndex].vaos_shadow = new GLuint[modelData[thisModelDataIndex].numMeshes]; \
-	modelData[thisModelDataIndex].vbos = new GLuint[modelData[thisModelDataIndex].numMeshes]; \
-	modelData[thisModelDataIndex].ebos = new GLuint[modelData[thisModelDataIndex].numMeshes]; \
-	modelData[thisModelDataIndex].numElements = new unsigned int[modelData[thisModelDataIndex].numMeshes]; \
-	modelData[thisModelDataIndex].matIndices = new unsigned int[modelData[thisModelDataIndex].numMeshes]; \
+	data.vaos = new GLuint[data.numMeshes](); \
+	data.vaos_shadow = new GLuint[data.numMeshes]; \
+	data.vbos = new GLuint[data.numMeshes]; \
+	data.ebos = new GLuint[data.numMeshes]; \
+	data.numElements = new unsigned int[data.numMeshes]; \
+	data.indexTypes = new GLenum[data.numMeshes]; \
+	data.matIndices = new unsigned int[data.numMeshes]; \
+	data.quantization = new Model_types::VertexQuantization[data.numMeshes]; \
+	data.vertexLayouts = new Model_types::VertexLayout[data.numMeshes]; \
+	data.lods = new std::vector<Model_types::LevelOfDetail>[data.numMeshes]; \
+	data.meshPools = new unsigned int[data.numMeshes]; \
+	data.baseVertices = new int[data.numMeshes]; \
 	\
-	for (unsigned int i = 0u; i < modelData[thisModelDataIndex].numMeshes; i++) { \
+	for (unsigned int i = 0u; i < data.numMeshes; i++) { \
 		\
 		unsigned int dataSize = rbf.read<unsigned int>(); \
 		unsigned int vertexSize = rbf.read<unsigned int>(); \
 		bool hasNormalMap = rbf.read<bool>(); \
-		modelData[thisModelDataIndex].numElements[i] = rbf.read<unsigned int>(); \
-		modelData[thisModelDataIndex].matIndices[i] = rbf.read<unsigned int>(); \
+		data.numElements[i] = rbf.read<unsigned int>(); \
+		data.matIndices[i] = rbf.read<unsigned int>(); \
 		\
-		if (dataSize && modelData[thisModelDataIndex].numElements[i]) { \
-			\
-			char* vertexData = new char[dataSize]; \
-			for (unsigned int j = 0u; j < dataSize; j++) vertexData[j] = rbf.readByte(); \
-			\
-			unsigned int* indexData = new unsigned int[modelData[thisModelDataIndex].numElements[i]]; \
-			for (unsigned int j = 0u; j < modelData[thisModelDataIndex].numElements[i]; j++) indexData[j] = rbf.read<unsigned int>(); \
-			bool deleteIndices = true; \
-			\
-			glGenVertexArrays(1, &modelData[thisModelDataIndex].vaos[i]); \
-			glBindVertexArray(modelData[thisModelDataIndex].vaos[i]); \
+		unsigned int vertexFormat = (data.fileVersion >= 3u) ? rbf.read<unsigned int>() : _GL_ModelFile_vertexFormat_float; \
+		if (vertexFormat == _GL_ModelFile_vertexFormat_compact) { \
 			\
-			glGenBuffers(1, &modelData[thisModelDataIndex].vbos[i]); \
-			glBindBuffer(GL_ARRAY_BUFFER, modelData[thisModelDataIndex].vbos[i]); \
+			data.quantization[i].compact = true; \
+			for (int k = 0; k < 3; k++) data.quantization[i].positionOffset[k] = rbf.read<float>(); \
+			for (int k = 0; k < 3; k++) data.quantization[i].positionScale[k] = rbf.read<float>(); \
 			\
-			glGenBuffers(1, &modelData[thisModelDataIndex].ebos[i]); \
-			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, modelData[thisModelDataIndex].ebos[i]); \
-			\
-			glBufferData(GL_ARRAY_BUFFER, dataSize, vertexData, GL_STATIC_DRAW); \
-			glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(unsigned int) * modelData[thisModelDataIndex].numElements[i], indexData, GL_STATIC_DRAW); \
-			\
-			unsigned int offset = 0u; \
-			Model_types::Material& m = modelData[thisModelDataIndex].mats[modelData[thisModelDataIndex].matIndices[i]]; \
-			bool hasTextures = m.baseTex > 0u || m.normalTex > 0u || m.metallicRoughnessTex > 0u; \
+		} \
+		else if (vertexFormat != _GL_ModelFile_vertexFormat_float) throw Exception("Unknown vertex format " + std::to_string(vertexFormat) + " in model file."); \
+		\
+		unsigned int indexSize = (data.fileVersion >= 4u) ? rbf.read<unsigned int>() : sizeof(unsigned int); \
+		if (indexSize != sizeof(unsigned short) && indexSize != sizeof(unsigned int)) throw Exception("Invalid index size " + std::to_string(indexSize) + " in model file."); \
+		data.indexTypes[i] = (indexSize == sizeof(unsigned short)) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT; \
+		data.lods[i].push_back(Model_types::LevelOfDetail{ 0u, data.numElements[i], 0.0f }); \
+		\
+		if (dataSize && data.numElements[i]) { \
 			\
-			glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, vertexSize, (void*)(unsigned long long)offset); offset += sizeof(vec3); \
-			glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, vertexSize, (void*)(unsigned long long)offset); offset += sizeof(vec3); \
-			glEnableVertexAttribArray(0); \
-			glEnableVertexAttribArray(1); \
+			if (data.fileVersion >= 2u) rbf.align(_GL_ModelFile_alignment); \
+			const char* vertexData = rbf.view(dataSize); \
+			if (data.fileVersion >= 2u) rbf.align(_GL_ModelFile_alignment); \
+			const char* indexData = (indexSize == sizeof(unsigned short)) ? (const char*)rbf.readSpan<unsigned short>(data.numElements[i]) : (const char*)rbf.readSpan<unsigned int>(data.numElements[i]); \
 			\
-			if (hasTextures) { \
+			Model_types::MeshStaging mesh{ i, vertexData, indexData, nullptr, dataSize, vertexSize, hasNormalMap, indexSize, data.numElements[i] }; \
+			if (!rbf.isZeroCopy()) { \
 				\
-				glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, vertexSize, (void*)(unsigned long long)offset); offset += sizeof(vec2); \
-				glEnableVertexAttribArray(2); \
+				mesh.ownedIndices = new char[indexSize * data.numElements[i]]; \
+				memcpy(mesh.ownedIndices, indexData, indexSize * data.numElements[i]); \
+				mesh.indexData = mesh.ownedIndices; \
 				\
 			} \
 			\
-			if (hasNormalMap) { \
-				\
-				glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, vertexSize, (void*)(unsigned long long)offset); offset += sizeof(vec3); \
-				glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, vertexSize, (void*)(unsigned long long)offset); offset += sizeof(vec3); \
-				glEnableVertexAttribArray(3); \
-				glEnableVertexAttribArray(4); \
-				\
-			} \
-			\
-			unsigned int boneDataOffset = offset; \
+			staging.meshes.push_back(mesh); \
+			Model_types::MeshStaging& staged = staging.meshes.back(); \
 			\
-			if (modelData[thisModelDataIndex].boneNodes) { \
+			unsigned int numLods = (data.fileVersion >= 5u) ? rbf.read<unsigned int>() : 0u; \
+			if (numLods) { \
 				\
-				glVertexAttribIPointer(5, 4, GL_INT, vertexSize, (void*)(unsigned long long)offset); offset += sizeof(ivec4); \
-				glVertexAttribPointer(6, 4, GL_FLOAT, GL_FALSE, vertexSize, (void*)(unsigned long long)offset); \
-				glEnableVertexAttribArray(5); \
-				glEnableVertexAttribArray(6); \
+				std::vector<char> allIndices(staged.indexData, staged.indexData + indexSize * data.numElements[i]); \
 				\
-			} \
-			\
-			glGenVertexArrays(1, &modelData[thisModelDataIndex].vaos_shadow[i]); \
-			glBindVertexArray(modelData[thisModelDataIndex].vaos_shadow[i]); \
-			\
-			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, modelData[thisModelDataIndex].ebos[i]); \
-			\
-			glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, vertexSize, (void*)0); \
-			glEnableVertexAttribArray(0); \
-			\
-			if (modelData[thisModelDataIndex].boneNodes) { \
+				for (unsigned int j = 0u; j < numLods; j++) { \
+					\
+					float error = rbf.read<float>(); \
+					unsigned int numLodElements = rbf.read<unsigned int>(); \
+					rbf.align(_GL_ModelFile_alignment); \
+					const char* lodData = (indexSize == sizeof(unsigned short)) ? (const char*)rbf.readSpan<unsigned short>(numLodElements) : (const char*)rbf.readSpan<unsigned int>(numLodElements); \
+					\
+					data.lods[i].push_back(Model_types::LevelOfDetail{ staged.numIndices, numLodElements, error }); \
+					allIndices.insert(allIndices.end(), lodData, lodData + indexSize * numLodElements); \
+					staged.numIndices += numLodElements; \
+					\
+				} \
 				\
-				glVertexAttribIPointer(5, 4, GL_INT, vertexSize, (void*)(unsigned long long)boneDataOffset); boneDataOffset += sizeof(ivec4); \
-				glVertexAttribPointer(6, 4, GL_FLOAT, GL_FALSE, vertexSize, (void*)(unsigned long long)boneDataOffset); \
-				glEnableVertexAttribArray(5); \
-				glEnableVertexAttribArray(6); \
+				char* ownedIndices = new char[allIndices.size()]; \
+				memcpy(ownedIndices, allIndices.data(), allIndices.size()); \
+				if (staged.ownedIndices) delete[] staged.ownedIndices; \
+				staged.ownedIndices = ownedIndices; \
+				staged.indexData = staged.ownedIndices; \
 				\
 			} \
 			\
-			physicsCode1 \
+			indexData = staged.indexData; \
 			\
-			delete[] vertexData; \
-			if (deleteIndices) delete[] indexData; \
+			physicsCode1 \
 			\
 		} \
-		else modelData[thisModelDataIndex].vaos[i] = 0u; \
 		\
 	} \
 	\
-	glBindVertexArray(0); \
-	\
 	physicsCode2 \
 	\
 }
 
-#endif
\ No newline at end of file
+#endif
\ No newline at end of file
@@ -3,7 +3,12 @@
 
 #ifdef BUILD_MODEL_CONVERTER
 
-GL::ModelConverter::ModelConverter(const char* meshFile, const char* outFile) {
+GL::ModelConverter::ModelConverter(const char* meshFile, const char* outFile, unsigned int fileVersion, bool compactVertices, bool optimizeVertexCache, bool optimizeOverdraw, unsigned int numLods)
+	: fileVersion(fileVersion), compactVertices(compactVertices), optimizeVertexCache(optimizeVertexCache), optimizeOverdraw(optimizeOverdraw), numLods(numLods) {
+
+	if (fileVersion < 1u || fileVersion > _GL_ModelFile_version) throw Exception("Unsupported model file version " + std::to_string(fileVersion) + ".");
+	if (compactVertices && fileVersion < 3u) throw Exception("Compact vertices require model file version 3 or higher.");
+	if (numLods && fileVersion < 5u) throw Exception("Levels of detail require model file version 5 or higher.");
 
 	WriteBinaryFile wbf(outFile, 1024 * 512);
 
@@ -40,19 +45,40 @@ GL::ModelConverter::ModelConverter(const char* meshFile, const char* outFile) {
 	meshes_head = new ModelConverter_types::VertexArrayData{ };
 	indices = new unsigned int* [numMeshes];
 	numElements = new unsigned int[numMeshes];
+	lods = new std::vector<ModelConverter_types::LevelOfDetail>[numMeshes];
 	matIndices = new unsigned int[numMeshes];
 
 	unsigned int index = 0u;
 	ModelConverter_types::VertexArrayData* curMesh = meshes_head;
 	processNode(scene->mRootNode, aiMatrix4x4(), curMesh, index);
 
-	wbf.writeRawData((char*)"model", 5);
-	saveMaterials(wbf);
-	saveBoneNodes(wbf);
-	saveMeshes(wbf);
+	if (fileVersion == 1u) {
+
+		wbf.writeRawData((char*)"model", 5);
+		saveMaterials(wbf);
+		saveBoneNodes(wbf);
+		saveMeshes(wbf);
+
+	}
+	else {
+
+		wbf.writeRawData((char*)_GL_ModelFile_magic, _GL_ModelFile_magicLength);
+		wbf.write<unsigned int>(fileVersion);
+		wbf.write<unsigned int>(4u);
+		for (unsigned int i = 0u; i < 4u; i++) wbf.write<unsigned int>(0u);
+		for (unsigned int i = 0u; i < 4u * _GL_ModelFile_chunkEntrySize / 4u; i++) wbf.write<unsigned int>(0u);
+
+		saveChunk(wbf, 0u, _GL_ModelFile_chunk_boundingBox, &ModelConverter::saveBoundingBox);
+		saveChunk(wbf, 1u, _GL_ModelFile_chunk_materials, &ModelConverter::saveMaterials);
+		saveChunk(wbf, 2u, _GL_ModelFile_chunk_boneNodes, &ModelConverter::saveBoneNodes);
+		saveChunk(wbf, 3u, _GL_ModelFile_chunk_meshes, &ModelConverter::saveMeshes);
+
+	}
 
 }
 
+const std::vector<GL::ModelConverter_types::MeshStatistics>& GL::ModelConverter::getMeshStatistics() const { return meshStatistics; }
+
 GL::ModelConverter::~ModelConverter() {
 
 	if (mats) {
@@ -87,6 +113,7 @@ GL::ModelConverter::~ModelConverter() {
 		delete[] indices;
 
 		delete[] numElements;
+		delete[] lods;
 		delete[] matIndices;
 
 	}
@@ -290,7 +317,7 @@ void GL::ModelConverter::loadTextures(std::string thisDirectory) {
 		else if (!hasMR && hasN) matFormats[i] = ModelConverter_types::MaterialFormat::BN;
 		else matFormats[i] = ModelConverter_types::MaterialFormat::B;
 
-		representations[i] = VertexStructRepresentation(hasAlbedo || hasMR || hasN, hasN, boneNodes != nullptr);
+		representations[i] = VertexStructRepresentation(hasAlbedo || hasMR || hasN, hasN, boneNodes != nullptr, compactVertices);
 
 	}
 
@@ -324,104 +351,257 @@ void GL::ModelConverter::processNode(aiNode* node, aiMatrix4x4 transform, ModelC
 		curMesh->vertexSize = rep.dataSize;
 		curMesh->data = (void*)(new char[curMesh->dataSize]);
 
+		vec3* positions = new vec3[mesh->mNumVertices];
+		vec3 meshStart, meshEnd;
+
 		for (unsigned int j = 0u; j < mesh->mNumVertices; j++) {
 
 			aiVector3D aiPos = mesh->mVertices[j];
+			positions[j] = (GL_transform * vec4(aiPos.x, aiPos.y, aiPos.z, 1.0f))(0, 1, 2);
+
+			if (j == 0u) {
+
+				meshStart = positions[j];
+				meshEnd = positions[j];
+
+			}
+			else for (int k = 0; k < 3; k++) {
+
+				if (positions[j][k] < meshStart[k]) meshStart[k] = positions[j][k];
+				if (positions[j][k] > meshEnd[k]) meshEnd[k] = positions[j][k];
+
+			}
+
+		}
+
+		curMesh->positionOffset = meshStart;
+		curMesh->positionScale = meshEnd - meshStart;
+
+		if (mesh->mNumVertices) {
+
+			if (first) {
+
+				bboxStart = meshStart;
+				bboxEnd = meshEnd;
+				first = false;
+
+			}
+			else for (int k = 0; k < 3; k++) {
+
+				if (meshStart[k] < bboxStart[k]) bboxStart[k] = meshStart[k];
+				if (meshEnd[k] > bboxEnd[k]) bboxEnd[k] = meshEnd[k];
+
+			}
+
+		}
+
+		for (unsigned int j = 0u; j < mesh->mNumVertices; j++) {
+
 			aiVector3D aiNormal = mesh->mNormals[j];
+			vec3 normal = normalize(normalTransform * vec3(aiNormal));
 
-			_GL_ModelConverter_declareReference(pos, vec3, POSITION, j);
-			_GL_ModelConverter_declareReference(normal, vec3, NORMAL, j);
+			if (compactVertices) {
 
-			pos = (GL_transform * vec4(aiPos.x, aiPos.y, aiPos.z, 1.0f))(0, 1, 2);
-			normal = normalize(normalTransform * vec3(aiNormal));
+				_GL_ModelConverter_declareReference(quantizedPos, ModelConverter_types::u16vec4, POSITION, j);
+				_GL_ModelConverter_declareReference(encodedNormal, ModelConverter_types::i16vec2, NORMAL, j);
 
-			if (rep.hasComponent(VertexStructRepresentation::TEX_COORDS)) {
+				for (int k = 0; k < 3; k++) quantizedPos[k] = (curMesh->positionScale[k] > 0.0f) ? (unsigned short)((positions[j][k] - meshStart[k]) / curMesh->positionScale[k] * 65535.0f + 0.5f) : 0u;
+				quantizedPos[3] = 0u;
+				encodedNormal = encodeOctahedral(normal);
+
+			}
+			else {
+
+				_GL_ModelConverter_declareReference(pos, vec3, POSITION, j);
+				_GL_ModelConverter_declareReference(floatNormal, vec3, NORMAL, j);
 
-				_GL_ModelConverter_declareReference(texCoords, vec2, TEX_COORDS, j);
+				pos = positions[j];
+				floatNormal = normal;
+
+			}
+
+			if (rep.hasComponent(VertexStructRepresentation::TEX_COORDS)) {
 
 				aiVector3D aiTexCoords;
 				if (mesh->mTextureCoords[0]) aiTexCoords = mesh->mTextureCoords[0][j];
-				texCoords = vec2(aiTexCoords);
 
-			}
+				if (compactVertices) {
 
-			if (rep.hasComponent(VertexStructRepresentation::TANGENT)) {
+					_GL_ModelConverter_declareReference(halfTexCoords, ModelConverter_types::u16vec2, TEX_COORDS, j);
+					halfTexCoords = ModelConverter_types::u16vec2(toHalfFloat(aiTexCoords.x), toHalfFloat(aiTexCoords.y));
 
-				_GL_ModelConverter_declareReference(tangent, vec3, TANGENT, j);
-				_GL_ModelConverter_declareReference(bitangent, vec3, BITANGENT, j);
+				}
+				else {
 
-				aiVector3D aiTangents = mesh->mTangents[j];
-				aiVector3D aiBitangents = mesh->mBitangents[j];
+					_GL_ModelConverter_declareReference(texCoords, vec2, TEX_COORDS, j);
+					texCoords = vec2(aiTexCoords);
 
-				tangent = normalize(vec3((GL_transform * vec4(aiTangents.x, aiTangents.y, aiTangents.z, 1.0f))(0, 1, 2)));
-				bitangent = normalize(vec3((GL_transform * vec4(aiBitangents.x, aiBitangents.y, aiBitangents.z, 1.0f))(0, 1, 2)));
+				}
 
 			}
 
-			if (rep.hasComponent(VertexStructRepresentation::BONE_INDICES)) {
+			if (rep.hasComponent(VertexStructRepresentation::TANGENT)) {
 
-				_GL_ModelConverter_declareReference(boneIndices, ivec4, BONE_INDICES, j);
-				_GL_ModelConverter_declareReference(boneWeights, vec4, BONE_WEIGHTS, j);
+				aiVector3D aiTangents = mesh->mTangents[j];
+				aiVector3D aiBitangents = mesh->mBitangents[j];
 
-				boneIndices = ivec4(); boneWeights = ivec4();
+				vec3 tangent = normalize(vec3((GL_transform * vec4(aiTangents.x, aiTangents.y, aiTangents.z, 1.0f))(0, 1, 2)));
+				vec3 bitangent = normalize(vec3((GL_transform * vec4(aiBitangents.x, aiBitangents.y, aiBitangents.z, 1.0f))(0, 1, 2)));
 
-			}
+				if (compactVertices) {
 
-			if (first) {
+					_GL_ModelConverter_declareReference(encodedTangent, ModelConverter_types::i16vec2, TANGENT, j);
+					_GL_ModelConverter_declareReference(encodedBitangent, ModelConverter_types::i16vec2, BITANGENT, j);
 
-				bboxStart = pos;
-				bboxEnd = pos;
-				first = false;
+					encodedTangent = encodeOctahedral(tangent);
+					encodedBitangent = encodeOctahedral(bitangent);
 
-			}
-			else for (int k = 0; k < 3; k++) {
+				}
+				else {
+
+					_GL_ModelConverter_declareReference(floatTangent, vec3, TANGENT, j);
+					_GL_ModelConverter_declareReference(floatBitangent, vec3, BITANGENT, j);
 
-				if (pos[k] < bboxStart[k]) bboxStart[k] = pos[k];
-				if (pos[k] > bboxEnd[k]) bboxEnd[k] = pos[k];
+					floatTangent = tangent;
+					floatBitangent = bitangent;
+
+				}
 
 			}
 			
 		}
 
 		numElements[index] = 3u * mesh->mNumFaces;
-		indices[index] = new unsigned int[numElements[index]];
+		indices[index] = new unsigned int[numElements[index]]();
 
 		for (unsigned int j = 0u; j < mesh->mNumFaces; j++)
 			for (unsigned int k = 0u; k < mesh->mFaces[j].mNumIndices; k++) indices[index][3u * j + k] = mesh->mFaces[j].mIndices[k];
 		
-		if (boneNodes) for (unsigned int j = 0u; j < mesh->mNumBones; j++) {
+		if (rep.hasComponent(VertexStructRepresentation::BONE_INDICES)) {
 
-			aiBone* bone = mesh->mBones[j];
+			ivec4* boneIndices = new ivec4[mesh->mNumVertices];
+			vec4* boneWeights = new vec4[mesh->mNumVertices];
+
+			for (unsigned int j = 0u; j < mesh->mNumBones; j++) {
+
+				aiBone* bone = mesh->mBones[j];
+
+				unsigned int glIndex = 0u;
+				for (unsigned int k = 0u; k < numBoneNodes; k++) if (boneNodes[k].name == bone->mName.C_Str()) {
+
+					boneNodes[k].offset = assimpToGL(bone->mOffsetMatrix);
+					glIndex = boneNodes[k].glIndex;
+					break;
+
+				}
+
+				for (unsigned int k = 0u; k < bone->mNumWeights; k++) {
 
-			unsigned int glIndex = 0u;
-			for (unsigned int k = 0u; k < numBoneNodes; k++) if (boneNodes[k].name == bone->mName.C_Str()) {
+					unsigned int idx = bone->mWeights[k].mVertexId;
+					float weight = bone->mWeights[k].mWeight;
 
-				boneNodes[k].offset = assimpToGL(bone->mOffsetMatrix);
-				glIndex = boneNodes[k].glIndex;
-				break;
+					for (unsigned int l = 0u; l < 4u; l++)
 
+						if (boneWeights[idx][l] == 0.0f) {
+
+							boneWeights[idx][l] = weight;
+							boneIndices[idx][l] = (int)glIndex;
+							break;
+
+						}
+				}
 			}
 
-			for (unsigned int k = 0u; k < bone->mNumWeights; k++) {
+			for (unsigned int j = 0u; j < mesh->mNumVertices; j++) {
 
-				unsigned int idx = bone->mWeights[k].mVertexId;
-				float weight = bone->mWeights[k].mWeight;
+				if (compactVertices) {
 
-				_GL_ModelConverter_declareReference(boneIndices, ivec4, BONE_INDICES, idx);
-				_GL_ModelConverter_declareReference(boneWeights, vec4, BONE_WEIGHTS, idx);
+					_GL_ModelConverter_declareReference(packedIndices, ModelConverter_types::u8vec4, BONE_INDICES, j);
+					_GL_ModelConverter_declareReference(packedWeights, ModelConverter_types::u8vec4, BONE_WEIGHTS, j);
 
-				for (unsigned int l = 0u; l < 4u; l++)
+					// The weights are renormalized so that their quantized values still add up to exactly 255
+					float weightSum = boneWeights[j][0] + boneWeights[j][1] + boneWeights[j][2] + boneWeights[j][3];
+					int packedSum = 0;
+					unsigned int largest = 0u;
 
-					if (boneWeights[l] == 0.0f) {
+					for (unsigned int l = 0u; l < 4u; l++) {
 
-						boneWeights[l] = weight;
-						boneIndices[l] = (int)glIndex;
-						break;
+						packedIndices[l] = (unsigned char)boneIndices[j][l];
+						packedWeights[l] = (weightSum > 0.0f) ? (unsigned char)(boneWeights[j][l] / weightSum * 255.0f + 0.5f) : 0u;
+						packedSum += packedWeights[l];
+						if (boneWeights[j][l] > boneWeights[j][largest]) largest = l;
 
 					}
+
+					if (packedSum > 0) packedWeights[largest] = (unsigned char)((int)packedWeights[largest] + 255 - packedSum);
+
+				}
+				else {
+
+					_GL_ModelConverter_declareReference(floatIndices, ivec4, BONE_INDICES, j);
+					_GL_ModelConverter_declareReference(floatWeights, vec4, BONE_WEIGHTS, j);
+
+					floatIndices = boneIndices[j];
+					floatWeights = boneWeights[j];
+
+				}
+
 			}
+
+			delete[] boneIndices;
+			delete[] boneWeights;
+
 		}
 		
+		unsigned int numVertices = mesh->mNumVertices;
+		ModelConverter_types::MeshStatistics statistics{ numVertices, mesh->mNumFaces };
+		MeshOptimizer::simulateVertexCache(indices[index], numElements[index], numVertices, statistics.ACMRBefore, statistics.ATVRBefore);
+
+		unsigned int numPreviousElements = numElements[index];
+		for (unsigned int j = 1u; j <= numLods && numElements[index]; j++) {
+
+			ModelConverter_types::LevelOfDetail lod;
+			lod.indices.resize(numElements[index]);
+			lod.indices.resize(MeshOptimizer::simplify(lod.indices.data(), indices[index], numElements[index], positions, numVertices, 3u * ((numElements[index] / 3u) >> j), lod.error));
+
+			if (lod.indices.empty() || (float)lod.indices.size() > _GL_ModelConverter_minLodReduction * (float)numPreviousElements) break;
+
+			numPreviousElements = lod.indices.size();
+			statistics.lodTriangles.push_back(lod.indices.size() / 3u);
+			lods[index].push_back(lod);
+
+		}
+
+		if (optimizeVertexCache && numElements[index]) {
+
+			std::vector<unsigned int> clusters;
+			MeshOptimizer::optimizeVertexCache(indices[index], numElements[index], numVertices, &clusters);
+			if (optimizeOverdraw) MeshOptimizer::optimizeOverdraw(indices[index], numElements[index], positions, clusters);
+
+			std::vector<unsigned int> allIndices(indices[index], indices[index] + numElements[index]);
+			for (unsigned int j = 0u; j < lods[index].size(); j++) {
+
+				MeshOptimizer::optimizeVertexCache(lods[index][j].indices.data(), lods[index][j].indices.size(), numVertices);
+				allIndices.insert(allIndices.end(), lods[index][j].indices.begin(), lods[index][j].indices.end());
+
+			}
+
+			numVertices = MeshOptimizer::optimizeVertexFetch((char*)curMesh->data, curMesh->vertexSize, numVertices, allIndices.data(), allIndices.size());
+			curMesh->dataSize = numVertices * curMesh->vertexSize;
+
+			memcpy(indices[index], allIndices.data(), sizeof(unsigned int) * numElements[index]);
+			for (unsigned int j = 0u, offset = numElements[index]; j < lods[index].size(); offset += lods[index][j].indices.size(), j++) {
+
+				memcpy(lods[index][j].indices.data(), allIndices.data() + offset, sizeof(unsigned int) * lods[index][j].indices.size());
+
+			}
+
+		}
+
+		MeshOptimizer::simulateVertexCache(indices[index], numElements[index], numVertices, statistics.ACMRAfter, statistics.ATVRAfter);
+		meshStatistics.push_back(statistics);
+		delete[] positions;
+
 		index++;
 		curMesh->next = new ModelConverter_types::VertexArrayData{ nullptr, 0u, 0u, false, nullptr };
 		curMesh = curMesh->next;
@@ -468,7 +648,12 @@ int GL::ModelConverter::loadTexGL(Image& image, unsigned unit, unsigned int mat_
 w = mats[i].matType ## Width; h = mats[i].matType ## Height; idx = mats[i].matType ## Idx; \
 wbf.write<int>(idx); \
 wbf.write<unsigned int>(w); wbf.write<unsigned int>(h); \
-if (idx == -1 && w * h != 0u) wbf.writeRawData((char*)mats[i].matType ## TexData, w * h * numComps);
+if (idx == -1 && w * h != 0u) { \
+	\
+	if (fileVersion >= 2u) wbf.align(_GL_ModelFile_alignment); \
+	wbf.writeRawData((char*)mats[i].matType ## TexData, w * h * numComps); \
+	\
+}
 
 void GL::ModelConverter::saveMaterials(WriteBinaryFile& wbf) {
 
@@ -559,10 +744,41 @@ void GL::ModelConverter::saveMeshes(WriteBinaryFile& wbf) {
 		wbf.write<unsigned int>(numElements[i]);
 		wbf.write<unsigned int>(matIndices[i]);
 
+		if (fileVersion >= 3u) {
+
+			wbf.write<unsigned int>(compactVertices ? _GL_ModelFile_vertexFormat_compact : _GL_ModelFile_vertexFormat_float);
+			if (compactVertices) {
+
+				for (int k = 0; k < 3; k++) wbf.write<float>(curMesh->positionOffset[k]);
+				for (int k = 0; k < 3; k++) wbf.write<float>(curMesh->positionScale[k]);
+
+			}
+
+		}
+
+		bool shortIndices = fileVersion >= 4u && curMesh->vertexSize && curMesh->dataSize / curMesh->vertexSize <= 65536u;
+		if (fileVersion >= 4u) wbf.write<unsigned int>(shortIndices ? sizeof(unsigned short) : sizeof(unsigned int));
+
 		if (numElements[i] && curMesh->dataSize) {
 
+			if (fileVersion >= 2u) wbf.align(_GL_ModelFile_alignment);
 			wbf.writeRawData((char*)curMesh->data, curMesh->dataSize);
-			wbf.writeRawData((char*)indices[i], numElements[i] * sizeof(unsigned int));
+			saveIndices(wbf, indices[i], numElements[i], shortIndices);
+
+			if (fileVersion >= 5u) {
+
+				float extent = std::max(bboxEnd.x - bboxStart.x, std::max(bboxEnd.y - bboxStart.y, bboxEnd.z - bboxStart.z));
+				wbf.write<unsigned int>(lods[i].size());
+
+				for (unsigned int j = 0u; j < lods[i].size(); j++) {
+
+					wbf.write<float>((extent > 0.0f) ? lods[i][j].error / extent : 0.0f);
+					wbf.write<unsigned int>(lods[i][j].indices.size());
+					saveIndices(wbf, lods[i][j].indices.data(), lods[i][j].indices.size(), shortIndices);
+
+				}
+
+			}
 
 		}
 
@@ -572,6 +788,43 @@ void GL::ModelConverter::saveMeshes(WriteBinaryFile& wbf) {
 
 }
 
+void GL::ModelConverter::saveBoundingBox(WriteBinaryFile& wbf) {
+
+	for (int i = 0; i < 3; i++) wbf.write<float>(bboxStart[i]);
+	for (int i = 0; i < 3; i++) wbf.write<float>(bboxEnd[i]);
+
+}
+
+void GL::ModelConverter::saveIndices(WriteBinaryFile& wbf, const unsigned int* data, unsigned int numIndices, bool shortIndices) {
+
+	if (fileVersion >= 2u) wbf.align(_GL_ModelFile_alignment);
+
+	if (shortIndices) {
+
+		unsigned short* shortIndexData = new unsigned short[numIndices];
+		for (unsigned int j = 0u; j < numIndices; j++) shortIndexData[j] = (unsigned short)data[j];
+		wbf.writeRawData((char*)shortIndexData, numIndices * sizeof(unsigned short));
+		delete[] shortIndexData;
+
+	}
+	else wbf.writeRawData((char*)data, numIndices * sizeof(unsigned int));
+
+}
+
+void GL::ModelConverter::saveChunk(WriteBinaryFile& wbf, unsigned int tableIndex, unsigned int id, void (ModelConverter::*save)(WriteBinaryFile&)) {
+
+	wbf.align(_GL_ModelFile_alignment);
+	int offset = wbf.getFileLength();
+	(this->*save)(wbf);
+	int size = wbf.getFileLength() - offset;
+
+	int entry = _GL_ModelFile_headerSize + tableIndex * _GL_ModelFile_chunkEntrySize;
+	wbf.writeAt<unsigned int>(entry, id);
+	wbf.writeAt<unsigned int>(entry + 4, (unsigned int)offset);
+	wbf.writeAt<unsigned int>(entry + 8, (unsigned int)size);
+
+}
+
 GL::mat3 GL::ModelConverter::calcNormalMatrix(mat4 model) {
 
 	mat3 normalMatrix = inverse(mat3(model[0](0, 1, 2), model[1](0, 1, 2), model[2](0, 1, 2)));
@@ -595,4 +848,51 @@ GL::mat4 GL::ModelConverter::assimpToGL(aiMatrix4x4& m) {
 
 }
 
+GL::ModelConverter_types::i16vec2 GL::ModelConverter::encodeOctahedral(vec3 direction) {
+
+	direction /= std::abs(direction.x) + std::abs(direction.y) + std::abs(direction.z);
+
+	vec2 encoded(direction.x, direction.y);
+	if (direction.z < 0.0f) encoded = vec2(
+		(1.0f - std::abs(direction.y)) * ((direction.x >= 0.0f) ? 1.0f : -1.0f),
+		(1.0f - std::abs(direction.x)) * ((direction.y >= 0.0f) ? 1.0f : -1.0f)
+	);
+
+	return ModelConverter_types::i16vec2(
+		(short)std::round(clamp(encoded.x, -1.0f, 1.0f) * 32767.0f),
+		(short)std::round(clamp(encoded.y, -1.0f, 1.0f) * 32767.0f)
+	);
+
+}
+
+unsigned short GL::ModelConverter::toHalfFloat(float value) {
+
+	unsigned int bits;
+	memcpy(&bits, &value, sizeof(float));
+
+	unsigned int sign = (bits >> 16) & 0x8000u;
+	unsigned int mantissa = bits & 0x7fffffu;
+	int exponent = (int)((bits >> 23) & 0xffu) - 127 + 15;
+
+	if (((bits >> 23) & 0xffu) == 0xffu) return (unsigned short)(sign | 0x7c00u | (mantissa ? 0x200u : 0u));
+	if (exponent >= 31) return (unsigned short)(sign | 0x7c00u);
+
+	if (exponent <= 0) {
+
+		if (exponent < -10) return (unsigned short)sign;
+
+		mantissa |= 0x800000u;
+		unsigned int shift = (unsigned int)(14 - exponent);
+		unsigned int half = mantissa >> shift;
+		if ((mantissa >> (shift - 1u)) & 1u) half++;
+		return (unsigned short)(sign | half);
+
+	}
+
+	unsigned int half = sign | ((unsigned int)exponent << 10) | (mantissa >> 13);
+	if (mantissa & 0x1000u) half++;
+	return (unsigned short)half;
+
+}
+
 #endif
\ No newline at end of file
@@ -12,14 +12,20 @@
 #include "./../util/Exception.hpp"
 #include "./../util/BinaryFile.hpp"
 #include "./ModelConverter_types.hpp"
+#include "./ModelFile.hpp"
 #include "./VertexStructRepresentation.hpp"
+#include "./MeshOptimizer.hpp"
+
+#define _GL_ModelConverter_minLodReduction 0.9f
 
 namespace GL {
 
 	class ModelConverter {
 	public:
 
-		ModelConverter(const char* meshFile, const char* outFile);
+		ModelConverter(const char* meshFile, const char* outFile, unsigned int fileVersion = _GL_ModelFile_version, bool compactVertices = false, bool optimizeVertexCache = true, bool optimizeOverdraw = false, unsigned int numLods = 0u);
+
+		const std::vector<ModelConverter_types::MeshStatistics>& getMeshStatistics() const;
 
 		~ModelConverter();
 
@@ -31,10 +37,18 @@ namespace GL {
 		Assimp::Importer importer;
 		const aiScene* scene;
 
+		unsigned int fileVersion;
+		bool compactVertices;
+		bool optimizeVertexCache;
+		bool optimizeOverdraw;
+		unsigned int numLods;
+		std::vector<ModelConverter_types::MeshStatistics> meshStatistics;
+
 		unsigned int numMeshes = 0u;
 		ModelConverter_types::VertexArrayData* meshes_head = nullptr;
 		unsigned int** indices;
 		unsigned int* numElements;
+		std::vector<ModelConverter_types::LevelOfDetail>* lods;
 
 		unsigned int numMats;
 		ModelConverter_types::Material* mats = nullptr;
@@ -71,10 +85,20 @@ namespace GL {
 
 		void saveMeshes(WriteBinaryFile& wbf);
 
+		void saveBoundingBox(WriteBinaryFile& wbf);
+
+		void saveIndices(WriteBinaryFile& wbf, const unsigned int* data, unsigned int numIndices, bool shortIndices);
+
+		void saveChunk(WriteBinaryFile& wbf, unsigned int tableIndex, unsigned int id, void (ModelConverter::*save)(WriteBinaryFile&));
+
 		static mat3 calcNormalMatrix(mat4 model);
 
 		static mat4 assimpToGL(aiMatrix4x4& m);
 
+		static ModelConverter_types::i16vec2 encodeOctahedral(vec3 direction);
+
+		static unsigned short toHalfFloat(float value);
+
 	};
 
 }
@@ -2,12 +2,18 @@
 #define MODELCONVERTER_TYPES_HPP
 
 #include <string>
+#include <vector>
 #include "./../util/GL-math.hpp"
 
 namespace GL {
 	
 	namespace ModelConverter_types {
 
+		typedef Vector4D<unsigned short> u16vec4; 
+		typedef Vector2D<unsigned short> u16vec2; 
+		typedef Vector2D<short> i16vec2; 
+		typedef Vector4D<unsigned char> u8vec4; 
+
 			struct VertexArrayData { 
 			
 			void* data; 
@@ -16,10 +22,30 @@ namespace GL {
 			bool hasNormalMap; 
 			VertexArrayData* next; 
 			
+			vec3 positionOffset; 
+			vec3 positionScale; 
+			
 		}; 
 
 		enum class MaterialFormat { B, BMR, BN, BMRN }; 
 
+		struct MeshStatistics { 
+			
+			unsigned int numVertices; 
+			unsigned int numTriangles; 
+			float ACMRBefore, ACMRAfter; 
+			float ATVRBefore, ATVRAfter; 
+			std::vector<unsigned int> lodTriangles; 
+			
+		}; 
+
+		struct LevelOfDetail { 
+			
+			std::vector<unsigned int> indices; 
+			float error; 
+			
+		}; 
+
 		struct Material { 
 			
 			vec4 baseColor = vec4(); 
@@ -0,0 +1,44 @@
+#ifndef MODELFILE_HPP
+#define MODELFILE_HPP
+
+/*
+Version 1 .model files are the string "model" followed directly by the material, bone node and mesh sections.
+
+Version 2 .model files are laid out as follows:
+	header (32 bytes):         "SGLMODEL", uint version, uint numChunks, 16 reserved bytes
+	chunk table (16 bytes/entry): uint id, uint offset, uint size, uint reserved
+	chunk payloads:            every chunk, and every texture, vertex and index array inside a chunk, starts on a 16-byte boundary
+
+The MATS, BONE and MESH chunks hold the same data as the version 1 sections, BBOX holds the (bind pose) bounding box as six floats.
+
+Version 3 adds a uint vertex format after the material index of every mesh header. Meshes in the compact format follow it with
+six floats (the position offset and scale of the mesh) and store their vertices as:
+	position:                  3 x unorm16 relative to the mesh bounding box, padded to 8 bytes
+	normal, tangent, bitangent: octahedral encoded, 2 x snorm16 each
+	texture coordinates:       2 x half float
+	bone indices, bone weights: 4 x uint8, 4 x unorm8
+
+Version 4 adds a uint index size (2 or 4 bytes) after the vertex format, meshes with at most 65536 vertices use 16-bit indices.
+
+Version 5 follows the indices of every mesh with a uint number of simplified levels of detail, each stored as a float error
+(relative to the largest side of the model bounding box), a uint number of indices and the indices into the same vertex array.
+*/
+
+#define _GL_ModelFile_fourCC(a, b, c, d) ((unsigned int)(a) | ((unsigned int)(b) << 8) | ((unsigned int)(c) << 16) | ((unsigned int)(d) << 24))
+
+#define _GL_ModelFile_magic "SGLMODEL"
+#define _GL_ModelFile_magicLength 8u
+#define _GL_ModelFile_version 5u
+#define _GL_ModelFile_headerSize 32u
+#define _GL_ModelFile_chunkEntrySize 16u
+#define _GL_ModelFile_alignment 16u
+
+#define _GL_ModelFile_vertexFormat_float 0u
+#define _GL_ModelFile_vertexFormat_compact 1u
+
+#define _GL_ModelFile_chunk_materials _GL_ModelFile_fourCC('M', 'A', 'T', 'S')
+#define _GL_ModelFile_chunk_boneNodes _GL_ModelFile_fourCC('B', 'O', 'N', 'E')
+#define _GL_ModelFile_chunk_meshes _GL_ModelFile_fourCC('M', 'E', 'S', 'H')
+#define _GL_ModelFile_chunk_boundingBox _GL_ModelFile_fourCC('B', 'B', 'O', 'X')
+
+#endif
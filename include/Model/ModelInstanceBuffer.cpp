@@ -1,42 +1,196 @@
+#include <algorithm>
 
 #include "./ModelInstanceBuffer.hpp"
+#include "./Model_types.hpp"
 
-GL::ModelInstanceBuffer::ModelInstanceBuffer(unsigned int numInstances) : modelTable(0u), normalTable(1u) {
+unsigned int GL::ModelInstanceBuffer::lastChangeVersion = 0u;
+
+GL::ModelInstanceBuffer::ModelInstanceBuffer(unsigned int numInstances, bool derivesNormalMatrices) : modelTable(0u), normalTable(1u), visibleTable(3u), normalMatricesDerived(derivesNormalMatrices), boneModelTable(5u), boneNormalTable(6u) {
+
+	static_assert(sizeof(mat4) == 64u, "Model matrices are copied directly into std430 storage.");
 
 	len = numInstances;
 	if (len == 0u) len++;
 
 	modelTable.init("modelMatrices", UniformType::MAT4, len);
-	normalTable.init("normalMatrices", UniformType::MAT3, len);
+	normalTable.init("normalMatrices", UniformType::MAT3, (normalMatricesDerived) ? 1u : len);
+	if (normalMatricesDerived) normalTable.setElement<mat3>("normalMatrices", 0u, mat3());
+	visibleTable.init("visibleInstances", UniformType::UINT, len);
+
+	modelMatrices = (mat4*)modelTable.getElementData("modelMatrices");
+	normalMatrices = normalTable.getElementData("normalMatrices");
+	normalStride = normalTable.getElementStride("normalMatrices");
+
+	GLuint* visibleInstances = (GLuint*)visibleTable.getElementData("visibleInstances");
+	for (unsigned int i = 0u; i < len; i++) visibleInstances[i] = i;
+	visibleTable.markElementsAsChanged("visibleInstances", 0u, len);
+
+	dirtyBlocks.assign((len + _GL_ModelInstanceBuffer_blockSize - 1u) / _GL_ModelInstanceBuffer_blockSize, false);
+	changeVersion = ++lastChangeVersion;
 
 }
 
 void GL::ModelInstanceBuffer::setModelMatrix(unsigned int index, GL::mat4 model) {
 
-	mat3 normalMatrix(model);
-	normalMatrix = transpose(inverse(normalMatrix));
+	index %= len;
+	modelMatrices[index] = model;
+	markAsChanged(index, 1u);
 
-	modelTable.setElement<mat4>("modelMatrices", index % len, model);
-	normalTable.setElement<mat3>("normalMatrices", index % len, normalMatrix);
+}
+
+void GL::ModelInstanceBuffer::setModelMatrices(unsigned int first, const GL::mat4* models, unsigned int count) {
+
+	std::memcpy(getWritableModelMatrices(first, count), models, count * sizeof(mat4));
 
 }
 
-GL::mat4 GL::ModelInstanceBuffer::getModelMatrix(unsigned int index) const { return modelTable.getElement<mat4>("modelMatrices", index % len); }
+GL::mat4* GL::ModelInstanceBuffer::getWritableModelMatrices(unsigned int first, unsigned int count) {
+
+	if (first + count > len) throw Exception("Invalid instance range (" + std::to_string(first) + ", " + std::to_string(count) + ") passed to a model instance buffer of " + std::to_string(len) + " instances.");
 
-GL::mat3 GL::ModelInstanceBuffer::getNormalMatrix(unsigned int index) const { return normalTable.getElement<mat3>("normalMatrices", index % len); }
+	markAsChanged(first, count);
+	return modelMatrices + first;
+
+}
+
+GL::mat4 GL::ModelInstanceBuffer::getModelMatrix(unsigned int index) const { return modelMatrices[index % len]; }
+
+GL::mat3 GL::ModelInstanceBuffer::getNormalMatrix(unsigned int index) const {
+
+	if (normalMatricesDerived || dirtyBlocks[(index % len) / _GL_ModelInstanceBuffer_blockSize]) return transpose(inverse(mat3(getModelMatrix(index))));
+	return normalTable.getElement<mat3>("normalMatrices", index % len);
+
+}
 
 unsigned int GL::ModelInstanceBuffer::getLength() const { return len; }
 
+bool GL::ModelInstanceBuffer::derivesNormalMatrices() const { return normalMatricesDerived; }
+
+unsigned int GL::ModelInstanceBuffer::getChangeVersion() const { return changeVersion; }
+
 void GL::ModelInstanceBuffer::bind() const {
 
 	modelTable.bind();
 	normalTable.bind();
+	visibleTable.bind();
+
+	if (hasAnimations()) {
+
+		boneModelTable.bind();
+		boneNormalTable.bind();
+
+	}
 
 }
 
 void GL::ModelInstanceBuffer::update() {
-	
-	modelTable.update();
+
+	if (!dirtyBlockList.empty()) {
+
+		// Uploads only the blocks of instances changed since the last update, merging neighbouring ones.
+		std::sort(dirtyBlockList.begin(), dirtyBlockList.end());
+		dirtyRanges.clear();
+
+		for (unsigned int i = 0u; i < dirtyBlockList.size(); i++) {
+
+			unsigned int first = dirtyBlockList[i] * _GL_ModelInstanceBuffer_blockSize;
+			unsigned int count = min(first + _GL_ModelInstanceBuffer_blockSize, len) - first;
+			dirtyBlocks[dirtyBlockList[i]] = false;
+
+			if (!dirtyRanges.empty() && dirtyRanges.back().x + dirtyRanges.back().y == first) dirtyRanges.back().y += count;
+			else dirtyRanges.push_back(uvec2(first, count));
+
+		}
+
+		dirtyBlockList.clear();
+
+		if (!normalMatricesDerived) for (unsigned int i = 0u; i < dirtyRanges.size(); i++) updateNormalMatrices(dirtyRanges[i].x, dirtyRanges[i].y);
+
+		modelTable.markElementsAsChanged("modelMatrices", dirtyRanges.front().x, dirtyRanges.back().x + dirtyRanges.back().y - dirtyRanges.front().x);
+		modelTable.updateElements("modelMatrices", dirtyRanges.data(), dirtyRanges.size());
+		if (!normalMatricesDerived) normalTable.updateElements("normalMatrices", dirtyRanges.data(), dirtyRanges.size());
+
+	}
+
 	normalTable.update();
+	visibleTable.update();
+
+}
+
+void GL::ModelInstanceBuffer::useGpuCulling(bool use) { gpuCulling = use; }
+
+bool GL::ModelInstanceBuffer::usesGpuCulling() const { return gpuCulling; }
+
+void GL::ModelInstanceBuffer::setAnimation(unsigned int index, unsigned int animationIndex, float time) {
+
+	if (!hasAnimations()) {
+
+		boneModelTable.init("instanceBoneModelMatrices", UniformType::MAT4, len * _GL_Model_maxBones);
+		boneNormalTable.init("instanceBoneNormalMatrices", UniformType::MAT3, len * _GL_Model_maxBones);
+		animationIndices.assign(len, 0u);
+		animationTimes.assign(len, 0.0f);
+
+	}
+
+	index %= len;
+	animationIndices[index] = animationIndex;
+	animationTimes[index] = time;
+	posesChanged = true;
+	changeVersion = ++lastChangeVersion;
+
+}
+
+void GL::ModelInstanceBuffer::advanceAnimations(float seconds) {
+
+	for (unsigned int i = 0u; i < animationTimes.size(); i++) animationTimes[i] += seconds;
+	posesChanged = true;
+	changeVersion = ++lastChangeVersion;
+
+}
+
+unsigned int GL::ModelInstanceBuffer::getAnimationIndex(unsigned int index) const { return (hasAnimations()) ? animationIndices[index % len] : 0u; }
+
+float GL::ModelInstanceBuffer::getAnimationTime(unsigned int index) const { return (hasAnimations()) ? animationTimes[index % len] : 0.0f; }
+
+bool GL::ModelInstanceBuffer::hasAnimations() const { return !animationIndices.empty(); }
+
+void GL::ModelInstanceBuffer::markAsChanged(unsigned int first, unsigned int count) {
+
+	if (!count) return;
+
+	changeVersion = ++lastChangeVersion;
+	unsigned int lastBlock = (first + count - 1u) / _GL_ModelInstanceBuffer_blockSize;
+	for (unsigned int block = first / _GL_ModelInstanceBuffer_blockSize; block <= lastBlock; block++) if (!dirtyBlocks[block]) {
+
+		dirtyBlocks[block] = true;
+		dirtyBlockList.push_back(block);
+
+	}
+
+}
+
+void GL::ModelInstanceBuffer::updateNormalMatrices(unsigned int first, unsigned int count) {
+
+	// The inverse transpose is the cofactor matrix divided by the determinant, std430 pads every mat3 column to a vec4.
+	for (unsigned int i = first; i < first + count; i++) {
+
+		vec3 x(modelMatrices[i][0][0], modelMatrices[i][0][1], modelMatrices[i][0][2]);
+		vec3 y(modelMatrices[i][1][0], modelMatrices[i][1][1], modelMatrices[i][1][2]);
+		vec3 z(modelMatrices[i][2][0], modelMatrices[i][2][1], modelMatrices[i][2][2]);
+
+		vec3 yz = cross(y, z);
+		float determinant = dot(x, yz);
+		float scale = (determinant != 0.0f) ? 1.0f / determinant : 0.0f;
+
+		unsigned char* columns = normalMatrices + i * normalStride;
+		*(vec3*)(columns) = yz * scale;
+		*(vec3*)(columns + sizeof(vec4)) = cross(z, x) * scale;
+		*(vec3*)(columns + 2u * sizeof(vec4)) = cross(x, y) * scale;
+
+	}
+
+	normalTable.markElementsAsChanged("normalMatrices", first, count);
+
+}
 
-}
\ No newline at end of file
+GL::ModelInstanceBuffer::~ModelInstanceBuffer() { if (commandBuffer) glDeleteBuffers(1, &commandBuffer); }
\ No newline at end of file
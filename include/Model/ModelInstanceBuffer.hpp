@@ -1,32 +1,102 @@
 #ifndef MODELINSTANCEBUFFER_HPP
 #define MODELINSTANCEBUFFER_HPP
 
+#include <vector>
+
 #include "./../Uniform/ShaderStorageBufferTable.hpp"
 
+#define _GL_ModelInstanceBuffer_blockSize 16u
+
 namespace GL {
 
+	class Model;
+	class InstanceCuller;
+
 	class ModelInstanceBuffer : public _util {
 	public:
 
-		ModelInstanceBuffer(unsigned int numInstances);
+		// If derivesNormalMatrices is true, the normal matrices are computed in the vertex shader instead of being stored and uploaded.
+		ModelInstanceBuffer(unsigned int numInstances, bool derivesNormalMatrices = false);
 
 		void setModelMatrix(unsigned int index, mat4 model);
 
+		// Copies the model matrices of the instances [first, first + count).
+		void setModelMatrices(unsigned int first, const mat4* models, unsigned int count);
+
+		// Direct access to the model matrices of the instances [first, first + count), valid until the buffer is destroyed.
+		// The range is marked as changed by this call, so the matrices can then be written from any number of threads.
+		mat4* getWritableModelMatrices(unsigned int first, unsigned int count);
+
 		mat4 getModelMatrix(unsigned int index) const;
 
 		mat3 getNormalMatrix(unsigned int index) const;
 
 		unsigned int getLength() const;
 
+		bool derivesNormalMatrices() const;
+
+		// Changes whenever a model matrix or an animation of the instances changes. Versions are unique across buffers, so
+		// switching a model to another buffer changes it too.
+		unsigned int getChangeVersion() const;
+
 		void bind() const;
 
 		void update();
 
+		// Culled instances are tested against the camera frustum (and the depth of the last frame, see
+		// Scene::useInstanceOcclusionCulling) by a compute shader and only the visible ones are drawn.
+		void useGpuCulling(bool use);
+
+		bool usesGpuCulling() const;
+
+		// Gives the instance its own pose of an animated model, time is in seconds and the animation loops. After the first call
+		// every instance of the buffer gets a bone palette, which is evaluated by the model when it is drawn.
+		void setAnimation(unsigned int index, unsigned int animationIndex, float time);
+
+		void advanceAnimations(float seconds);
+
+		unsigned int getAnimationIndex(unsigned int index) const;
+
+		float getAnimationTime(unsigned int index) const;
+
+		bool hasAnimations() const;
+
+		~ModelInstanceBuffer();
+
 	protected:
 
 		unsigned int len;
 		ShaderStorageBufferTable modelTable;
 		ShaderStorageBufferTable normalTable;
+		ShaderStorageBufferTable visibleTable;
+
+		bool normalMatricesDerived;
+		mat4* modelMatrices;
+		unsigned char* normalMatrices;
+		unsigned int normalStride;
+		std::vector<bool> dirtyBlocks;
+		std::vector<unsigned int> dirtyBlockList;
+		std::vector<uvec2> dirtyRanges;
+
+		bool gpuCulling = false;
+		GLuint commandBuffer = 0u;
+		unsigned int commandCapacity = 0u;
+
+		ShaderStorageBufferTable boneModelTable;
+		ShaderStorageBufferTable boneNormalTable;
+		std::vector<unsigned int> animationIndices;
+		std::vector<float> animationTimes;
+		bool posesChanged = false;
+
+		unsigned int changeVersion;
+		static unsigned int lastChangeVersion;
+
+		void markAsChanged(unsigned int first, unsigned int count);
+
+		void updateNormalMatrices(unsigned int first, unsigned int count);
+
+		friend class Model;
+		friend class InstanceCuller;
 
 	};
 
@@ -0,0 +1,197 @@
+#include "./ModelLoader.hpp"
+
+#include <chrono>
+
+GL::ModelLoader::ModelLoader(unsigned int numThreads, double uploadBudget) : uploadBudget(uploadBudget) {
+
+	if (numThreads == 0u) numThreads = 1u;
+	for (unsigned int i = 0u; i < numThreads; i++) workers.push_back(std::thread(&ModelLoader::runWorker, this));
+
+}
+
+unsigned int GL::ModelLoader::loadAsync(const char* filePath) {
+
+	unsigned int request = loaded.size();
+
+	if (isInRegistry(filePath)) {
+
+		loaded.push_back(true);
+		return request;
+
+	}
+
+	loaded.push_back(false);
+	numPendingLoads++;
+
+	Job* job = new Job;
+	job->request = request;
+	job->filePath = filePath;
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		parseQueue.push_back(job);
+	}
+
+	workAvailable.notify_one();
+	return request;
+
+}
+
+bool GL::ModelLoader::isLoaded(unsigned int request) const {
+
+	if (request >= loaded.size()) throw Exception("Invalid model load request.");
+	return loaded[request];
+
+}
+
+unsigned int GL::ModelLoader::getNumPendingLoads() const { return numPendingLoads; }
+
+void GL::ModelLoader::setUploadBudget(double seconds) { uploadBudget = seconds; }
+
+void GL::ModelLoader::processUploads() {
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	do {
+
+		Job* job;
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (uploadQueue.empty()) return;
+			job = uploadQueue.front();
+		}
+
+		if (!job->error.empty()) {
+
+			std::string error = job->error;
+			finishJob(job, false);
+			throw Exception(error);
+
+		}
+
+		if (job->numTexturesUploaded == 0u && job->numMeshesUploaded == 0u && isInRegistry(job->filePath)) {
+
+			finishJob(job, false);
+			continue;
+
+		}
+
+		if (job->numTexturesUploaded < job->staging.textures.size()) Model::uploadTexture(job->data, job->staging.textures[job->numTexturesUploaded++]);
+		else if (job->numMeshesUploaded < job->staging.meshes.size()) Model::uploadMesh(job->data, job->staging.meshes[job->numMeshesUploaded++]);
+
+		if (job->numTexturesUploaded == job->staging.textures.size() && job->numMeshesUploaded == job->staging.meshes.size()) {
+
+			// A synchronous load of the same file may have finished while the uploads were spread over several frames, the
+			// existing entry is kept so models that already reference it stay valid.
+			unsigned int index;
+			if (Model::findModelData(job->filePath, index)) {
+
+				finishJob(job, false);
+				continue;
+
+			}
+
+			index = Model::insertModelData(job->filePath);
+			job->data.name = job->filePath;
+			Model::modelData[index] = job->data;
+			finishJob(job, true);
+
+		}
+
+	} while (std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() < uploadBudget);
+
+}
+
+GL::ModelLoader::~ModelLoader() {
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		shuttingDown = true;
+	}
+
+	workAvailable.notify_all();
+	for (unsigned int i = 0u; i < workers.size(); i++) workers[i].join();
+
+	for (unsigned int i = 0u; i < parseQueue.size(); i++) {
+
+		if (parseQueue[i]->rbf) delete parseQueue[i]->rbf;
+		delete parseQueue[i];
+
+	}
+
+	for (unsigned int i = 0u; i < uploadQueue.size(); i++) {
+
+		Model::releaseModelData(uploadQueue[i]->data);
+		if (uploadQueue[i]->rbf) delete uploadQueue[i]->rbf;
+		delete uploadQueue[i];
+
+	}
+
+}
+
+void GL::ModelLoader::runWorker() {
+
+	while (true) {
+
+		Job* job;
+
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			workAvailable.wait(lock, [this]() { return shuttingDown || !parseQueue.empty(); });
+			if (shuttingDown) return;
+
+			job = parseQueue.front();
+			parseQueue.pop_front();
+		}
+
+		try {
+
+			job->rbf = new ReadBinaryFile(job->filePath.c_str(), 1024 * 512, true);
+			ReadBinaryFile& rbf = *job->rbf;
+
+			Model_types::ModelFileInfo info = Model::verifyModelFile(rbf, job->filePath.c_str());
+			job->data.fileVersion = info.version;
+
+			Model::seekModelFileChunk(rbf, info, _GL_ModelFile_chunk_materials);
+			Model::loadMaterials(rbf, job->data, job->staging);
+			Model::seekModelFileChunk(rbf, info, _GL_ModelFile_chunk_boneNodes);
+			Model::loadBoneNodes(rbf, job->data);
+			Model::seekModelFileChunk(rbf, info, _GL_ModelFile_chunk_meshes);
+			Model::loadMeshData(rbf, job->data, job->staging);
+
+		}
+		catch (const Exception& e) { job->error = e.getMessage(); }
+		catch (...) { job->error = "Failed to load model file \"" + job->filePath + "\"."; }
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			uploadQueue.push_back(job);
+		}
+
+	}
+
+}
+
+void GL::ModelLoader::finishJob(Job* job, bool keepData) {
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		uploadQueue.pop_front();
+	}
+
+	if (!keepData) Model::releaseModelData(job->data);
+	if (job->rbf) delete job->rbf;
+
+	loaded[job->request] = keepData || job->error.empty();
+	numPendingLoads--;
+	delete job;
+
+}
+
+bool GL::ModelLoader::isInRegistry(const std::string& filePath) {
+
+	unsigned int index;
+	return Model::findModelData(filePath, index);
+
+}
@@ -0,0 +1,71 @@
+#ifndef MODELLOADER_HPP
+#define MODELLOADER_HPP
+
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+
+#include "./Model.hpp"
+
+namespace GL {
+
+	class ModelLoader : public _util {
+	public:
+
+		ModelLoader(unsigned int numThreads = 1u, double uploadBudget = 0.002);
+
+		unsigned int loadAsync(const char* filePath);
+
+		bool isLoaded(unsigned int request) const;
+
+		unsigned int getNumPendingLoads() const;
+
+		void setUploadBudget(double seconds);
+
+		// Must be called from the thread that owns the GL context, ideally once per frame.
+		// Performs queued GL uploads until the upload budget (in seconds) has been used up.
+		void processUploads();
+
+		~ModelLoader();
+
+	private:
+
+		struct Job {
+
+			unsigned int request;
+			std::string filePath;
+			ReadBinaryFile* rbf = nullptr;
+
+			Model_types::ModelData data;
+			Model_types::ModelStaging staging;
+			std::string error;
+
+			unsigned int numTexturesUploaded = 0u;
+			unsigned int numMeshesUploaded = 0u;
+
+		};
+
+		std::vector<std::thread> workers;
+		std::mutex mutex;
+		std::condition_variable workAvailable;
+		bool shuttingDown = false;
+
+		std::deque<Job*> parseQueue;
+		std::deque<Job*> uploadQueue;
+
+		std::vector<bool> loaded;
+		unsigned int numPendingLoads = 0u;
+		double uploadBudget;
+
+		void runWorker();
+
+		void finishJob(Job* job, bool keepData);
+
+		static bool isInRegistry(const std::string& filePath);
+
+	};
+
+}
+
+#endif
@@ -1,5 +1,6 @@
 
 #include "./ModelProgram.hpp"
+#include "./ShadowRenderer.hpp"
 
 GL::ModelShader::ModelShader(GL::ShaderType shaderType) : sType(shaderType) { if (!(sType == ShaderType::VERTEX || sType == ShaderType::FRAGMENT)) throw Exception("A model shader must either be a vertex or fragment shader."); }
 
@@ -164,6 +165,8 @@ void GL::ModelProgram::initializeUniforms() {
 
 #define _GL_ModelProgram_unis \
 "isInstanced", UniformType::INT, 1, \
+"_derivesNormalMatrix", UniformType::INT, 1, \
+"_hasInstancePoses", UniformType::INT, 1, \
 "_albedoSampler", UniformType::INT, 1, \
 "_normalSampler", UniformType::INT, 1, \
 "_metallicRoughnessSampler", UniformType::INT, 1, \
@@ -172,11 +175,10 @@ void GL::ModelProgram::initializeUniforms() {
 "roughness", UniformType::FLOAT, 1, \
 "_shadowSamplers", UniformType::INT, 6, \
 "_hasShadowSampler", UniformType::INT, 6, \
-"_overheadShadowSampler", UniformType::INT, 2, \
-"_overheadPVMatrix", UniformType::MAT4, 2, \
-"_overheadFarPlane", UniformType::FLOAT, 2, \
-"_bboxStart", UniformType::VEC3, 2, \
-"_bboxEnd", UniformType::VEC3, 2, \
+"_overheadShadowSampler", UniformType::INT, 1, \
+"_overheadPVMatrix", UniformType::MAT4, _GL_OverheadShadowRenderer_maxMaps, \
+"_overheadFarPlane", UniformType::FLOAT, _GL_OverheadShadowRenderer_maxMaps, \
+"_numOverheadShadowMaps", UniformType::INT, 1, \
 "overheadLightDirection", UniformType::VEC3, 1, \
 "overheadLightColor", UniformType::VEC3, 1
 
@@ -187,7 +189,8 @@ void GL::ModelProgram::initializeUniforms() {
 	unis->set("_normalSampler", NORMAL_TEXTURE_UNIT);
 	unis->set("_metallicRoughnessSampler", METALLIC_ROUGHNESS_TEXTURE_UNIT);
 	for (int j = 0; j < 6; j++) unis->setElement("_shadowSamplers", j, 8 + j);
-	for (int j = 0; j < 2; j++) unis->setElement("_overheadShadowSampler", j, 14 + j);
+	unis->set("_overheadShadowSampler", 14);
+	unis->set("_numOverheadShadowMaps", 0);
 
 }
 
@@ -247,8 +250,8 @@ const char* GL::ModelShader::macroHeaders[2 * _GL_ModelProgram_numMacroOptions]
 };
 
 const char* GL::ModelShader::vs_source = \
-"layout(location = 0) in vec3 localPosition; \
-layout(location = 1) in vec3 normal; \
+"layout(location = 0) in vec3 _encodedPosition; \
+layout(location = 1) in vec3 _encodedNormal; \
 \
 \n#ifdef USES_TEXTURES\n \
 layout(location = 2) in vec2 textureCoordinates; \
@@ -256,8 +259,8 @@ out vec2 out_textureCoordinates; \
 \n#endif\n \
 \
 \n#ifdef NORMAL_2D_TEXTURE\n \
-layout(location = 3) in vec3 tangent; \
-layout(location = 4) in vec3 bitangent; \
+layout(location = 3) in vec3 _encodedTangent; \
+layout(location = 4) in vec3 _encodedBitangent; \
 \n#endif\n \
 \
 \n#ifdef ANIMATED\n \
@@ -265,6 +268,27 @@ layout(location = 5) in ivec4 boneIndices; \
 layout(location = 6) in vec4 boneWeights; \
 \n#endif\n \
 \
+layout(location = 7) in vec4 _positionOffset; \
+layout(location = 8) in vec4 _positionScale; \
+\
+vec3 _decodeDirection(vec3 direction) { \
+	\
+	if (_positionOffset.w == 0.0f) return direction; \
+	vec3 n = vec3(direction.xy, 1.0f - abs(direction.x) - abs(direction.y)); \
+	float t = max(-n.z, 0.0f); \
+	n.xy += vec2((n.x >= 0.0f) ? -t : t, (n.y >= 0.0f) ? -t : t); \
+	return normalize(n); \
+	\
+} \
+\
+const vec3 localPosition = _positionOffset.xyz + _encodedPosition * _positionScale.xyz; \
+const vec3 normal = _decodeDirection(_encodedNormal); \
+\
+\n#ifdef NORMAL_2D_TEXTURE\n \
+const vec3 tangent = _decodeDirection(_encodedTangent); \
+const vec3 bitangent = _decodeDirection(_encodedBitangent); \
+\n#endif\n \
+\
 layout(std430, binding = 0) buffer _modelMatrixInstances { mat4 _modelMatrices[]; }; \
 layout(std430, binding = 1) buffer _normalMatrixInstances { mat3 _normalMatrices[]; }; \
 \
@@ -280,8 +304,9 @@ layout(std140, binding = 0) uniform PBR_inputs { \
 }; \
 \
 uniform int isInstanced; \
+uniform int _derivesNormalMatrix; \
 const mat4 _modelMatrix_temp = (isInstanced == 1) ? _modelMatrices[gl_InstanceID] : _modelMat; \
-const mat3 _normalMatrix_temp = (isInstanced == 1) ? _normalMatrices[gl_InstanceID] : _normalMat; \
+const mat3 _normalMatrix_temp = (isInstanced == 1) ? ((_derivesNormalMatrix == 1) ? transpose(inverse(mat3(_modelMatrix_temp))) : _normalMatrices[gl_InstanceID]) : _normalMat; \
 \
 \n#ifdef ANIMATED\n \
 layout(std140, binding = 1) uniform boneData { \
@@ -290,6 +315,10 @@ layout(std140, binding = 1) uniform boneData { \
 	mat3 _boneNormalMatrices[64]; \
 	\
 }; \
+\
+layout(std430, binding = 5) buffer _instanceBoneModelPalettes { mat4 _instanceBoneModelMatrices[]; }; \
+layout(std430, binding = 6) buffer _instanceBoneNormalPalettes { mat3 _instanceBoneNormalMatrices[]; }; \
+uniform int _hasInstancePoses; \
 \n#endif\n \
 \
 out vec3 out_position; \
@@ -305,7 +334,7 @@ mat4 _getModelMatrix() { \
 	\
 	\n#ifdef ANIMATED\n \
 	mat4 boneModelMatrix = mat4(0.0f); \
-	for (uint i = 0u; i < 4u; i++) { boneModelMatrix += _boneModelMatrices[boneIndices[i]] * boneWeights[i]; } \
+	for (uint i = 0u; i < 4u; i++) { boneModelMatrix += ((_hasInstancePoses == 1) ? _instanceBoneModelMatrices[gl_InstanceID * 64 + boneIndices[i]] : _boneModelMatrices[boneIndices[i]]) * boneWeights[i]; } \
 	mat4 finalModelMatrix = _modelMatrix_temp * boneModelMatrix; \
 	\n#else\n \
 	mat4 finalModelMatrix = _modelMatrix_temp; \
@@ -319,7 +348,7 @@ mat3 _getNormalMatrix() { \
 	\
 	\n#ifdef ANIMATED\n \
 	mat3 boneNormalMatrix = mat3(0.0f); \
-	for (uint i = 0u; i < 4u; i++) { boneNormalMatrix += _boneNormalMatrices[boneIndices[i]] * boneWeights[i]; } \
+	for (uint i = 0u; i < 4u; i++) { boneNormalMatrix += ((_hasInstancePoses == 1) ? _instanceBoneNormalMatrices[gl_InstanceID * 64 + boneIndices[i]] : _boneNormalMatrices[boneIndices[i]]) * boneWeights[i]; } \
 	mat3 finalNormalMatrix = _normalMatrix_temp * boneNormalMatrix; \
 	\n#else\n \
 	mat3 finalNormalMatrix = _normalMatrix_temp; \
@@ -408,11 +437,10 @@ layout(location = 0) out vec4 _out_color; \
 uniform samplerCube _shadowSamplers[6]; \
 uniform int _hasShadowSampler[6]; \
 \
-uniform sampler2D _overheadShadowSampler[2]; \
-uniform mat4 _overheadPVMatrix[2]; \
-uniform float _overheadFarPlane[2]; \
-uniform vec3 _bboxStart[2]; \
-uniform vec3 _bboxEnd[2]; \
+uniform sampler2DArray _overheadShadowSampler; \
+uniform mat4 _overheadPVMatrix[8]; \
+uniform float _overheadFarPlane[8]; \
+uniform int _numOverheadShadowMaps; \
 uniform vec3 overheadLightDirection; \
 uniform vec3 overheadLightColor; \
 \
@@ -426,6 +454,7 @@ const float _numOverheadSamples = 6.0f; \
 const float _overheadIncrement = 2.0f * _overheadSampleDist / (_numOverheadSamples - 1.0f); \
 const float _overheadShadowDecay = 4.0f; \
 const float _overheadCutoff = 0.6f; \
+const float _overheadBlendWidth = 0.1f; \
 const float _lightThreshold = 0.001f; \
 \
 const vec3 _offsets[_numSamples] = vec3[]( \
@@ -478,7 +507,7 @@ float _getOverheadShadowValue_atIndex(float NdotL, uint i) { \
 				\
 				vec3 shadowNDC = clamp((_overheadPVMatrix[i] * vec4(out_position, 1.0f)).xyz * 0.5f + 0.5f, 0.0f, 1.0f); \
 				float dist = _overheadFarPlane[i] * shadowNDC.z; \
-				float shadowMapDist = _overheadFarPlane[i] * texture(_overheadShadowSampler[i], shadowNDC.xy + vec2(x, y)).x + _epsilon * dist * bias; \
+				float shadowMapDist = _overheadFarPlane[i] * texture(_overheadShadowSampler, vec3(shadowNDC.xy + vec2(x, y), float(i))).x + _epsilon * dist * bias; \
 				float shadowValue = 1.0f - max(dist - shadowMapDist, 0.0f); \
 				shadowValue = clamp(shadowValue * _overheadShadowDecay, 0.0f, 1.0f); \
 				\
@@ -498,16 +527,20 @@ float getOverheadShadowValue() { \
 	\
 	float NdotL = clamp(dot(normal, -overheadLightDirection), 0.0f, 1.0f); \
 	\
-	if (_overheadFarPlane[1] == 0.0f) return _getOverheadShadowValue_atIndex(NdotL, 0u); \
-	\
-	vec3 t = (out_position - _bboxStart[0]) / (_bboxEnd[0] - _bboxStart[0]); \
-	t = 20.0f * min(t, 1.0f - t); \
-	t = 1.0f - clamp(t, 0.0f, 1.0f); \
-	float ts = max(t.x, max(t.y, t.z)); \
+	for (int i = 0; i < _numOverheadShadowMaps; i++) { \
+		\
+		vec3 NDC = (_overheadPVMatrix[i] * vec4(out_position, 1.0f)).xyz; \
+		float border = 1.0f - max(abs(NDC.x), abs(NDC.y)); \
+		bool isLast = i == _numOverheadShadowMaps - 1; \
+		if (border <= 0.0f && !isLast) continue; \
+		\
+		float shadowValue = _getOverheadShadowValue_atIndex(NdotL, uint(i)); \
+		if (border >= _overheadBlendWidth || isLast) return shadowValue; \
+		else return mix(_getOverheadShadowValue_atIndex(NdotL, uint(i + 1)), shadowValue, border / _overheadBlendWidth); \
+		\
+	} \
 	\
-	if (ts == 0.0f) return _getOverheadShadowValue_atIndex(NdotL, 0u); \
-	else if (ts == 1.0f) return _getOverheadShadowValue_atIndex(NdotL, 1u); \
-	else return mix(_getOverheadShadowValue_atIndex(NdotL, 0u), _getOverheadShadowValue_atIndex(NdotL, 1u), ts); \
+	return 1.0f; \
 	\
 } \
 \n#else\n \
@@ -8,4 +8,31 @@ GL::BoundingBox::BoundingBox(vec3 s, vec3 e) : start(min(s, e)), end(max(s, e))
 
 GL::BoundingBox GL::BoundingBox::operator + (BoundingBox bb) { return BoundingBox(min(start, bb.start), max(end, bb.end)); }
 
-GL::BoundingBox GL::BoundingBox::operator * (BoundingBox bb) { return BoundingBox(max(start, bb.start), min(end, bb.end)); }
\ No newline at end of file
+GL::BoundingBox GL::BoundingBox::operator * (BoundingBox bb) { return BoundingBox(max(start, bb.start), min(end, bb.end)); }
+
+GL::Frustum::Frustum() { for (int i = 0; i < 6; i++) planes[i] = vec4(0.0f, 0.0f, 0.0f, 1.0f); }
+
+GL::Frustum::Frustum(GL::mat4 PV) {
+
+	for (int i = 0; i < 3; i++) {
+
+		planes[2 * i] = vec4(PV[0][3] + PV[0][i], PV[1][3] + PV[1][i], PV[2][3] + PV[2][i], PV[3][3] + PV[3][i]);
+		planes[2 * i + 1] = vec4(PV[0][3] - PV[0][i], PV[1][3] - PV[1][i], PV[2][3] - PV[2][i], PV[3][3] - PV[3][i]);
+
+	}
+
+}
+
+bool GL::Frustum::intersects(GL::BoundingBox bb) const {
+
+	for (int i = 0; i < 6; i++) {
+
+		const vec4& plane = planes[i];
+		vec3 farthest((plane.x >= 0.0f) ? bb.end.x : bb.start.x, (plane.y >= 0.0f) ? bb.end.y : bb.start.y, (plane.z >= 0.0f) ? bb.end.z : bb.start.z);
+		if (plane.x * farthest.x + plane.y * farthest.y + plane.z * farthest.z + plane.w < 0.0f) return false;
+
+	}
+
+	return true;
+
+}
\ No newline at end of file
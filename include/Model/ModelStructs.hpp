@@ -19,9 +19,16 @@ namespace GL {
 		bool hasOverheadShadow = false;
 		bool overheadShadowFancy = false;
 		unsigned int overheadMapSideLength = 4096u;
+		unsigned int numOverheadCascades = 0u;
+		float overheadCascadeSplitLambda = 0.75f;
+		float overheadShadowDistance = 0.0f;
 
 		unsigned int numLights = 0u;
 		unsigned int shadowCubeMapSideLength = 2048u;
+		bool layeredPointLightShadows = false;
+
+		bool cacheShadowMaps = false;
+		bool separateStaticShadowCasters = false;
 
 	};
 
@@ -37,6 +44,17 @@ namespace GL {
 
 	};
 
+	struct Frustum {
+
+		vec4 planes[6];
+
+		Frustum();
+		Frustum(mat4 PV);
+
+		bool intersects(BoundingBox bb) const;
+
+	};
+
 }
 
 #endif
\ No newline at end of file
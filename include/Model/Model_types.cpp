@@ -38,21 +38,83 @@ GL::mat4 GL::Model_types::Animation::quaternionToMatrix(vec4 q) {
     
 }
 
+GL::vec4 GL::Model_types::Animation::matrixToQuaternion(mat4 m) { 
+    
+    float trace = m[0][0] + m[1][1] + m[2][2]; 
+    if (trace > 0.0f) { 
+        
+        float s = 0.5f / std::sqrt(trace + 1.0f); 
+        return vec4((m[1][2] - m[2][1]) * s, (m[2][0] - m[0][2]) * s, (m[0][1] - m[1][0]) * s, 0.25f / s); 
+        
+    } 
+    if (m[0][0] > m[1][1] && m[0][0] > m[2][2]) { 
+        
+        float s = 2.0f * std::sqrt(1.0f + m[0][0] - m[1][1] - m[2][2]); 
+        return vec4(0.25f * s, (m[1][0] + m[0][1]) / s, (m[2][0] + m[0][2]) / s, (m[1][2] - m[2][1]) / s); 
+        
+    } 
+    if (m[1][1] > m[2][2]) { 
+        
+        float s = 2.0f * std::sqrt(1.0f + m[1][1] - m[0][0] - m[2][2]); 
+        return vec4((m[1][0] + m[0][1]) / s, 0.25f * s, (m[2][1] + m[1][2]) / s, (m[2][0] - m[0][2]) / s); 
+        
+    } 
+    
+    float s = 2.0f * std::sqrt(1.0f + m[2][2] - m[0][0] - m[1][1]); 
+    return vec4((m[2][0] + m[0][2]) / s, (m[2][1] + m[1][2]) / s, 0.25f * s, (m[0][1] - m[1][0]) / s); 
+    
+} 
+
+GL::vec4 GL::Model_types::Animation::multiplyQuaternions(vec4 a, vec4 b) { 
+    
+    return vec4( 
+        a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y, 
+        a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x, 
+        a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w, 
+        a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z 
+    ); 
+    
+} 
+
 float GL::Model_types::Animation::normaliz(float t, float start, float end) { return (t - start) / (end - start); } 
 
 unsigned int GL::Model_types::Animation::findTimestampIndex(float t, float* timestamps, unsigned int numTimestamps) { 
     
-    unsigned int idx = 0u; 
-    for (unsigned int i = 0u; i < numTimestamps; i++) if (timestamps[i] > t) { idx = i; break; } 
-    return idx; 
+    unsigned int first = 0u, last = numTimestamps; 
+    while (first < last) { 
+        
+        unsigned int middle = first + (last - first) / 2u; 
+        if (timestamps[middle] > t) last = middle; 
+        else first = middle + 1u; 
+        
+    } 
+    
+    return (first < numTimestamps) ? first : 0u; 
     
 }
 
-GL::mat4 GL::Model_types::Animation::getMatrix(float t) { 
-			
-    unsigned int transIdx = findTimestampIndex(t, translationTimes, numTranslations); 
-    unsigned int rotIdx = findTimestampIndex(t, rotTimes, numRots); 
-    unsigned int scaleIdx = findTimestampIndex(t, scalingTimes, numScalings); 
+unsigned int GL::Model_types::Animation::findTimestampIndex(float t, float* timestamps, unsigned int numTimestamps, unsigned int& cursor) { 
+    
+    for (unsigned int idx = cursor; idx < numTimestamps && idx <= cursor + 1u; idx++) { 
+        
+        if (timestamps[idx] <= t) continue; 
+        if (idx > 0u && timestamps[idx - 1u] > t) break; 
+        
+        cursor = idx; 
+        return idx; 
+        
+    } 
+    
+    cursor = findTimestampIndex(t, timestamps, numTimestamps); 
+    return cursor; 
+    
+}
+
+void GL::Model_types::Animation::sample(float t, AnimationCursor& cursor, vec3& translation, vec4& rot, vec3& scaling) const { 
+    
+    unsigned int transIdx = findTimestampIndex(t, translationTimes, numTranslations, cursor.translation); 
+    unsigned int rotIdx = findTimestampIndex(t, rotTimes, numRots, cursor.rot); 
+    unsigned int scaleIdx = findTimestampIndex(t, scalingTimes, numScalings, cursor.scaling); 
     
     if (transIdx > 0u) transIdx--; 
     if (rotIdx > 0u) rotIdx--; 
@@ -62,10 +124,414 @@ GL::mat4 GL::Model_types::Animation::getMatrix(float t) {
     float rotT = normaliz(t, rotTimes[rotIdx], rotTimes[rotIdx + 1u]); 
     float scaleT = normaliz(t, scalingTimes[scaleIdx], scalingTimes[scaleIdx + 1u]); 
     
-    vec3 translation = mix(translations[transIdx], translations[transIdx + 1u], transT); 
-    vec4 rot = interpolateSpherical(rots[rotIdx], rots[rotIdx + 1u], rotT); 
-    vec3 scaling = mix(scalings[scaleIdx], scalings[scaleIdx + 1u], scaleT); 
+    translation = mix(translations[transIdx], translations[transIdx + 1u], transT); 
+    rot = interpolateSpherical(rots[rotIdx], rots[rotIdx + 1u], rotT); 
+    scaling = mix(scalings[scaleIdx], scalings[scaleIdx + 1u], scaleT); 
+    
+}
+
+GL::mat4 GL::Model_types::Animation::getMatrix(float t) const { 
+    
+    AnimationCursor cursor; 
+    vec3 translation, scaling; 
+    vec4 rot; 
+    sample(t, cursor, translation, rot, scaling); 
     
     return translate(translation) * quaternionToMatrix(rot) * scale(scaling); 
     
-} 
\ No newline at end of file
+} 
+
+void GL::Model_types::BoneHierarchy::init(const BoneNode* boneNodes, unsigned int numBoneNodes) { 
+    
+    clear(); 
+    if (!numBoneNodes) return; 
+    
+    nodes = new unsigned int[numBoneNodes]; 
+    parents = new unsigned int[numBoneNodes]; 
+    
+    // Depth first from the root, nodes that are not reachable from it were never updated and stay that way. 
+    std::vector<unsigned int> stack(1u, 0u); 
+    std::vector<unsigned int> stackParents(1u, numBoneNodes); 
+    while (!stack.empty() && numNodes < numBoneNodes) { 
+        
+        unsigned int node = stack.back(); 
+        unsigned int parent = stackParents.back(); 
+        stack.pop_back(); 
+        stackParents.pop_back(); 
+        
+        nodes[numNodes] = node; 
+        parents[numNodes] = parent; 
+        for (unsigned int i = boneNodes[node].numChildren; i > 0u; i--) { 
+            
+            stack.push_back(boneNodes[node].childIndices[i - 1u]); 
+            stackParents.push_back(numNodes); 
+            
+        } 
+        numNodes++; 
+        
+    } 
+    for (unsigned int i = 0u; i < numNodes; i++) if (parents[i] == numBoneNodes) parents[i] = numNodes; 
+    
+    hasUniformTrans = new bool[numNodes]; 
+    hasUniformOffset = new bool[numNodes]; 
+    for (unsigned int i = 0u; i < numNodes; i++) { 
+        
+        hasUniformTrans[i] = isUniformScale(boneNodes[nodes[i]].trans); 
+        hasUniformOffset[i] = isUniformScale(boneNodes[nodes[i]].offset); 
+        
+    } 
+    
+    animatedNodes = new unsigned int[numNodes]; 
+    channels = new float[(_GL_Model_BoneHierarchy_numChannels + 9u) * numNodes]; 
+    globalTransforms = new mat4[numNodes]; 
+    hasUniformScale = new bool[numNodes]; 
+    
+    flatIndices = new unsigned int[numBoneNodes]; 
+    subtreeEnds = new unsigned int[numNodes]; 
+    for (unsigned int i = 0u; i < numBoneNodes; i++) flatIndices[i] = numNodes; 
+    for (unsigned int i = 0u; i < numNodes; i++) { flatIndices[nodes[i]] = i; subtreeEnds[i] = i + 1u; } 
+    for (unsigned int i = numNodes; i > 0u; i--) if (parents[i - 1u] != numNodes) subtreeEnds[parents[i - 1u]] = std::max(subtreeEnds[parents[i - 1u]], subtreeEnds[i - 1u]); 
+    
+    // The bind transforms split into translation, rotation and scale, so clips can be blended with the pose of the nodes they do not animate. 
+    bindChannels = new float[_GL_Model_BoneHierarchy_numChannels * numNodes]; 
+    for (unsigned int i = 0u; i < numNodes; i++) { 
+        
+        mat4 trans = boneNodes[nodes[i]].trans; 
+        vec3 x(trans[0][0], trans[0][1], trans[0][2]); 
+        vec3 y(trans[1][0], trans[1][1], trans[1][2]); 
+        vec3 z(trans[2][0], trans[2][1], trans[2][2]); 
+        vec3 scaling(length(x), length(y), length(z)); 
+        if (dot(x, cross(y, z)) < 0.0f) scaling.x = -scaling.x; 
+        
+        mat4 rotation; 
+        for (unsigned int col = 0u; col < 3u; col++) for (unsigned int row = 0u; row < 3u; row++) rotation[col][row] = (scaling[col] != 0.0f) ? trans[col][row] / scaling[col] : 0.0f; 
+        vec4 rot = Animation::matrixToQuaternion(rotation); 
+        
+        float values[_GL_Model_BoneHierarchy_numChannels] = { trans[3][0], trans[3][1], trans[3][2], rot.x, rot.y, rot.z, rot.w, scaling.x, scaling.y, scaling.z }; 
+        for (unsigned int c = 0u; c < _GL_Model_BoneHierarchy_numChannels; c++) bindChannels[c * numNodes + i] = values[c]; 
+        
+    } 
+    
+    blendChannels = new float[(_GL_Model_BoneHierarchy_numChannels + 1u) * numNodes]; 
+    isBlended = new bool[numNodes]; 
+    
+} 
+
+void GL::Model_types::BoneHierarchy::evaluate(const BoneNode* boneNodes, unsigned int animationIndex, bool isPlaying, float t, AnimationCursor* cursors, mat4* modelMatrices, unsigned char* normalMatrices) { 
+    
+    float* tx = channels; 
+    float* ty = tx + numNodes; 
+    float* tz = ty + numNodes; 
+    float* qx = tz + numNodes; 
+    float* qy = qx + numNodes; 
+    float* qz = qy + numNodes; 
+    float* qw = qz + numNodes; 
+    float* sx = qw + numNodes; 
+    float* sy = sx + numNodes; 
+    float* sz = sy + numNodes; 
+    
+    unsigned int numAnimated = 0u; 
+    if (isPlaying) for (unsigned int i = 0u; i < numNodes; i++) { 
+        
+        const BoneNode& boneNode = boneNodes[nodes[i]]; 
+        if (!boneNode.animations || !boneNode.animations[animationIndex]) continue; 
+        
+        vec3 translation, scaling; 
+        vec4 rot; 
+        boneNode.animations[animationIndex]->sample(t, cursors[i], translation, rot, scaling); 
+        
+        animatedNodes[numAnimated] = i; 
+        tx[numAnimated] = translation.x; ty[numAnimated] = translation.y; tz[numAnimated] = translation.z; 
+        qx[numAnimated] = rot.x; qy[numAnimated] = rot.y; qz[numAnimated] = rot.z; qw[numAnimated] = rot.w; 
+        sx[numAnimated] = scaling.x; sy[numAnimated] = scaling.y; sz[numAnimated] = scaling.z; 
+        numAnimated++; 
+        
+    } 
+    
+    concatenate(boneNodes, numAnimated, modelMatrices, normalMatrices); 
+    
+} 
+
+void GL::Model_types::BoneHierarchy::evaluate(const BoneNode* boneNodes, const AnimationSample* samples, unsigned int numSamples, AnimationCursor* cursors, mat4* modelMatrices, unsigned char* normalMatrices) { 
+    
+    float* weights = blendChannels + _GL_Model_BoneHierarchy_numChannels * numNodes; 
+    for (unsigned int i = 0u; i < (_GL_Model_BoneHierarchy_numChannels + 1u) * numNodes; i++) blendChannels[i] = 0.0f; 
+    for (unsigned int i = 0u; i < numNodes; i++) isBlended[i] = false; 
+    
+    float values[_GL_Model_BoneHierarchy_numChannels]; 
+    for (unsigned int s = 0u; s < numSamples; s++) { 
+    
+        const AnimationSample& sample = samples[s]; 
+        if (sample.additive || sample.weight <= 0.0f) continue; 
+    
+        unsigned int first = (sample.maskNode != _GL_Model_noBoneMask) ? flatIndices[sample.maskNode] : 0u; 
+        unsigned int end = (first < numNodes && sample.maskNode != _GL_Model_noBoneMask) ? subtreeEnds[first] : numNodes; 
+        for (unsigned int i = first; i < end; i++) { 
+    
+            if (sampleNode(boneNodes, i, sample.animation, sample.t, cursors[s * numNodes + i], values)) isBlended[i] = true; 
+            for (unsigned int c = 0u; c < _GL_Model_BoneHierarchy_numChannels; c++) blendChannels[c * numNodes + i] += values[c] * sample.weight; 
+            weights[i] += sample.weight; 
+    
+        } 
+    
+    } 
+    
+    // Normalized weighted average, quaternions were flipped to the hemisphere of the bind rotation while sampling. 
+    for (unsigned int i = 0u; i < numNodes; i++) { 
+    
+        float fill = std::max(1.0f - weights[i], 0.0f); 
+        float factor = 1.0f / std::max(weights[i], 1.0f); 
+        for (unsigned int c = 0u; c < _GL_Model_BoneHierarchy_numChannels; c++) blendChannels[c * numNodes + i] = (blendChannels[c * numNodes + i] + bindChannels[c * numNodes + i] * fill) * factor; 
+    
+        float* q = blendChannels + 3u * numNodes + i; 
+        float length = std::sqrt(q[0] * q[0] + q[numNodes] * q[numNodes] + q[2u * numNodes] * q[2u * numNodes] + q[3u * numNodes] * q[3u * numNodes]); 
+        if (length > 0.0f) for (unsigned int c = 0u; c < 4u; c++) q[c * numNodes] /= length; 
+    
+    } 
+    
+    for (unsigned int s = 0u; s < numSamples; s++) { 
+    
+        const AnimationSample& sample = samples[s]; 
+        if (!sample.additive || sample.weight <= 0.0f) continue; 
+    
+        unsigned int first = (sample.maskNode != _GL_Model_noBoneMask) ? flatIndices[sample.maskNode] : 0u; 
+        unsigned int end = (first < numNodes && sample.maskNode != _GL_Model_noBoneMask) ? subtreeEnds[first] : numNodes; 
+        for (unsigned int i = first; i < end; i++) { 
+    
+            if (!sampleNode(boneNodes, i, sample.animation, sample.t, cursors[s * numNodes + i], values)) continue; 
+            isBlended[i] = true; 
+    
+            const float* bind = bindChannels + i; 
+            float* blend = blendChannels + i; 
+            for (unsigned int c = 0u; c < 3u; c++) blend[c * numNodes] += (values[c] - bind[c * numNodes]) * sample.weight; 
+            for (unsigned int c = 7u; c < 10u; c++) if (bind[c * numNodes] != 0.0f) blend[c * numNodes] *= 1.0f + (values[c] / bind[c * numNodes] - 1.0f) * sample.weight; 
+    
+            // The rotation relative to the bind rotation, scaled by the weight and put in front of the blended rotation. 
+            vec4 rot(values[3], values[4], values[5], values[6]); 
+            vec4 inverseBind(-bind[3u * numNodes], -bind[4u * numNodes], -bind[5u * numNodes], bind[6u * numNodes]); 
+            vec4 delta = Animation::multiplyQuaternions(rot, inverseBind); 
+            if (delta.w < 0.0f) delta = delta * -1.0f; 
+            delta = mix(vec4(0.0f, 0.0f, 0.0f, 1.0f), delta, sample.weight); 
+            delta = delta * (1.0f / std::sqrt(dot(delta, delta))); 
+    
+            vec4 result = Animation::multiplyQuaternions(delta, vec4(blend[3u * numNodes], blend[4u * numNodes], blend[5u * numNodes], blend[6u * numNodes])); 
+            blend[3u * numNodes] = result.x; 
+            blend[4u * numNodes] = result.y; 
+            blend[5u * numNodes] = result.z; 
+            blend[6u * numNodes] = result.w; 
+    
+        } 
+    
+    } 
+    
+    // Nodes no sample animates keep their exact bind transform. 
+    unsigned int numAnimated = 0u; 
+    for (unsigned int i = 0u; i < numNodes; i++) if (isBlended[i]) { 
+    
+        animatedNodes[numAnimated] = i; 
+        for (unsigned int c = 0u; c < _GL_Model_BoneHierarchy_numChannels; c++) channels[c * numNodes + numAnimated] = blendChannels[c * numNodes + i]; 
+        numAnimated++; 
+    
+    } 
+    
+    concatenate(boneNodes, numAnimated, modelMatrices, normalMatrices); 
+
+} 
+
+bool GL::Model_types::BoneHierarchy::sampleNode(const BoneNode* boneNodes, unsigned int node, unsigned int animationIndex, float t, AnimationCursor& cursor, float* values) const { 
+    
+    const BoneNode& boneNode = boneNodes[nodes[node]]; 
+    if (!boneNode.animations || !boneNode.animations[animationIndex]) { 
+    
+        for (unsigned int c = 0u; c < _GL_Model_BoneHierarchy_numChannels; c++) values[c] = bindChannels[c * numNodes + node]; 
+        return false; 
+    
+    } 
+    
+    vec3 translation, scaling; 
+    vec4 rot; 
+    boneNode.animations[animationIndex]->sample(t, cursor, translation, rot, scaling); 
+    
+    float hemisphere = 0.0f; 
+    for (unsigned int c = 0u; c < 4u; c++) hemisphere += rot[c] * bindChannels[(3u + c) * numNodes + node]; 
+    if (hemisphere < 0.0f) rot = rot * -1.0f; 
+    
+    values[0] = translation.x; values[1] = translation.y; values[2] = translation.z; 
+    values[3] = rot.x; values[4] = rot.y; values[5] = rot.z; values[6] = rot.w; 
+    values[7] = scaling.x; values[8] = scaling.y; values[9] = scaling.z; 
+    return true; 
+
+} 
+
+void GL::Model_types::BoneHierarchy::concatenate(const BoneNode* boneNodes, unsigned int numAnimated, mat4* modelMatrices, unsigned char* normalMatrices) { 
+    
+    const float* tx = channels; 
+    const float* ty = tx + numNodes; 
+    const float* tz = ty + numNodes; 
+    const float* qx = tz + numNodes; 
+    const float* qy = qx + numNodes; 
+    const float* qz = qy + numNodes; 
+    const float* qw = qz + numNodes; 
+    const float* sx = qw + numNodes; 
+    const float* sy = sx + numNodes; 
+    const float* sz = sy + numNodes; 
+    
+    // Rotation times scale, the same terms as Animation::quaternionToMatrix. 
+    float* rotationScales = channels + _GL_Model_BoneHierarchy_numChannels * numNodes; 
+    for (unsigned int i = 0u; i < numAnimated; i++) { 
+        
+        float xx = qx[i] * qx[i], yy = qy[i] * qy[i], zz = qz[i] * qz[i]; 
+        float xy = qx[i] * qy[i], xz = qx[i] * qz[i], yz = qy[i] * qz[i]; 
+        float xw = qx[i] * qw[i], yw = qy[i] * qw[i], zw = qz[i] * qw[i]; 
+        
+        rotationScales[i] = (1.0f - 2.0f * (yy + zz)) * sx[i]; 
+        rotationScales[numNodes + i] = 2.0f * (xy + zw) * sx[i]; 
+        rotationScales[2u * numNodes + i] = 2.0f * (xz - yw) * sx[i]; 
+        rotationScales[3u * numNodes + i] = 2.0f * (xy - zw) * sy[i]; 
+        rotationScales[4u * numNodes + i] = (1.0f - 2.0f * (xx + zz)) * sy[i]; 
+        rotationScales[5u * numNodes + i] = 2.0f * (yz + xw) * sy[i]; 
+        rotationScales[6u * numNodes + i] = 2.0f * (xz + yw) * sz[i]; 
+        rotationScales[7u * numNodes + i] = 2.0f * (yz - xw) * sz[i]; 
+        rotationScales[8u * numNodes + i] = (1.0f - 2.0f * (xx + yy)) * sz[i]; 
+        
+    } 
+    
+    for (unsigned int i = 0u, animated = 0u; i < numNodes; i++) { 
+        
+        const BoneNode& boneNode = boneNodes[nodes[i]]; 
+        
+        mat4 localTransform; 
+        bool isLocalUniform; 
+        if (animated < numAnimated && animatedNodes[animated] == i) { 
+            
+            for (unsigned int col = 0u; col < 3u; col++) for (unsigned int row = 0u; row < 3u; row++) localTransform[col][row] = rotationScales[(3u * col + row) * numNodes + animated]; 
+            localTransform[3][0] = tx[animated]; 
+            localTransform[3][1] = ty[animated]; 
+            localTransform[3][2] = tz[animated]; 
+            
+            float tolerance = _GL_Model_BoneHierarchy_uniformScaleTolerance * std::abs(sx[animated]); 
+            isLocalUniform = std::abs(sy[animated] - sx[animated]) <= tolerance && std::abs(sz[animated] - sx[animated]) <= tolerance; 
+            animated++; 
+            
+        } 
+        else { 
+            
+            localTransform = boneNode.trans; 
+            isLocalUniform = hasUniformTrans[i]; 
+            
+        } 
+        
+        if (parents[i] == numNodes) { 
+            
+            globalTransforms[i] = localTransform; 
+            hasUniformScale[i] = isLocalUniform; 
+            
+        } 
+        else { 
+            
+            globalTransforms[i] = multiplyAffine(globalTransforms[parents[i]], localTransform); 
+            hasUniformScale[i] = hasUniformScale[parents[i]] && isLocalUniform; 
+            
+        } 
+        
+        if (boneNode.glIndex >= _GL_Model_maxBones) continue; 
+        
+        mat4& modelMatrix = modelMatrices[boneNode.glIndex]; 
+        modelMatrix = multiplyAffine(globalTransforms[i], boneNode.offset); 
+        
+        // The inverse transpose of s * R is R / s, otherwise it is the cofactor matrix divided by the determinant. 
+        vec3 x(modelMatrix[0][0], modelMatrix[0][1], modelMatrix[0][2]); 
+        vec3 y(modelMatrix[1][0], modelMatrix[1][1], modelMatrix[1][2]); 
+        vec3 z(modelMatrix[2][0], modelMatrix[2][1], modelMatrix[2][2]); 
+        vec3 normalColumns[3]; 
+        
+        if (hasUniformScale[i] && hasUniformOffset[i]) { 
+            
+            float lengthSquared = dot(x, x); 
+            float factor = (lengthSquared != 0.0f) ? 1.0f / lengthSquared : 0.0f; 
+            normalColumns[0] = x * factor; 
+            normalColumns[1] = y * factor; 
+            normalColumns[2] = z * factor; 
+            
+        } 
+        else { 
+            
+            vec3 yz = cross(y, z); 
+            float determinant = dot(x, yz); 
+            float factor = (determinant != 0.0f) ? 1.0f / determinant : 0.0f; 
+            normalColumns[0] = yz * factor; 
+            normalColumns[1] = cross(z, x) * factor; 
+            normalColumns[2] = cross(x, y) * factor; 
+            
+        } 
+        
+        unsigned char* columns = normalMatrices + boneNode.glIndex * _GL_Model_boneNormalStride; 
+        for (unsigned int col = 0u; col < 3u; col++) *(vec3*)(columns + col * sizeof(vec4)) = normalColumns[col]; 
+        
+    } 
+    
+} 
+
+void GL::Model_types::BoneHierarchy::clear() { 
+    
+    if (nodes) delete[] nodes; 
+    if (parents) delete[] parents; 
+    if (hasUniformTrans) delete[] hasUniformTrans; 
+    if (hasUniformOffset) delete[] hasUniformOffset; 
+    if (animatedNodes) delete[] animatedNodes; 
+    if (channels) delete[] channels; 
+    if (globalTransforms) delete[] globalTransforms; 
+    if (hasUniformScale) delete[] hasUniformScale; 
+    if (flatIndices) delete[] flatIndices; 
+    if (subtreeEnds) delete[] subtreeEnds; 
+    if (bindChannels) delete[] bindChannels; 
+    if (blendChannels) delete[] blendChannels; 
+    if (isBlended) delete[] isBlended; 
+    
+    *this = BoneHierarchy(); 
+    
+} 
+
+GL::mat4 GL::Model_types::BoneHierarchy::multiplyAffine(mat4 a, mat4 b) { 
+    
+    mat4 ret; 
+    for (unsigned int col = 0u; col < 4u; col++) for (unsigned int row = 0u; row < 3u; row++) 
+        ret[col][row] = a[0][row] * b[col][0] + a[1][row] * b[col][1] + a[2][row] * b[col][2] + ((col == 3u) ? a[3][row] : 0.0f); 
+    
+    return ret; 
+    
+} 
+
+bool GL::Model_types::BoneHierarchy::isUniformScale(mat4 m) { 
+    
+    vec3 x(m[0][0], m[0][1], m[0][2]); 
+    vec3 y(m[1][0], m[1][1], m[1][2]); 
+    vec3 z(m[2][0], m[2][1], m[2][2]); 
+    
+    float lengthSquared = dot(x, x); 
+    float tolerance = _GL_Model_BoneHierarchy_uniformScaleTolerance * lengthSquared; 
+    return ( 
+        std::abs(dot(y, y) - lengthSquared) <= tolerance && std::abs(dot(z, z) - lengthSquared) <= tolerance && 
+        std::abs(dot(x, y)) <= tolerance && std::abs(dot(x, z)) <= tolerance && std::abs(dot(y, z)) <= tolerance 
+    ); 
+    
+} 
+
+GL::vec3 GL::Model_types::VertexQuantization::decodePosition(const char* vertex) const { 
+    
+    if (!compact) return *((const vec3*)vertex); 
+    
+    const unsigned short* quantized = (const unsigned short*)vertex; 
+    return vec3( 
+        positionOffset.x + positionScale.x * ((float)quantized[0] / 65535.0f), 
+        positionOffset.y + positionScale.y * ((float)quantized[1] / 65535.0f), 
+        positionOffset.z + positionScale.z * ((float)quantized[2] / 65535.0f) 
+    ); 
+    
+} 
+
+GL::Model_types::ModelStaging::~ModelStaging() { 
+    
+    for (unsigned int i = 0u; i < meshes.size(); i++) if (meshes[i].ownedIndices) delete[] meshes[i].ownedIndices; 
+    
+}
\ No newline at end of file
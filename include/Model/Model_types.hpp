@@ -1,10 +1,21 @@
 #ifndef MODEL_TYPES_HPP
 #define MODEL_TYPES_HPP
 
+#include <string>
+#include <vector>
+
 #include "./../util/GL-math.hpp"
 #include "./../util/util.hpp"
+#include "./../Uniform/UniformHandle.hpp"
 #include "./ModelStructs.hpp"
 
+#define _GL_Model_maxBones 64u
+#define _GL_Model_boneNormalStride (3u * sizeof(GL::vec4))
+#define _GL_Model_noBoneMask 0xFFFFFFFFu
+
+#define _GL_Model_BoneHierarchy_numChannels 10u
+#define _GL_Model_BoneHierarchy_uniformScaleTolerance 1e-4f
+
 #define _GL_Model_numOptions_metallic 3
 #define _GL_Model_numOptions_roughness 3
 #define _GL_Model_numOptions_metallicRoughness (_GL_Model_numOptions_metallic * _GL_Model_numOptions_roughness + 1)
@@ -35,6 +46,13 @@
 #define _GL_Model_fragShaderVarCodeArrayLength (_GL_Model_indexOffset_usesTextures + 2)
 
 #define _GL_Model_defaultStretch 1.0f
+#define _GL_Model_defaultLodTolerance 0.002f
+
+#define _GL_Model_noMeshPool 0xFFFFFFFFu
+#define _GL_Model_meshPoolVertexBytes (32u << 20)
+#define _GL_Model_meshPoolIndexBytes (8u << 20)
+#define _GL_Model_maxIndirectDraws 65536u
+#define _GL_Model_animationStreamingRegionSize 64u
 
 
 namespace GL {
@@ -72,6 +90,16 @@ namespace GL {
 			
 		}; 
 		
+		// Key indices found by the last sample of a channel, playback usually finds the next key at or right after them. The 
+		// animations are shared by every model loaded from a file, so each model keeps its own cursors. 
+		struct AnimationCursor { 
+			
+			unsigned int scaling = 0u; 
+			unsigned int rot = 0u; 
+			unsigned int translation = 0u; 
+			
+		}; 
+		
 		struct Animation { 
 			
 			vec3* scalings; 
@@ -91,11 +119,21 @@ namespace GL {
 			/* Code for this function copied from Assimp library */ 
 			static mat4 quaternionToMatrix(vec4 q); 
 			
+			static vec4 matrixToQuaternion(mat4 m); 
+			
+			static vec4 multiplyQuaternions(vec4 a, vec4 b); 
+			
 			static float normaliz(float t, float start, float end);
 			
+			// Returns the index of the first timestamp after t (0 if there is none), using binary search. 
 			static unsigned int findTimestampIndex(float t, float* timestamps, unsigned int numTimestamps);
 			
-			mat4 getMatrix(float t);
+			// Same as above, but checks the cursor and the key after it first and falls back to binary search on seeks and loops. 
+			static unsigned int findTimestampIndex(float t, float* timestamps, unsigned int numTimestamps, unsigned int& cursor);
+			
+			void sample(float t, AnimationCursor& cursor, vec3& translation, vec4& rot, vec3& scaling) const; 
+			
+			mat4 getMatrix(float t) const;
 			
 		}; 
 		
@@ -109,15 +147,165 @@ namespace GL {
 			mat4 trans; 
 			mat4 offset; 
 			
-			mat4 modelMatrix; 
-			mat3 normalMatrix; 
+		}; 
+		
+		// A clip of the animation mixer (see Model::addAnimationLayer), times are in seconds and the clips loop. While the layer fades
+		// to a new clip, the previous one keeps playing from fadeTime. 
+		struct AnimationLayer { 
+			
+			unsigned int animation = 0u; 
+			float time = 0.0f; 
+			float weight = 1.0f; 
+			bool additive = false; 
+			unsigned int maskNode = _GL_Model_noBoneMask; 
+			
+			unsigned int fadeAnimation = 0u; 
+			float fadeTime = 0.0f; 
+			float fadeDuration = 0.0f; 
+			float fadeElapsed = 0.0f; 
+			
+		}; 
+		
+		// One clip the bone hierarchy blends, t is in ticks. 
+		struct AnimationSample { 
+			
+			unsigned int animation; 
+			float t; 
+			float weight; 
+			bool additive; 
+			unsigned int maskNode; 
+			
+		}; 
+		
+		// The bone tree flattened so that every parent comes before its children, which lets the model matrices be 
+		// concatenated in one loop. The animated channels of a frame are kept in one array per component, so building 
+		// the local transforms is a plain loop over floats that the compiler can vectorize. These arrays are scratch space 
+		// of the hierarchy, which every model of a file shares, so evaluating a pose is not reentrant. 
+		struct BoneHierarchy { 
+			
+			unsigned int numNodes = 0u; 
+			unsigned int* nodes = nullptr; 
+			unsigned int* parents = nullptr; 
+			bool* hasUniformTrans = nullptr; 
+			bool* hasUniformOffset = nullptr; 
+			
+			unsigned int* animatedNodes = nullptr; 
+			float* channels = nullptr; 
+			mat4* globalTransforms = nullptr; 
+			bool* hasUniformScale = nullptr; 
+			
+			// Bone node index to position in nodes, and the end of the subtree starting at each position (used for masks). 
+			unsigned int* flatIndices = nullptr; 
+			unsigned int* subtreeEnds = nullptr; 
+			float* bindChannels = nullptr; 
+			float* blendChannels = nullptr; 
+			bool* isBlended = nullptr; 
+			
+			void init(const BoneNode* boneNodes, unsigned int numBoneNodes); 
+			
+			// Writes the model and normal matrices of the bones into a palette indexed by their glIndex, the nodes keep their bind 
+			// transform if nothing is playing. The normal matrices are stored as three padded columns, like a std140/std430 mat3 array. 
+			// The cursors hold one entry per node. 
+			void evaluate(const BoneNode* boneNodes, unsigned int animationIndex, bool isPlaying, float t, AnimationCursor* cursors, mat4* modelMatrices, unsigned char* normalMatrices); 
+			
+			// Blends the samples in the local translation, rotation and scale of the nodes, so the hierarchy is still concatenated once. 
+			// Override samples are averaged by weight and the bind pose fills up a total weight below 1, additive samples are then 
+			// applied as their difference to the bind pose. A sample with a mask node only affects the subtree of that node. 
+			// The cursors hold one entry per node for every sample. 
+			void evaluate(const BoneNode* boneNodes, const AnimationSample* samples, unsigned int numSamples, AnimationCursor* cursors, mat4* modelMatrices, unsigned char* normalMatrices); 
+			
+			// Builds the palettes from the first numAnimated entries of the channels and the bind transforms of the other nodes. 
+			void concatenate(const BoneNode* boneNodes, unsigned int numAnimated, mat4* modelMatrices, unsigned char* normalMatrices); 
+			
+			// Writes the channels of the node in the clip, or of its bind pose if the clip does not animate it. 
+			bool sampleNode(const BoneNode* boneNodes, unsigned int node, unsigned int animationIndex, float t, AnimationCursor& cursor, float* values) const; 
+			
+			void clear(); 
+			
+			static mat4 multiplyAffine(mat4 a, mat4 b); 
+			
+			static bool isUniformScale(mat4 m); 
+			
+		}; 
+
+		struct VertexLayout { 
+			
+			unsigned int vertexSize = 0u; 
+			unsigned int numVertices = 0u; 
+			size_t baseOffset = 0u; 
+			bool hasTextures = false; 
+			bool hasNormalMap = false; 
+			
+		}; 
+
+		struct VertexQuantization { 
+			
+			bool compact = false; 
+			vec3 positionOffset = vec3(0.0f); 
+			vec3 positionScale = vec3(1.0f); 
+			
+			vec3 decodePosition(const char* vertex) const; 
+			
+		}; 
+
+		struct LevelOfDetail { 
+			
+			unsigned int firstIndex; 
+			unsigned int numElements; 
+			float error; 
+			
+		}; 
+
+		struct MeshPool { 
+			
+			GLuint vao = 0u; 
+			GLuint vbo = 0u; 
+			GLuint ebo = 0u; 
+			
+			unsigned int vertexSize; 
+			GLenum indexType; 
+			bool compact; 
+			bool hasTextures; 
+			bool hasNormalMap; 
+			bool isAnimated; 
+			
+			unsigned int vertexCapacity, vertexBytesUsed; 
+			unsigned int indexCapacity, indexBytesUsed; 
+			unsigned int numMeshes = 0u; 
+			
+		}; 
+
+		struct ProgramHandles { 
+			
+			UniformHandle<vec4> inColor; 
+			UniformHandle<float> metallic, roughness, ao, shadowOcclusion; 
+			UniformHandle<float> albedoStretch, metallicStretch, roughnessStretch, normalStretch; 
+			UniformHandle<int> isInstanced, derivesNormalMatrix, hasInstancePoses; 
+			
+			UniformHandle<vec3> bgColor; 
+			UniformHandle<float> bgBrightness; 
+			UniformHandle<int> hasShadowSampler, numOverheadShadowMaps; 
+			UniformHandle<mat4> overheadPVMatrix; 
+			UniformHandle<float> overheadFarPlane; 
+			UniformHandle<vec3> overheadLightDirection, overheadLightColor; 
+			
+		}; 
+
+		struct CommonUniformHandles { 
+			
+			UniformHandle<mat4> modelMat, trans; 
+			UniformHandle<mat3> normalMat; 
+			UniformHandle<vec3> lightPositions, lightColors, camPos; 
+			UniformHandle<mat4> boneModelMatrices; 
+			UniformHandle<mat3> boneNormalMatrices; 
 			
 		}; 
 
 		struct ModelData { 
 			
-			const char* name; 
+			std::string name; 
 			unsigned int referenceCount = 0u; 
+			unsigned int fileVersion = 1u; 
 			
 			BoundingBox bbox; 
 			
@@ -134,9 +322,16 @@ namespace GL {
 			unsigned int* matIndices; 
 			
 			unsigned int* numElements; 
+			GLenum* indexTypes; 
+			VertexQuantization* quantization; 
+			VertexLayout* vertexLayouts; 
+			std::vector<LevelOfDetail>* lods; 
+			unsigned int* meshPools; 
+			int* baseVertices; 
 			
 			BoneNode* boneNodes = nullptr; 
 			unsigned int numBoneNodes = 0u; 
+			BoneHierarchy boneHierarchy; 
 			unsigned int numBones = 0u; 
 			unsigned int numAnimations = 0u; 
 			
@@ -144,6 +339,59 @@ namespace GL {
 			
 		};
 
+		struct ModelFileChunk { 
+			
+			unsigned int id; 
+			unsigned int offset; 
+			unsigned int size; 
+			
+		}; 
+
+		struct ModelFileInfo { 
+			
+			unsigned int version; 
+			std::vector<ModelFileChunk> chunks; 
+			
+		}; 
+
+		struct TextureStaging { 
+			
+			unsigned int material; 
+			unsigned int unit; 
+			int sourceMaterial; 
+			
+			const char* data; 
+			unsigned int w, h; 
+			GLint internalFormat; 
+			GLenum format; 
+			
+		}; 
+
+		struct MeshStaging { 
+			
+			unsigned int meshIndex; 
+			
+			const char* vertexData; 
+			const char* indexData; 
+			char* ownedIndices; 
+			
+			unsigned int dataSize; 
+			unsigned int vertexSize; 
+			bool hasNormalMap; 
+			unsigned int indexSize; 
+			unsigned int numIndices; 
+			
+		}; 
+
+		struct ModelStaging { 
+			
+			std::vector<TextureStaging> textures; 
+			std::vector<MeshStaging> meshes; 
+			
+			~ModelStaging(); 
+			
+		};
+
 	}
 
 }
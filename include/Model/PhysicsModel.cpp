@@ -4,6 +4,8 @@
 #ifndef SmartGL_NO_PHYSICS
 
 std::vector<GL::PhysicsModel::PhysicsModelData> GL::PhysicsModel::physicsModelData;
+std::unordered_map<std::string, std::vector<unsigned int>> GL::PhysicsModel::physicsModelDataIndices;
+std::vector<unsigned int> GL::PhysicsModel::freePhysicsModelDataIndices;
 
 GL::PhysicsObject& GL::PhysicsModel::getPhysicsObject() const { return *po; }
 
@@ -18,17 +20,26 @@ GL::PhysicsModel::~PhysicsModel() {
 		
 		delete physicsModelData[thisPhysicsModelDataIndex].shape;
 
-		if (!physicsModelData[thisPhysicsModelDataIndex].bulletVertices) return;
+		if (physicsModelData[thisPhysicsModelDataIndex].bulletVertices) {
 			
-		for (unsigned int i = 0u; i < modelData[thisModelDataIndex].numMeshes; i++) {
+			for (unsigned int i = 0u; i < physicsModelData[thisPhysicsModelDataIndex].numBulletMeshes; i++) {
 					
-			delete[] physicsModelData[thisPhysicsModelDataIndex].bulletVertices[i];
-			delete[](unsigned int*)physicsModelData[thisPhysicsModelDataIndex].bulletIndices[i];
+				delete[] physicsModelData[thisPhysicsModelDataIndex].bulletVertices[i];
+				delete[] physicsModelData[thisPhysicsModelDataIndex].bulletIndices[i];
 					
-		} 
+			} 
 				
-		delete[] physicsModelData[thisPhysicsModelDataIndex].bulletVertices;
-		delete[] physicsModelData[thisPhysicsModelDataIndex].bulletIndices;
+			delete[] physicsModelData[thisPhysicsModelDataIndex].bulletVertices;
+			delete[] physicsModelData[thisPhysicsModelDataIndex].bulletIndices;
+
+		}
+
+		std::vector<unsigned int>& indices = physicsModelDataIndices[physicsModelData[thisPhysicsModelDataIndex].name];
+		for (unsigned int i = 0u; i < indices.size(); i++) if (indices[i] == thisPhysicsModelDataIndex) { indices.erase(indices.begin() + i); break; }
+		if (indices.empty()) physicsModelDataIndices.erase(physicsModelData[thisPhysicsModelDataIndex].name);
+
+		physicsModelData[thisPhysicsModelDataIndex] = PhysicsModelData{ };
+		freePhysicsModelDataIndices.push_back(thisPhysicsModelDataIndex);
 
 	}
 
@@ -36,28 +47,42 @@ GL::PhysicsModel::~PhysicsModel() {
 
 GL::PhysicsModel::PhysicsModel(const char* name, int type, btScalar scale) {
 	
-	thisPhysicsModelDataIndex = physicsModelData.size();
 	shouldConstructNewShape = true;
 
-	for (unsigned int i = 0u; i < physicsModelData.size(); i++)
+	std::unordered_map<std::string, std::vector<unsigned int>>::iterator it = physicsModelDataIndices.find(name);
+	if (it != physicsModelDataIndices.end()) for (unsigned int i = 0u; i < it->second.size(); i++) {
 
-		if (strcmp(name, physicsModelData[i].name) == 0) {
-			
-			if (type != physicsModelData[i].type) throw Exception("The engine does not allow loading two different physics models with the same source file ('" + std::string(name) + "') but different shapes.");
-			if (scale != physicsModelData[i].scale) continue;
+		unsigned int idx = it->second[i];
 
-			thisPhysicsModelDataIndex = i;
-			shouldConstructNewShape = false;
-			break;
+		if (type != physicsModelData[idx].type) throw Exception("The engine does not allow loading two different physics models with the same source file ('" + std::string(name) + "') but different shapes.");
+		if (scale != physicsModelData[idx].scale) continue;
 
-		}
+		thisPhysicsModelDataIndex = idx;
+		shouldConstructNewShape = false;
+		break;
+
+	}
 
 	if (shouldConstructNewShape) {
 
-		physicsModelData.push_back(PhysicsModelData{ });
+		if (freePhysicsModelDataIndices.size()) {
+
+			thisPhysicsModelDataIndex = freePhysicsModelDataIndices.back();
+			freePhysicsModelDataIndices.pop_back();
+
+		}
+		else {
+
+			thisPhysicsModelDataIndex = physicsModelData.size();
+			physicsModelData.push_back(PhysicsModelData{ });
+
+		}
+
 		physicsModelData[thisPhysicsModelDataIndex].name = name;
+		physicsModelData[thisPhysicsModelDataIndex].referenceCount = 0u;
 		physicsModelData[thisPhysicsModelDataIndex].type = type;
 		physicsModelData[thisPhysicsModelDataIndex].scale = scale;
+		physicsModelDataIndices[name].push_back(thisPhysicsModelDataIndex);
 
 	}
 
@@ -79,10 +104,10 @@ GL::shapeType ## PhysicsModel::shapeType ## PhysicsModel(const char* filePath, c
 	\
 } \
 \
-void GL::shapeType ## PhysicsModel::loadMeshes(ReadBinaryFile& rbf) { \
+void GL::shapeType ## PhysicsModel::loadMeshes(ReadBinaryFile& rbf, GL::Model_types::ModelData& data, GL::Model_types::ModelStaging& staging) { \
 	\
 	if (shouldConstructNewShape) { _GL_Model_loadMeshes(physicsCode0, physicsCode1, physicsCode2); } \
-	else { _GL_Model_loadMeshes(,,); } \
+	else loadMeshData(rbf, data, staging); \
 	\
 }
 
@@ -110,7 +135,7 @@ btConvexHullShape* btConvexHull = new btConvexHullShape();
 unsigned int numVertices = dataSize / vertexSize; \
 for (unsigned int j = 0u; j < numVertices; j++) { \
 	\
-	vec3 vertex = *((vec3*)(vertexData + vertexSize * j)); \
+	vec3 vertex = data.quantization[i].decodePosition(vertexData + vertexSize * j); \
 	btVector3 point = toBulletVector(vertex) * physicsModelData[thisPhysicsModelDataIndex].scale; \
 	btConvexHull->addPoint(point); \
 	\
@@ -125,24 +150,26 @@ _MakePhysicsModelClassImplementation(ConvexHull, 2, (btScalar)0.0, _GL_PhysicsMo
 #define _GL_PhysicsModel_makeMeshShape_0() \
 bbox.start *= (float)physicsModelData[thisPhysicsModelDataIndex].scale; bbox.end *= (float)physicsModelData[thisPhysicsModelDataIndex].scale; \
 btTriangleIndexVertexArray* bulletMesh = new btTriangleIndexVertexArray(); \
-physicsModelData[thisPhysicsModelDataIndex].bulletVertices = new btVec3*[modelData[thisModelDataIndex].numMeshes]; \
-physicsModelData[thisPhysicsModelDataIndex].bulletIndices = new int*[modelData[thisModelDataIndex].numMeshes];
+physicsModelData[thisPhysicsModelDataIndex].bulletVertices = new btVec3*[data.numMeshes](); \
+physicsModelData[thisPhysicsModelDataIndex].bulletIndices = new int*[data.numMeshes](); \
+physicsModelData[thisPhysicsModelDataIndex].numBulletMeshes = data.numMeshes;
 
 #define _GL_PhysicsModel_makeMeshShape_1() \
 unsigned int numVertices = dataSize / vertexSize; \
 physicsModelData[thisPhysicsModelDataIndex].bulletVertices[i] = new btVec3[numVertices]; \
-physicsModelData[thisPhysicsModelDataIndex].bulletIndices[i] = (int*)indexData; \
-deleteIndices = false; \
+physicsModelData[thisPhysicsModelDataIndex].bulletIndices[i] = new int[data.numElements[i]]; \
+for (unsigned int j = 0u; j < data.numElements[i]; j++) \
+	physicsModelData[thisPhysicsModelDataIndex].bulletIndices[i][j] = (indexSize == sizeof(unsigned short)) ? (int)((const unsigned short*)indexData)[j] : (int)((const unsigned int*)indexData)[j]; \
 \
 for (unsigned int j = 0u; j < numVertices; j++) { \
 	\
-	vec3 vertex = *((vec3*)(vertexData + vertexSize * j)); \
+	vec3 vertex = data.quantization[i].decodePosition(vertexData + vertexSize * j); \
 	physicsModelData[thisPhysicsModelDataIndex].bulletVertices[i][j] = btVec3(vertex) * physicsModelData[thisPhysicsModelDataIndex].scale; \
 	\
 } \
 \
 btIndexedMesh bulletMeshEntry; \
-bulletMeshEntry.m_numTriangles = modelData[thisModelDataIndex].numElements[i] / 3u; \
+bulletMeshEntry.m_numTriangles = data.numElements[i] / 3u; \
 bulletMeshEntry.m_numVertices = numVertices; \
 bulletMeshEntry.m_triangleIndexStride = 3u * sizeof(unsigned int); \
 bulletMeshEntry.m_vertexStride = sizeof(btVec3); \
@@ -35,6 +35,8 @@ namespace GL {
 		bool shouldConstructNewShape;
 
 		static std::vector<PhysicsModelData> physicsModelData;
+		static std::unordered_map<std::string, std::vector<unsigned int>> physicsModelDataIndices;
+		static std::vector<unsigned int> freePhysicsModelDataIndices;
 
 	};
 
@@ -46,7 +48,7 @@ public: \
 	\
 private: \
 	\
-	void loadMeshes(ReadBinaryFile& rbf); \
+	void loadMeshes(ReadBinaryFile& rbf, Model_types::ModelData& data, Model_types::ModelStaging& staging); \
 	\
 	btScalar mass; \
 	bool isKinematic; \
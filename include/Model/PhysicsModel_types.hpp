@@ -4,13 +4,14 @@
 #define _GL_PhysicsModel_declareHelperTypes() \
 struct PhysicsModelData { \
 	\
-	const char* name; \
+	std::string name; \
 	unsigned int referenceCount = 0u; \
 	\
-	PhysicsShape* shape; \
+	PhysicsShape* shape = nullptr; \
 	\
 	btVec3** bulletVertices = nullptr; \
 	int** bulletIndices = nullptr; \
+	unsigned int numBulletMeshes = 0u; \
 	\
 	int type; \
 	btScalar scale; \
@@ -0,0 +1,260 @@
+#include "./RenderQueue.hpp"
+#include "./Model.hpp"
+
+void GL::RenderQueue::clear() { items.clear(); }
+
+void GL::RenderQueue::push(const GL::RenderQueue_types::Item& item) { items.push_back(item); }
+
+void GL::RenderQueue::submit(GL::Scene& scene) {
+
+	stats = RenderQueue_types::Statistics{ };
+	stats.numItems = items.size();
+	if (items.empty()) return;
+
+	sort();
+	prepareIndirectDraws();
+
+	currentProgram = 0u;
+	for (unsigned int i = 0u; i < 3u; i++) currentTextures[i] = 0u;
+	currentVertexArray = 0u;
+	currentModel = nullptr;
+	preparedPrograms.assign(_GL_Model_numPrograms, false);
+	hasMeshUniforms.assign(_GL_Model_numPrograms, false);
+	meshUniforms.resize(_GL_Model_numPrograms);
+
+	Model::beginQueuedDraws(scene);
+
+	for (unsigned int i = 0u, firstCommand = 0u; i < order.size();) {
+
+		const RenderQueue_types::Item& item = items[order[i]];
+
+		if (!item.isIndirect) {
+
+			item.model->drawQueued(item, *this, scene);
+			i++;
+			continue;
+
+		}
+
+		unsigned int count = 1u;
+		while (i + count < order.size() && isSameIndirectBatch(item, items[order[i + count]])) count++;
+
+		Model::drawIndirect(item, firstCommand, count, *this, scene);
+		stats.numIndirectDraws++;
+		stats.numIndirectMeshes += count;
+
+		firstCommand += count;
+		i += count;
+
+	}
+
+}
+
+void GL::RenderQueue::useIndirectDraws(bool use) { indirectDraws = use; }
+
+bool GL::RenderQueue::usesIndirectDraws() const { return indirectDraws; }
+
+unsigned int GL::RenderQueue::getNumItems() const { return items.size(); }
+
+GL::RenderQueue_types::Statistics GL::RenderQueue::getStatistics() const { return stats; }
+
+bool GL::RenderQueue::useProgram(GLuint ID) {
+
+	if (ID == currentProgram) {
+
+		stats.numAvoidedProgramChanges++;
+		return false;
+
+	}
+
+	glUseProgram(ID);
+	currentProgram = ID;
+	stats.numProgramChanges++;
+	return true;
+
+}
+
+void GL::RenderQueue::invalidateProgram() { currentProgram = 0u; }
+
+void GL::RenderQueue::bindTexture(unsigned int unit, GLuint ID) {
+
+	if (!ID) return;
+
+	if (ID == currentTextures[unit]) {
+
+		stats.numAvoidedTextureBinds++;
+		return;
+
+	}
+
+	glActiveTexture(GL_TEXTURE0 + unit);
+	glBindTexture(GL_TEXTURE_2D, ID);
+	currentTextures[unit] = ID;
+	stats.numTextureBinds++;
+
+}
+
+bool GL::RenderQueue::bindVertexArray(GLuint ID) {
+
+	if (ID == currentVertexArray) {
+
+		stats.numAvoidedVertexArrayBinds++;
+		return false;
+
+	}
+
+	glBindVertexArray(ID);
+	currentVertexArray = ID;
+	stats.numVertexArrayBinds++;
+	return true;
+
+}
+
+bool GL::RenderQueue::useModel(const GL::Model* model) {
+
+	if (model == currentModel) {
+
+		stats.numAvoidedModelUpdates++;
+		return false;
+
+	}
+
+	currentModel = model;
+	stats.numModelUpdates++;
+	return true;
+
+}
+
+bool GL::RenderQueue::prepareProgram(unsigned int program) {
+
+	if (preparedPrograms[program]) return false;
+
+	preparedPrograms[program] = true;
+	return true;
+
+}
+
+bool GL::RenderQueue::setMeshUniforms(unsigned int program, const GL::RenderQueue_types::MeshUniforms& uniforms) {
+
+	if (hasMeshUniforms[program] && isSameUniforms(meshUniforms[program], uniforms)) {
+
+		stats.numAvoidedUniformUpdates++;
+		return false;
+
+	}
+
+	hasMeshUniforms[program] = true;
+	meshUniforms[program] = uniforms;
+	stats.numUniformUpdates++;
+	return true;
+
+}
+
+void GL::RenderQueue::sort() {
+
+	unsigned int n = items.size();
+	keys.resize(n);
+	order.resize(n);
+	scratchKeys.resize(n);
+	scratchOrder.resize(n);
+
+	textureSets.clear();
+	maxDepth = 0.0f;
+	for (unsigned int i = 0u; i < n; i++) maxDepth = max(maxDepth, items[i].depth);
+
+	for (unsigned int i = 0u; i < n; i++) {
+
+		const RenderQueue_types::Item& item = items[i];
+
+		unsigned long long textureKey = (unsigned long long)item.textures[0] | ((unsigned long long)item.textures[1] << 21) | ((unsigned long long)item.textures[2] << 42);
+		unsigned long long textureSet = textureSets.emplace(textureKey, (unsigned int)textureSets.size()).first->second;
+		unsigned long long depth = (maxDepth > 0.0f) ? (unsigned long long)(clamp(item.depth / maxDepth, 0.0f, 1.0f) * (float)((1u << _GL_RenderQueue_depthBits) - 1u)) : 0ull;
+
+		unsigned long long key = item.program & ((1ull << _GL_RenderQueue_programBits) - 1ull);
+		key = (key << _GL_RenderQueue_textureSetBits) | (textureSet & ((1ull << _GL_RenderQueue_textureSetBits) - 1ull));
+		key = (key << _GL_RenderQueue_vertexArrayBits) | (item.vao & ((1ull << _GL_RenderQueue_vertexArrayBits) - 1ull));
+		key = (key << _GL_RenderQueue_depthBits) | depth;
+
+		keys[i] = key;
+		order[i] = i;
+
+	}
+
+	for (unsigned int shift = 0u; shift < 64u; shift += 8u) {
+
+		unsigned int offsets[256] = { };
+		for (unsigned int i = 0u; i < n; i++) offsets[(keys[i] >> shift) & 255u]++;
+		if (offsets[(keys[0] >> shift) & 255u] == n) continue;
+
+		unsigned int total = 0u;
+		for (unsigned int digit = 0u; digit < 256u; digit++) {
+
+			unsigned int count = offsets[digit];
+			offsets[digit] = total;
+			total += count;
+
+		}
+
+		for (unsigned int i = 0u; i < n; i++) {
+
+			unsigned int destination = offsets[(keys[i] >> shift) & 255u]++;
+			scratchKeys[destination] = keys[i];
+			scratchOrder[destination] = order[i];
+
+		}
+
+		keys.swap(scratchKeys);
+		order.swap(scratchOrder);
+
+	}
+
+}
+
+void GL::RenderQueue::prepareIndirectDraws() {
+
+	indirectCommands.clear();
+	indirectDrawData.clear();
+
+	for (unsigned int i = 0u; i < order.size(); i++) {
+
+		RenderQueue_types::Item& item = items[order[i]];
+		if (!item.isIndirect) continue;
+
+		if (indirectCommands.size() == _GL_Model_maxIndirectDraws) {
+
+			item.isIndirect = false;
+			item.vao = item.meshVao;
+			continue;
+
+		}
+
+		RenderQueue_types::IndirectCommand command = { item.numElements, 1u, item.firstIndex, item.baseVertex, (GLuint)indirectCommands.size() };
+		indirectCommands.push_back(command);
+		indirectDrawData.push_back(RenderQueue_types::DrawData());
+		item.model->getIndirectDrawData(item, indirectDrawData.back());
+
+	}
+
+	if (!indirectCommands.empty()) Model::uploadIndirectDraws(indirectCommands.data(), indirectDrawData.data(), indirectCommands.size());
+
+}
+
+bool GL::RenderQueue::isSameIndirectBatch(const GL::RenderQueue_types::Item& a, const GL::RenderQueue_types::Item& b) {
+
+	return (
+		b.isIndirect && a.program == b.program && a.vao == b.vao && a.indexType == b.indexType &&
+		a.textures[0] == b.textures[0] && a.textures[1] == b.textures[1] && a.textures[2] == b.textures[2]
+	);
+
+}
+
+bool GL::RenderQueue::isSameUniforms(const GL::RenderQueue_types::MeshUniforms& a, const GL::RenderQueue_types::MeshUniforms& b) {
+
+	return (
+		a.metallic == b.metallic && a.roughness == b.roughness && a.ao == b.ao && a.shadowOcclusion == b.shadowOcclusion &&
+		a.albedoStretch == b.albedoStretch && a.metallicStretch == b.metallicStretch && a.roughnessStretch == b.roughnessStretch && a.normalStretch == b.normalStretch &&
+		a.color.x == b.color.x && a.color.y == b.color.y && a.color.z == b.color.z && a.color.w == b.color.w &&
+		a.isInstanced == b.isInstanced && a.derivesNormalMatrix == b.derivesNormalMatrix
+	);
+
+}
@@ -0,0 +1,165 @@
+#ifndef RENDERQUEUE_HPP
+#define RENDERQUEUE_HPP
+
+#include <vector>
+#include <unordered_map>
+
+#include "./../util/util.hpp"
+#include "./ModelStructs.hpp"
+
+#define _GL_RenderQueue_programBits 12u
+#define _GL_RenderQueue_textureSetBits 16u
+#define _GL_RenderQueue_vertexArrayBits 20u
+#define _GL_RenderQueue_depthBits 16u
+
+namespace GL {
+
+	class Scene;
+	class Model;
+
+	namespace RenderQueue_types {
+
+		struct Item {
+
+			Model* model;
+			unsigned int mesh;
+			unsigned int program;
+			GLuint textures[3];
+			GLuint vao;
+			float depth;
+			unsigned int numElements;
+			GLenum indexType;
+			size_t firstIndexOffset;
+
+			bool isIndirect;
+			GLuint meshVao;
+			unsigned int firstIndex;
+			int baseVertex;
+
+		};
+
+		struct IndirectCommand {
+
+			GLuint count;
+			GLuint instanceCount;
+			GLuint firstIndex;
+			GLint baseVertex;
+			GLuint baseInstance;
+
+		};
+
+		// Matches the std430 DrawData struct of the model vertex shader.
+		struct DrawData {
+
+			mat4 modelMatrix;
+			mat4 normalMatrix;
+			vec4 positionOffset;
+			vec4 positionScale;
+			vec4 color;
+			vec4 material;
+			vec4 stretch;
+
+		};
+
+		struct MeshUniforms {
+
+			float metallic, roughness, ao, shadowOcclusion;
+			float albedoStretch, metallicStretch, roughnessStretch, normalStretch;
+			vec4 color;
+			int isInstanced;
+			int derivesNormalMatrix;
+
+		};
+
+		struct Statistics {
+
+			unsigned int numItems = 0u;
+			unsigned int numProgramChanges = 0u;
+			unsigned int numAvoidedProgramChanges = 0u;
+			unsigned int numTextureBinds = 0u;
+			unsigned int numAvoidedTextureBinds = 0u;
+			unsigned int numVertexArrayBinds = 0u;
+			unsigned int numAvoidedVertexArrayBinds = 0u;
+			unsigned int numUniformUpdates = 0u;
+			unsigned int numAvoidedUniformUpdates = 0u;
+			unsigned int numModelUpdates = 0u;
+			unsigned int numAvoidedModelUpdates = 0u;
+			unsigned int numIndirectDraws = 0u;
+			unsigned int numIndirectMeshes = 0u;
+
+		};
+
+	}
+
+	// Collects the visible meshes of a frame, sorts them by program, material textures, vertex array and depth (front to back)
+	// and submits them while skipping the state changes that are already in place.
+	class RenderQueue {
+	public:
+
+		void clear();
+
+		void push(const RenderQueue_types::Item& item);
+
+		void submit(Scene& scene);
+
+		// Packed meshes (see Model::useMeshPacking) of the same program, textures and buffers are drawn with one glMultiDrawElementsIndirect call.
+		void useIndirectDraws(bool use);
+
+		bool usesIndirectDraws() const;
+
+		unsigned int getNumItems() const;
+
+		RenderQueue_types::Statistics getStatistics() const;
+
+		bool useProgram(GLuint ID);
+
+		// Forgets the current program after something else (e.g. a compute dispatch) changed it.
+		void invalidateProgram();
+
+		void bindTexture(unsigned int unit, GLuint ID);
+
+		bool bindVertexArray(GLuint ID);
+
+		bool useModel(const Model* model);
+
+		bool prepareProgram(unsigned int program);
+
+		bool setMeshUniforms(unsigned int program, const RenderQueue_types::MeshUniforms& uniforms);
+
+	private:
+
+		std::vector<RenderQueue_types::Item> items;
+		std::vector<unsigned long long> keys;
+		std::vector<unsigned int> order;
+		std::vector<unsigned long long> scratchKeys;
+		std::vector<unsigned int> scratchOrder;
+		std::unordered_map<unsigned long long, unsigned int> textureSets;
+		float maxDepth = 0.0f;
+
+		bool indirectDraws = true;
+		std::vector<RenderQueue_types::IndirectCommand> indirectCommands;
+		std::vector<RenderQueue_types::DrawData> indirectDrawData;
+
+		GLuint currentProgram;
+		GLuint currentTextures[3];
+		GLuint currentVertexArray;
+		const Model* currentModel;
+		std::vector<bool> preparedPrograms;
+		std::vector<bool> hasMeshUniforms;
+		std::vector<RenderQueue_types::MeshUniforms> meshUniforms;
+
+		RenderQueue_types::Statistics stats;
+
+		void sort();
+
+		void prepareIndirectDraws();
+
+		static bool isSameIndirectBatch(const RenderQueue_types::Item& a, const RenderQueue_types::Item& b);
+
+		static bool isSameUniforms(const RenderQueue_types::MeshUniforms& a, const RenderQueue_types::MeshUniforms& b);
+
+	};
+
+}
+
+#endif
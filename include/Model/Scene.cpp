@@ -63,12 +63,70 @@ void GL::Scene::applySampleSettings(GL::Drawable& model, GL::SampleSettings samp
 
 }
 
+void GL::Scene::useFrustumCulling(bool use) { frustumCulling = use; }
+
+bool GL::Scene::usesFrustumCulling() const { return frustumCulling; }
+
+unsigned int GL::Scene::getNumTestedModels() const { return numTestedModels; }
+
+unsigned int GL::Scene::getNumCulledModels() const { return numCulledModels; }
+
+void GL::Scene::useRenderQueue(bool use) { renderQueueing = use; }
+
+bool GL::Scene::usesRenderQueue() const { return renderQueueing; }
+
+void GL::Scene::useMultiDrawIndirect(bool use) { renderQueue.useIndirectDraws(use); }
+
+bool GL::Scene::usesMultiDrawIndirect() const { return renderQueue.usesIndirectDraws(); }
+
+GL::RenderQueue_types::Statistics GL::Scene::getRenderQueueStatistics() const { return renderQueue.getStatistics(); }
+
+void GL::Scene::useInstanceOcclusionCulling(bool use) {
+
+	instanceOcclusionCulling = use;
+	if (instanceCuller) instanceCuller->invalidateDepthPyramid();
+
+}
+
+bool GL::Scene::usesInstanceOcclusionCulling() const { return instanceOcclusionCulling; }
+
+void GL::Scene::cullInstances(GL::ModelInstanceBuffer& instances, GL::BoundingBox localBB, unsigned int numCommands) {
+
+	if (!instanceCuller) instanceCuller = new InstanceCuller();
+	instanceCuller->cull(instances, localBB, perspectiveMatrix, numCommands, instanceOcclusionCulling);
+
+}
+
+unsigned int GL::Scene::getNumTestedShadowCasters() const { return numTestedShadowCasters; }
+
+unsigned int GL::Scene::getNumCulledShadowCasters() const { return numCulledShadowCasters; }
+
+void GL::Scene::useShadowMapCaching(bool use) {
+	
+	if (use && !shadowMapCaching) invalidateShadowMaps();
+	shadowMapCaching = use;
+
+}
+
+bool GL::Scene::usesShadowMapCaching() const { return shadowMapCaching; }
+
+void GL::Scene::invalidateShadowMaps() {
+
+	for (unsigned int i = 0u; i < pointLightShadowMaps.size(); i++) pointLightShadowMaps[i].isValid = false;
+	for (unsigned int i = 0u; i < _GL_OverheadShadowRenderer_maxMaps; i++) overheadShadowMaps[i].isValid = false;
+
+}
+
+unsigned int GL::Scene::getNumRedrawnShadowMaps() const { return numRedrawnShadowMaps; }
+
 void GL::Scene::draw() { draw_commonCode(nullptr); }
 
 void GL::Scene::draw(GL::Framebuffer& fb) { draw_commonCode(&fb); }
 
 bool GL::Scene::hasBackground() const { return bg; }
 
+unsigned int GL::Scene::getFrameIndex() const { return frameIndex; }
+
 void GL::Scene::setLightPosition(unsigned int index, GL::vec3 position) { lightPositions[index % 16u] = position; }
 
 void GL::Scene::setLightColor(unsigned int index, GL::vec3 color) { lightColors[index % 16u] = max(color, 0.0f); }
@@ -102,15 +160,17 @@ GL::vec3 GL::Scene::getCameraPosition() const { return camPos; }
 
 GL::mat4 GL::Scene::getPerspectiveMatrix() const { return perspectiveMatrix; }
 
-GL::mat4 GL::Scene::getOverheadShadowPVMatrix() const { return (overheadShadowRenderer) ? overheadShadowRenderer->PV : mat4(); }
+GL::Frustum GL::Scene::getFrustum() const { return frustum; }
+
+GL::mat4 GL::Scene::getOverheadShadowPVMatrix() const { return (overheadShadowRenderer) ? overheadShadowRenderer->PVs[0] : mat4(); }
 
-float GL::Scene::getOverheadShadowFarPlane() const { return (overheadShadowRenderer) ? overheadShadowRenderer->farPlane : 0.0f; }
+float GL::Scene::getOverheadShadowFarPlane() const { return (overheadShadowRenderer) ? overheadShadowRenderer->farPlanes[0] : 0.0f; }
 
 GL::BoundingBox GL::Scene::getOverheadShadowBoundingBox() const { return bb; }
 
-GL::mat4 GL::Scene::getOverheadOuterShadowPVMatrix() const { return (overheadShadowRenderer) ? overheadShadowRenderer->outerPV : mat4(); }
+GL::mat4 GL::Scene::getOverheadOuterShadowPVMatrix() const { return (usesFancyOverheadShadows()) ? overheadShadowRenderer->PVs[1] : mat4(); }
 
-float GL::Scene::getOverheadOuterShadowFarPlane() const { return (overheadShadowRenderer) ? overheadShadowRenderer->outerFarPlane : 0.0f; }
+float GL::Scene::getOverheadOuterShadowFarPlane() const { return (usesFancyOverheadShadows()) ? overheadShadowRenderer->farPlanes[1] : 0.0f; }
 
 GL::BoundingBox GL::Scene::getOverheadOuterShadowBoundingBox() const { return outerBb; }
 
@@ -137,6 +197,14 @@ GL::BoundingBox GL::Scene::getBoundingBoxApproximation() {
 
 bool GL::Scene::usesFancyOverheadShadows() const { return (overheadShadowRenderer) ? overheadShadowRenderer->isFancy() : false; }
 
+unsigned int GL::Scene::getNumOverheadShadowMaps() const { return (overheadShadowRenderer) ? overheadShadowRenderer->getNumMaps() : 0u; }
+
+GL::mat4 GL::Scene::getOverheadShadowPVMatrix(unsigned int map) const { return (map < getNumOverheadShadowMaps()) ? overheadShadowRenderer->PVs[map] : mat4(); }
+
+float GL::Scene::getOverheadShadowFarPlane(unsigned int map) const { return (map < getNumOverheadShadowMaps()) ? overheadShadowRenderer->farPlanes[map] : 0.0f; }
+
+float GL::Scene::getOverheadCascadeSplit(unsigned int index) const { return (overheadShadowRenderer && overheadShadowRenderer->isCascaded() && index <= getNumOverheadShadowMaps()) ? overheadShadowRenderer->cascadeSplits[index] : 0.0f; }
+
 unsigned int GL::Scene::getNumPointLights() const { return numPointLights; }
 
 void GL::Scene::updateCamera(GL::BoundingBox sceneBB, GL::vec3 cameraPosition, GL::vec3 lookingAt, GL::vec3 up, float FoV) { updateCamera_commonCode(sceneBB, nullptr, cameraPosition, lookingAt, up, FoV); }
@@ -208,6 +276,7 @@ void GL::Scene::drawToFramebuffer(GL::Framebuffer* fb) {
 	glDrawArrays(GL_TRIANGLES, 0, 6);
 	
 	backgroundUsed = false;
+	frameIndex++;
 
 }
 
@@ -246,6 +315,8 @@ GL::Scene::~Scene() {
 
 	if (overheadShadowRenderer) delete overheadShadowRenderer;
 
+	if (instanceCuller) delete instanceCuller;
+
 }
 
 void GL::Scene::init(ImageTextureCubeMap* background, float zNear, float zFar, GL::ShadowSettings shadowSettings) {
@@ -367,6 +438,8 @@ void GL::Scene::init(ImageTextureCubeMap* background, float zNear, float zFar, G
 		for (unsigned int i = 0u; i < numPointLights; i++) pointLightShadowRenderers[i] = new PointLightShadowRenderer(shadowSettings, i);
 
 	}
+	pointLightShadowMaps.resize(numPointLights);
+	shadowMapCaching = shadowSettings.cacheShadowMaps;
 
 	if (shadowSettings.hasOverheadShadow) overheadShadowRenderer = new OverheadShadowRenderer(shadowSettings);
 
@@ -375,6 +448,7 @@ void GL::Scene::init(ImageTextureCubeMap* background, float zNear, float zFar, G
 void GL::Scene::updateCamera_commonCode(BoundingBox closeBB, BoundingBox* farBB, vec3 cameraPosition, vec3 lookingAt, vec3 up, float FoV) {
 	
 	perspectiveMatrix = perspective(FoV, aspectRatio, zNear, zFar) * lookAt(cameraPosition, lookingAt, up);
+	frustum = Frustum(perspectiveMatrix);
 	camPos = cameraPosition;
 
 	vec2 screenDims = getScreenDims(FoV, aspectRatio, zNear) / 2.0f;
@@ -383,7 +457,13 @@ void GL::Scene::updateCamera_commonCode(BoundingBox closeBB, BoundingBox* farBB,
 	raytraceUnis->set<mat3>("rot", cameraRotation(lookingAt - cameraPosition, up));
 	raytraceUnis->update();
 
-	if (overheadShadowRenderer) {
+	if (overheadShadowRenderer && overheadShadowRenderer->isCascaded()) {
+
+		if (farBB) throw Exception("A scene with cascaded overhead shadows must only have one bounding box.");
+		overheadShadowRenderer->calcCascadePVMatrices(lightDirection, closeBB, cameraPosition, lookingAt, up, FoV, aspectRatio, zNear, zFar);
+
+	}
+	else if (overheadShadowRenderer) {
 
 		overheadShadowRenderer->calcPVMatrix(lightDirection, closeBB, farBB, false);
 		if (overheadShadowRenderer->isFancy()) {
@@ -405,44 +485,228 @@ void GL::Scene::updateCamera_commonCode(BoundingBox closeBB, BoundingBox* farBB,
 
 void GL::Scene::draw_commonCode(Framebuffer* fb) {
 
-	for (unsigned int i = 0u; i < numPointLights; i++) for (unsigned int face = 0u; face < 6u; face++) {
+	numTestedModels = 0u;
+	numCulledModels = 0u;
+	numTestedShadowCasters = 0u;
+	numCulledShadowCasters = 0u;
+	numRedrawnShadowMaps = 0u;
+	updateModelBoundingBoxes();
+	updateShadowCasterStates();
+
+	for (unsigned int i = 0u; i < numPointLights; i++) {
+
+		PointLightShadowRenderer& renderer = *pointLightShadowRenderers[i];
+		mat4 facePVs[6];
+		Frustum faceFrustums[6];
+
+		for (unsigned int face = 0u; face < 6u; face++) {
+
+			facePVs[face] = PointLightShadowRenderer::getPVMatrix(face, lightPositions[i], zFar);
+			faceFrustums[face] = Frustum(facePVs[face]);
+
+		}
+
+		bool staticLayerOutdated;
+		if (!isShadowMapOutdated(pointLightShadowMaps[i], facePVs[0], faceFrustums, 6u, staticLayerOutdated)) continue;
+
+		bool useStaticLayer = shadowMapCaching && renderer.hasStaticLayer();
+		ShadowPass pass = (useStaticLayer) ? ShadowPass::DYNAMIC_CASTERS : ShadowPass::ALL_CASTERS;
+		numRedrawnShadowMaps++;
 
-		pointLightShadowRenderers[i]->setUpFaceForDrawing(face);
-		mat4 PV = PointLightShadowRenderer::getPVMatrix(face, lightPositions[i], zFar);
+		if (renderer.isLayered()) {
 
-		for (unsigned int j = 0u; j < models.size(); j++) if (isModelUsed[j] && modelCastsShadow[j]) {
+			if (useStaticLayer && staticLayerOutdated) {
 
-			pointLightShadowRenderers[i]->setUpShadersForDrawing(models[j]->isAnimated(), models[j]->isInstanced());
-			models[j]->drawShadow(PV, models[j]->getModelMatrix(), *this);
+				renderer.setUpLayersForDrawing(lightPositions[i], zFar, ShadowPass::STATIC_CASTERS);
+				drawShadowCasters(renderer, ShadowPass::STATIC_CASTERS, facePVs[0], faceFrustums, 6u);
+
+			}
+
+			renderer.setUpLayersForDrawing(lightPositions[i], zFar, pass);
+			drawShadowCasters(renderer, pass, facePVs[0], faceFrustums, 6u);
+
+		}
+		else for (unsigned int face = 0u; face < 6u; face++) {
+
+			if (useStaticLayer && staticLayerOutdated) {
+
+				renderer.setUpFaceForDrawing(face, ShadowPass::STATIC_CASTERS);
+				drawShadowCasters(renderer, ShadowPass::STATIC_CASTERS, facePVs[face], &faceFrustums[face], 1u);
+
+			}
+
+			renderer.setUpFaceForDrawing(face, pass);
+			drawShadowCasters(renderer, pass, facePVs[face], &faceFrustums[face], 1u);
 
 		}
 
 	}
 
-	if (overheadShadowRenderer) {
+	for (unsigned int map = 0u; map < getNumOverheadShadowMaps(); map++) {
 
-#define _GL_Scene_drawOverheadShadow(pvmatrix, outerBuffer) { \
-	overheadShadowRenderer->setUpForDrawing(outerBuffer); \
-	\
-	for (unsigned int i = 0u; i < models.size(); i++) if (isModelUsed[i] && modelCastsShadow[i]) { \
-		\
-		overheadShadowRenderer->setUpShadersForDrawing(models[i]->isAnimated(), models[i]->isInstanced()); \
-		models[i]->drawShadow(pvmatrix, models[i]->getModelMatrix(), *this); \
-		\
-	} \
-}
+		mat4 PV = overheadShadowRenderer->PVs[map];
+		Frustum mapFrustum(PV);
+
+		bool staticLayerOutdated;
+		if (!isShadowMapOutdated(overheadShadowMaps[map], PV, &mapFrustum, 1u, staticLayerOutdated)) continue;
+
+		bool useStaticLayer = shadowMapCaching && overheadShadowRenderer->hasStaticLayer();
+		ShadowPass pass = (useStaticLayer) ? ShadowPass::DYNAMIC_CASTERS : ShadowPass::ALL_CASTERS;
+		numRedrawnShadowMaps++;
+
+		if (useStaticLayer && staticLayerOutdated) {
 
-		_GL_Scene_drawOverheadShadow(overheadShadowRenderer->PV, false);
-		if (overheadShadowRenderer->isFancy()) _GL_Scene_drawOverheadShadow(overheadShadowRenderer->outerPV, true);
+			overheadShadowRenderer->setUpForDrawing(map, ShadowPass::STATIC_CASTERS);
+			drawShadowCasters(*overheadShadowRenderer, ShadowPass::STATIC_CASTERS, PV, &mapFrustum, 1u);
+
+		}
+
+		overheadShadowRenderer->setUpForDrawing(map, pass);
+		drawShadowCasters(*overheadShadowRenderer, pass, PV, &mapFrustum, 1u);
 
 	}
 
-	for (unsigned int i = 0u; i < models.size(); i++) if (isModelUsed[i]) models[i]->draw(*this, modelSettings[i]);
+	renderQueue.clear();
+	for (unsigned int i = 0u; i < models.size(); i++) if (isModelUsed[i] && !isModelCulled(i, &frustum, 1u, numTestedModels, numCulledModels)) {
+
+		if (!renderQueueing || !models[i]->enqueue(renderQueue, *this, modelSettings[i])) models[i]->draw(*this, modelSettings[i]);
+
+	}
+	renderQueue.submit(*this);
+	if (instanceCuller && instanceOcclusionCulling) instanceCuller->buildDepthPyramid(fbDepth, perspectiveMatrix);
 	drawToFramebuffer(fb);
 	alreadyUsing = false;
 
 }
 
+void GL::Scene::updateModelBoundingBoxes() {
+
+	modelBoundingBoxes.resize(models.size());
+	modelHasBoundingBox.assign(models.size(), false);
+
+	for (unsigned int i = 0u; i < models.size(); i++) if (isModelUsed[i] && !models[i]->isAnimated() && !models[i]->isInstanced()) {
+
+		modelBoundingBoxes[i] = models[i]->getWorldSpaceBoundingBoxApproximation();
+		modelHasBoundingBox[i] = true;
+
+	}
+
+}
+
+bool GL::Scene::isModelCulled(unsigned int index, const GL::Frustum* frustums, unsigned int numFrustums, unsigned int& numTested, unsigned int& numCulled) {
+
+	if (!frustumCulling || !modelHasBoundingBox[index]) return false;
+
+	numTested++;
+	for (unsigned int i = 0u; i < numFrustums; i++) if (frustums[i].intersects(modelBoundingBoxes[index])) return false;
+
+	numCulled++;
+	return true;
+
+}
+
+void GL::Scene::updateShadowCasterStates() {
+
+	changedCasterRegions.clear();
+	changedStaticCasterRegions.clear();
+	casterChangedEverywhere = false;
+	staticCasterChangedEverywhere = false;
+	shadowCasterStates.resize(models.size());
+
+	for (unsigned int i = 0u; i < models.size(); i++) {
+
+		ShadowCasterState& state = shadowCasterStates[i];
+		ShadowCasterState previousState = state;
+
+		bool castsShadow = isModelUsed[i] && modelCastsShadow[i];
+		mat4 modelMatrix = models[i]->getModelMatrix();
+		unsigned int poseVersion = models[i]->getPoseVersion();
+		bool isInstanced = models[i]->isInstanced();
+		unsigned int instanceVersion = models[i]->getInstanceVersion();
+		unsigned int lodKey = (castsShadow) ? models[i]->getShadowLodKey(*this) : 0u;
+
+		bool changed = castsShadow != state.castsShadow;
+		if (castsShadow && !changed) changed = isInstanced != state.isInstanced || instanceVersion != state.instanceVersion || models[i]->isPoseChanging() || poseVersion != state.poseVersion || lodKey != state.lodKey || !isSameMatrix(modelMatrix, state.modelMatrix);
+
+		if (changed) {
+
+			if (state.castsShadow) addChangedRegion(changedCasterRegions, casterChangedEverywhere, state.hasBoundingBox, state.boundingBox);
+			if (castsShadow) addChangedRegion(changedCasterRegions, casterChangedEverywhere, modelHasBoundingBox[i], modelBoundingBoxes[i]);
+
+			state.castsShadow = castsShadow;
+			state.modelMatrix = modelMatrix;
+			state.poseVersion = poseVersion;
+			state.isInstanced = isInstanced;
+			state.instanceVersion = instanceVersion;
+			state.lodKey = lodKey;
+			state.boundingBox = modelBoundingBoxes[i];
+			state.hasBoundingBox = modelHasBoundingBox[i];
+			state.numUnchangedFrames = 0u;
+
+		}
+		else if (state.numUnchangedFrames < _GL_Scene_staticShadowCasterFrames) state.numUnchangedFrames++;
+
+		state.isStatic = castsShadow && state.numUnchangedFrames >= _GL_Scene_staticShadowCasterFrames;
+		if (state.isStatic != previousState.isStatic) addChangedRegion(changedStaticCasterRegions, staticCasterChangedEverywhere, previousState.hasBoundingBox, previousState.boundingBox);
+
+	}
+
+}
+
+bool GL::Scene::isShadowMapOutdated(ShadowMapState& state, GL::mat4 PV, const GL::Frustum* frustums, unsigned int numFrustums, bool& staticLayerOutdated) {
+
+	bool lightMoved = !state.isValid || !isSameMatrix(state.PV, PV);
+	state.isValid = true;
+	state.PV = PV;
+
+	staticLayerOutdated = lightMoved || isRegionChanged(changedStaticCasterRegions, staticCasterChangedEverywhere, frustums, numFrustums);
+	return !shadowMapCaching || staticLayerOutdated || isRegionChanged(changedCasterRegions, casterChangedEverywhere, frustums, numFrustums);
+
+}
+
+void GL::Scene::drawShadowCasters(GL::ShadowRenderer& renderer, GL::ShadowPass pass, GL::mat4 PV, const GL::Frustum* frustums, unsigned int numFrustums) {
+
+	for (unsigned int i = 0u; i < models.size(); i++) {
+
+		if (!isModelUsed[i] || !modelCastsShadow[i]) continue;
+		if (pass == ShadowPass::STATIC_CASTERS && !shadowCasterStates[i].isStatic) continue;
+		if (pass == ShadowPass::DYNAMIC_CASTERS && shadowCasterStates[i].isStatic) continue;
+		if (isModelCulled(i, frustums, numFrustums, numTestedShadowCasters, numCulledShadowCasters)) continue;
+
+		renderer.setUpShadersForDrawing(models[i]->isAnimated() && !models[i]->isPreSkinned(), models[i]->isInstanced(), models[i]->hasInstancePoses());
+		models[i]->drawShadow(PV, models[i]->getModelMatrix(), *this);
+
+	}
+
+}
+
+void GL::Scene::addChangedRegion(std::vector<GL::BoundingBox>& regions, bool& everywhere, bool hasBoundingBox, GL::BoundingBox boundingBox) {
+
+	if (hasBoundingBox) regions.push_back(boundingBox);
+	else everywhere = true;
+
+}
+
+bool GL::Scene::isRegionChanged(const std::vector<GL::BoundingBox>& regions, bool everywhere, const GL::Frustum* frustums, unsigned int numFrustums) {
+
+	if (everywhere) return true;
+
+	for (unsigned int i = 0u; i < regions.size(); i++)
+		for (unsigned int j = 0u; j < numFrustums; j++) if (frustums[j].intersects(regions[i])) return true;
+
+	return false;
+
+}
+
+bool GL::Scene::isSameMatrix(GL::mat4 a, GL::mat4 b) {
+
+	for (int col = 0; col < 4; col++)
+		for (int row = 0; row < 4; row++) if (a[col][row] != b[col][row]) return false;
+
+	return true;
+
+}
+
 const char* GL::Scene::progBRDF_source[] = {
 
 	"#version 430 core\n \
@@ -14,12 +14,16 @@
 #include "./../Framebuffer/Framebuffer.hpp"
 #include "./../VertexArray/VertexArray.hpp"
 #include "./ShadowRenderer.hpp"
+#include "./RenderQueue.hpp"
+#include "./InstanceCuller.hpp"
 #include "./ModelStructs.hpp"
 
+#define _GL_Scene_staticShadowCasterFrames 30u
+
 namespace GL {
 
 	class Scene;
-	class Drawable { public: virtual void draw(Scene& scene, SampleSettings reqSettings) = 0; virtual void drawShadow(mat4 PV, mat4 model, Scene& scene) = 0; virtual mat4 getModelMatrix() const = 0; virtual bool isAnimated() const = 0; virtual bool isInstanced() const = 0; virtual BoundingBox getWorldSpaceBoundingBoxApproximation() const = 0; };
+	class Drawable { public: virtual void draw(Scene& scene, SampleSettings reqSettings) = 0; virtual void drawShadow(mat4 PV, mat4 model, Scene& scene) = 0; virtual mat4 getModelMatrix() const = 0; virtual bool isAnimated() const = 0; virtual bool isInstanced() const = 0; virtual bool hasInstancePoses() const { return false; } virtual bool isPreSkinned() const { return false; } virtual unsigned int getShadowLodKey(Scene&) const { return 0u; } virtual BoundingBox getWorldSpaceBoundingBoxApproximation() const = 0; virtual bool isPoseChanging() const { return isAnimated(); } virtual unsigned int getPoseVersion() const { return 0u; } virtual unsigned int getInstanceVersion() const { return 0u; } virtual bool enqueue(RenderQueue&, Scene&, SampleSettings) { return false; } };
 	
 	class Scene : public _util {
 	public:
@@ -40,12 +44,52 @@ namespace GL {
 
 		void applySampleSettings(Drawable& model, SampleSettings sampleSettings);
 
+		void useFrustumCulling(bool use);
+
+		bool usesFrustumCulling() const;
+
+		unsigned int getNumTestedModels() const;
+
+		unsigned int getNumCulledModels() const;
+
+		unsigned int getNumTestedShadowCasters() const;
+
+		unsigned int getNumCulledShadowCasters() const;
+
+		void useShadowMapCaching(bool use);
+
+		bool usesShadowMapCaching() const;
+
+		void invalidateShadowMaps();
+
+		unsigned int getNumRedrawnShadowMaps() const;
+
+		void useRenderQueue(bool use);
+
+		bool usesRenderQueue() const;
+
+		void useMultiDrawIndirect(bool use);
+
+		bool usesMultiDrawIndirect() const;
+
+		RenderQueue_types::Statistics getRenderQueueStatistics() const;
+
+		// Also culls GPU culled instances (see ModelInstanceBuffer::useGpuCulling) against the depth of the last frame.
+		void useInstanceOcclusionCulling(bool use);
+
+		bool usesInstanceOcclusionCulling() const;
+
+		void cullInstances(ModelInstanceBuffer& instances, BoundingBox localBB, unsigned int numCommands);
+
 		void draw();
 
 		void draw(Framebuffer& fb);
 
 		bool hasBackground() const;
 
+		// Counts the frames drawn so far, models use it to do per-frame work (e.g. GPU skinning) only once across all passes of a frame.
+		unsigned int getFrameIndex() const;
+
 		void setLightPosition(unsigned int index, vec3 position);
 
 		void setLightColor(unsigned int index, vec3 color);
@@ -74,6 +118,8 @@ namespace GL {
 
 		mat4 getPerspectiveMatrix() const;
 
+		Frustum getFrustum() const;
+
 		mat4 getOverheadShadowPVMatrix() const;
 
 		float getOverheadShadowFarPlane() const;
@@ -90,6 +136,14 @@ namespace GL {
 
 		bool usesFancyOverheadShadows() const;
 
+		unsigned int getNumOverheadShadowMaps() const;
+
+		mat4 getOverheadShadowPVMatrix(unsigned int map) const;
+
+		float getOverheadShadowFarPlane(unsigned int map) const;
+
+		float getOverheadCascadeSplit(unsigned int index) const;
+
 		unsigned int getNumPointLights() const;
 
 		void updateCamera(BoundingBox sceneBB, vec3 cameraPosition, vec3 lookingAt, vec3 up, float FoV);
@@ -120,6 +174,53 @@ namespace GL {
 		float aspectRatio;
 		vec3 camPos;
 		mat4 perspectiveMatrix;
+		Frustum frustum;
+
+		bool frustumCulling = true;
+		unsigned int numTestedModels = 0u;
+		unsigned int numCulledModels = 0u;
+		unsigned int numTestedShadowCasters = 0u;
+		unsigned int numCulledShadowCasters = 0u;
+		std::vector<BoundingBox> modelBoundingBoxes;
+		std::vector<bool> modelHasBoundingBox;
+
+		RenderQueue renderQueue;
+		bool renderQueueing = true;
+
+		InstanceCuller* instanceCuller = nullptr;
+		bool instanceOcclusionCulling = false;
+
+		struct ShadowCasterState {
+
+			bool castsShadow = false;
+			mat4 modelMatrix;
+			unsigned int poseVersion = 0u;
+			bool isInstanced = false;
+			unsigned int instanceVersion = 0u;
+			unsigned int lodKey = 0u;
+			BoundingBox boundingBox;
+			bool hasBoundingBox = false;
+			unsigned int numUnchangedFrames = 0u;
+			bool isStatic = false;
+
+		};
+
+		struct ShadowMapState {
+
+			bool isValid = false;
+			mat4 PV;
+
+		};
+
+		bool shadowMapCaching = true;
+		unsigned int numRedrawnShadowMaps = 0u;
+		std::vector<ShadowCasterState> shadowCasterStates;
+		std::vector<BoundingBox> changedCasterRegions;
+		std::vector<BoundingBox> changedStaticCasterRegions;
+		bool casterChangedEverywhere = false;
+		bool staticCasterChangedEverywhere = false;
+		std::vector<ShadowMapState> pointLightShadowMaps;
+		ShadowMapState overheadShadowMaps[_GL_OverheadShadowRenderer_maxMaps];
 
 		vec3 lightPositions[16];
 		vec3 lightColors[16];
@@ -131,6 +232,7 @@ namespace GL {
 
 		bool cameraUpdated = false;
 		bool backgroundUsed = false;
+		unsigned int frameIndex = 0u;
 
 		unsigned int numPointLights;
 		PointLightShadowRenderer** pointLightShadowRenderers = nullptr;
@@ -164,6 +266,22 @@ namespace GL {
 
 		void draw_commonCode(Framebuffer* fb);
 
+		void updateModelBoundingBoxes();
+
+		bool isModelCulled(unsigned int index, const Frustum* frustums, unsigned int numFrustums, unsigned int& numTested, unsigned int& numCulled);
+
+		void updateShadowCasterStates();
+
+		bool isShadowMapOutdated(ShadowMapState& state, mat4 PV, const Frustum* frustums, unsigned int numFrustums, bool& staticLayerOutdated);
+
+		void drawShadowCasters(ShadowRenderer& renderer, ShadowPass pass, mat4 PV, const Frustum* frustums, unsigned int numFrustums);
+
+		static void addChangedRegion(std::vector<BoundingBox>& regions, bool& everywhere, bool hasBoundingBox, BoundingBox boundingBox);
+
+		static bool isRegionChanged(const std::vector<BoundingBox>& regions, bool everywhere, const Frustum* frustums, unsigned int numFrustums);
+
+		static bool isSameMatrix(mat4 a, mat4 b);
+
 	};
 
 }
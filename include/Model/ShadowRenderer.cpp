@@ -29,7 +29,15 @@ GL::Program* GL::PointLightShadowRenderer::shadowRenderer[2] = { nullptr, nullpt
 
 GL::UniformTable* GL::PointLightShadowRenderer::shadowRenderer_unis[2] = { nullptr, nullptr };
 
-GL::PointLightShadowRenderer::PointLightShadowRenderer(GL::ShadowSettings settings, unsigned int lightIndex) : lightCubeMap(settings.shadowCubeMapSideLength, 8u + lightIndex, ColorFormat::R), depthBuffer(settings.shadowCubeMapSideLength, settings.shadowCubeMapSideLength), lightIndex(lightIndex) {
+GL::Program* GL::PointLightShadowRenderer::layeredShadowRenderer[2] = { nullptr, nullptr };
+
+GL::UniformTable* GL::PointLightShadowRenderer::layeredShadowRenderer_unis[2] = { nullptr, nullptr };
+
+GL::PointLightShadowRenderer::PointLightShadowRenderer(GL::ShadowSettings settings, unsigned int lightIndex) : 
+	lightCubeMap(settings.shadowCubeMapSideLength, 8u + lightIndex, ColorFormat::R), 
+	depthBuffer(settings.layeredPointLightShadows ? 1u : settings.shadowCubeMapSideLength, settings.layeredPointLightShadows ? 1u : settings.shadowCubeMapSideLength), 
+	lightIndex(lightIndex), 
+	layered(settings.layeredPointLightShadows) {
 	
 	glGenFramebuffers(1, &fbo);
 	lightCubeMap.setMinFilter(TextureFilter::LINEAR);
@@ -38,10 +46,14 @@ GL::PointLightShadowRenderer::PointLightShadowRenderer(GL::ShadowSettings settin
 
 	initializeVertShader();
 
+	const char* fs_source[2];
+	fs_source[1] = shadowRenderer_fs;
+
 	if (!shadowRenderer[0]) {
 		
+		fs_source[0] = "#version 430 core\n";
 		ShaderLoader fragShader(ShaderType::FRAGMENT);
-		fragShader.init(shadowRenderer_fs, false);
+		fragShader.init((char**)fs_source, 2u);
 
 		shadowRenderer[0] = new Program();
 		shadowRenderer[0]->init(*vertShader_noAnim, fragShader);
@@ -52,55 +64,195 @@ GL::PointLightShadowRenderer::PointLightShadowRenderer(GL::ShadowSettings settin
 		for (int i = 0; i < 2; i++) {
 
 			shadowRenderer_unis[i] = new UniformTable(*shadowRenderer[i]);
-			shadowRenderer_unis[i]->init("lightIdx", UniformType::UINT, 1u, "isInstanced", UniformType::INT, 1u);
+			shadowRenderer_unis[i]->init("lightIdx", UniformType::UINT, 1u, "isInstanced", UniformType::INT, 1u, "hasInstancePoses", UniformType::INT, 1u);
 
 		}
 		
 	}
 
+	if (layered) depthCubeMap = createDepthCubeMap(settings.shadowCubeMapSideLength);
+
+	if (settings.separateStaticShadowCasters) {
+
+		staticCubeMap = new ImageTextureCubeMap(settings.shadowCubeMapSideLength, 8u + lightIndex, ColorFormat::R);
+		staticCubeMap->setMinFilter(TextureFilter::NEAREST);
+		staticCubeMap->setMagFilter(TextureFilter::NEAREST);
+		staticDepthCubeMap = createDepthCubeMap(settings.shadowCubeMapSideLength);
+		lightCubeMap.bind();
+
+	}
+
+	if (layered && !layeredShadowRenderer[0]) {
+
+		fs_source[0] = "#version 430 core\n#define LAYERED\n";
+		ShaderLoader fragShader(ShaderType::FRAGMENT);
+		fragShader.init((char**)fs_source, 2u);
+
+		ShaderLoader geomShader(ShaderType::GEOMETRY);
+		geomShader.init(layeredShadowRenderer_gs, false);
+
+		layeredShadowRenderer[0] = new Program();
+		layeredShadowRenderer[0]->init(*vertShader_noAnim, geomShader, fragShader);
+
+		layeredShadowRenderer[1] = new Program();
+		layeredShadowRenderer[1]->init(*vertShader_anim, geomShader, fragShader);
+
+		for (int i = 0; i < 2; i++) {
+
+			layeredShadowRenderer_unis[i] = new UniformTable(*layeredShadowRenderer[i]);
+			layeredShadowRenderer_unis[i]->init("lightIdx", UniformType::UINT, 1u, "isInstanced", UniformType::INT, 1u, "hasInstancePoses", UniformType::INT, 1u, "facePVs", UniformType::MAT4, 6u);
+
+		}
+
+	}
+
 }
 
 void GL::PointLightShadowRenderer::bindTextures() { lightCubeMap.bind(); }
 
-void GL::PointLightShadowRenderer::setUpFaceForDrawing(unsigned int face) {
+void GL::PointLightShadowRenderer::setUpFaceForDrawing(unsigned int face, GL::ShadowPass pass) {
 	
+	if (layered) throw Exception("A layered point light shadow renderer draws all faces at once.");
+	if (pass != ShadowPass::ALL_CASTERS && !staticCubeMap) throw Exception("A point light shadow renderer without a static layer cannot draw static and dynamic shadow casters separately.");
+
+	unsigned int side = lightCubeMap.sideLength();
+	glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+
+	if (pass == ShadowPass::STATIC_CASTERS) {
+
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, staticCubeMap->getID(), 0);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, staticDepthCubeMap, 0);
+
+	}
+	else {
+
+		if (pass == ShadowPass::DYNAMIC_CASTERS) {
+
+			glCopyImageSubData(staticCubeMap->getID(), GL_TEXTURE_CUBE_MAP, 0, 0, 0, face, lightCubeMap.getID(), GL_TEXTURE_CUBE_MAP, 0, 0, 0, face, side, side, 1);
+			glCopyImageSubData(staticDepthCubeMap, GL_TEXTURE_CUBE_MAP, 0, 0, 0, face, depthBuffer.getID(), GL_RENDERBUFFER, 0, 0, 0, 0, side, side, 1);
+
+		}
+
+		lightCubeMap.bind();
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, lightCubeMap.getID(), 0);
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthBuffer.getID());
+
+	}
+
+	glViewport(0, 0, side, side);
+	if (pass == ShadowPass::DYNAMIC_CASTERS) return;
+
+	glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+}
+
+void GL::PointLightShadowRenderer::setUpLayersForDrawing(GL::vec3 lightPos, float zFar, GL::ShadowPass pass) {
+
+	if (!layered) throw Exception("Only a layered point light shadow renderer can draw all faces at once.");
+	if (pass != ShadowPass::ALL_CASTERS && !staticCubeMap) throw Exception("A point light shadow renderer without a static layer cannot draw static and dynamic shadow casters separately.");
+
+	unsigned int side = lightCubeMap.sideLength();
 	glBindFramebuffer(GL_FRAMEBUFFER, fbo);
-	lightCubeMap.bind();
-	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, lightCubeMap.getID(), 0);
-	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthBuffer.getID());
-	glViewport(0, 0, lightCubeMap.sideLength(), lightCubeMap.sideLength());
+
+	if (pass == ShadowPass::STATIC_CASTERS) {
+
+		glFramebufferTexture(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, staticCubeMap->getID(), 0);
+		glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, staticDepthCubeMap, 0);
+
+	}
+	else {
+
+		if (pass == ShadowPass::DYNAMIC_CASTERS) {
+
+			glCopyImageSubData(staticCubeMap->getID(), GL_TEXTURE_CUBE_MAP, 0, 0, 0, 0, lightCubeMap.getID(), GL_TEXTURE_CUBE_MAP, 0, 0, 0, 0, side, side, 6);
+			glCopyImageSubData(staticDepthCubeMap, GL_TEXTURE_CUBE_MAP, 0, 0, 0, 0, depthCubeMap, GL_TEXTURE_CUBE_MAP, 0, 0, 0, 0, side, side, 6);
+
+		}
+
+		glFramebufferTexture(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, lightCubeMap.getID(), 0);
+		glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, depthCubeMap, 0);
+
+	}
+
+	glViewport(0, 0, side, side);
+	for (unsigned int face = 0u; face < 6u; face++) facePVs[face] = getPVMatrix(face, lightPos, zFar);
+	if (pass == ShadowPass::DYNAMIC_CASTERS) return;
+
 	glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
 }
 
-void GL::PointLightShadowRenderer::setUpShadersForDrawing(bool isAnimated, bool isInstanced) {
+bool GL::PointLightShadowRenderer::isLayered() const { return layered; }
 
-	shadowRenderer_unis[isAnimated]->set("lightIdx", lightIndex);
-	shadowRenderer_unis[isAnimated]->set("isInstanced", (isInstanced) ? 1 : 0);
-	shadowRenderer_unis[isAnimated]->update();
-	shadowRenderer[isAnimated]->use();
+bool GL::PointLightShadowRenderer::hasStaticLayer() const { return staticCubeMap; }
+
+void GL::PointLightShadowRenderer::setUpShadersForDrawing(bool isAnimated, bool isInstanced, bool hasInstancePoses) {
+
+	UniformTable* unis = (layered) ? layeredShadowRenderer_unis[isAnimated] : shadowRenderer_unis[isAnimated];
+
+	unis->set("lightIdx", lightIndex);
+	unis->set("isInstanced", (isInstanced) ? 1 : 0);
+	unis->set("hasInstancePoses", (hasInstancePoses) ? 1 : 0);
+	if (layered) for (unsigned int face = 0u; face < 6u; face++) unis->setElement("facePVs", face, facePVs[face]);
+	unis->update();
+
+	if (layered) layeredShadowRenderer[isAnimated]->use();
+	else shadowRenderer[isAnimated]->use();
 
 }
 
-GL::PointLightShadowRenderer::~PointLightShadowRenderer() { if (fbo) glDeleteFramebuffers(1, &fbo); }
+GL::PointLightShadowRenderer::~PointLightShadowRenderer() { 
+	
+	if (fbo) glDeleteFramebuffers(1, &fbo); 
+	if (depthCubeMap) glDeleteTextures(1, &depthCubeMap);
+	if (staticCubeMap) delete staticCubeMap;
+	if (staticDepthCubeMap) glDeleteTextures(1, &staticDepthCubeMap);
+
+}
 
 GL::mat4 GL::PointLightShadowRenderer::getPVMatrix(unsigned int face, GL::vec3 lightPos, float zFar) { return perspective(radians(90.0f), 1.0f, zFar / 500.0f, zFar * 2.0f) * lookAt(lightPos, lightPos + _util::cubeMap_lookAt_targetVectors[face], _util::cubeMap_lookAt_upVectors[face]); }
 
+GLuint GL::PointLightShadowRenderer::createDepthCubeMap(unsigned int sideLength) {
+
+	GLuint ID;
+	glGenTextures(1, &ID);
+	glBindTexture(GL_TEXTURE_CUBE_MAP, ID);
+	glTexStorage2D(GL_TEXTURE_CUBE_MAP, 1, GL_DEPTH_COMPONENT24, sideLength, sideLength);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+	return ID;
+
+}
+
 GL::Program* GL::OverheadShadowRenderer::shadowRenderer[2] = { nullptr, nullptr };
 
 GL::UniformTable* GL::OverheadShadowRenderer::shadowRenderer_unis[2] = { nullptr, nullptr };
 
-GL::OverheadShadowRenderer::OverheadShadowRenderer(ShadowSettings settings) : fb(settings.overheadMapSideLength, settings.overheadMapSideLength), depthTexture(settings.overheadMapSideLength, settings.overheadMapSideLength, 14u) {
+GL::OverheadShadowRenderer::OverheadShadowRenderer(ShadowSettings settings) : 
+	sideLength(settings.overheadMapSideLength), 
+	fancy(settings.overheadShadowFancy), 
+	cascaded(settings.numOverheadCascades > 0u), 
+	splitLambda(clamp(settings.overheadCascadeSplitLambda, 0.0f, 1.0f)), 
+	shadowDistance(settings.overheadShadowDistance) {
 	
-	fb.setDepthStencilTarget(depthTexture);
-	if (settings.overheadShadowFancy) {
+	if (settings.numOverheadCascades > _GL_OverheadShadowRenderer_maxMaps) throw Exception("An overhead shadow can have at most " + std::to_string(_GL_OverheadShadowRenderer_maxMaps) + " cascades, not " + std::to_string(settings.numOverheadCascades) + ".");
+	if (fancy && cascaded) throw Exception("Fancy overhead shadows cannot be cascaded.");
 
-		outerDepthTexture = new DepthStencilRenderTexture(settings.overheadMapSideLength, settings.overheadMapSideLength, 15u);
-		outerFb = new Framebuffer(settings.overheadMapSideLength, settings.overheadMapSideLength);
-		outerFb->setDepthStencilTarget(*outerDepthTexture);
+	numMaps = (cascaded) ? settings.numOverheadCascades : ((fancy) ? 2u : 1u);
+	for (unsigned int i = 0u; i < _GL_OverheadShadowRenderer_maxMaps; i++) farPlanes[i] = 0.0f;
+	for (unsigned int i = 0u; i <= _GL_OverheadShadowRenderer_maxMaps; i++) cascadeSplits[i] = 0.0f;
 
-	}
+	depthArray = createDepthArray(sideLength, numMaps);
+	if (settings.separateStaticShadowCasters) staticDepthArray = createDepthArray(sideLength, numMaps);
+
+	glGenFramebuffers(1, &fbo);
+	glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+	glDrawBuffer(GL_NONE);
+	glReadBuffer(GL_NONE);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
 	
 	initializeVertShader();
 
@@ -118,7 +270,7 @@ GL::OverheadShadowRenderer::OverheadShadowRenderer(ShadowSettings settings) : fb
 		for (int i = 0; i < 2; i++) {
 
 			shadowRenderer_unis[i] = new UniformTable(*shadowRenderer[i]);
-			shadowRenderer_unis[i]->init("isInstanced", UniformType::INT, 1u);
+			shadowRenderer_unis[i]->init("isInstanced", UniformType::INT, 1u, "hasInstancePoses", UniformType::INT, 1u);
 
 		}
 
@@ -126,27 +278,40 @@ GL::OverheadShadowRenderer::OverheadShadowRenderer(ShadowSettings settings) : fb
 
 }
 
-bool GL::OverheadShadowRenderer::isFancy() { return outerFb; }
+bool GL::OverheadShadowRenderer::isFancy() { return fancy; }
+
+bool GL::OverheadShadowRenderer::isCascaded() const { return cascaded; }
+
+unsigned int GL::OverheadShadowRenderer::getNumMaps() const { return numMaps; }
 
 void GL::OverheadShadowRenderer::bindTextures() {
 
-	depthTexture.bind();
-	if (outerFb) outerDepthTexture->bind();
+	glActiveTexture(GL_TEXTURE0 + 14u);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, depthArray);
 
 }
 
-void GL::OverheadShadowRenderer::setUpForDrawing(bool outerBuffer) {
+void GL::OverheadShadowRenderer::setUpForDrawing(unsigned int map, GL::ShadowPass pass) {
 	
-	if (outerBuffer) outerFb->useWithoutColorBuffer();
-	else fb.useWithoutColorBuffer();
+	if (map >= numMaps) throw Exception("An overhead shadow renderer with " + std::to_string(numMaps) + " maps has no map " + std::to_string(map) + ".");
+	if (pass != ShadowPass::ALL_CASTERS && !staticDepthArray) throw Exception("An overhead shadow renderer without a static layer cannot draw static and dynamic shadow casters separately.");
 
-	glClear(GL_DEPTH_BUFFER_BIT);
+	if (pass == ShadowPass::DYNAMIC_CASTERS) glCopyImageSubData(staticDepthArray, GL_TEXTURE_2D_ARRAY, 0, 0, 0, map, depthArray, GL_TEXTURE_2D_ARRAY, 0, 0, 0, map, sideLength, sideLength, 1);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+	glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, (pass == ShadowPass::STATIC_CASTERS) ? staticDepthArray : depthArray, 0, map);
+	glViewport(0, 0, sideLength, sideLength);
+
+	if (pass != ShadowPass::DYNAMIC_CASTERS) glClear(GL_DEPTH_BUFFER_BIT);
 
 }
 
-void GL::OverheadShadowRenderer::setUpShadersForDrawing(bool isAnimated, bool isInstanced) { 
+bool GL::OverheadShadowRenderer::hasStaticLayer() const { return staticDepthArray; }
+
+void GL::OverheadShadowRenderer::setUpShadersForDrawing(bool isAnimated, bool isInstanced, bool hasInstancePoses) { 
 	
 	shadowRenderer_unis[isAnimated]->set("isInstanced", (isInstanced) ? 1 : 0);
+	shadowRenderer_unis[isAnimated]->set("hasInstancePoses", (hasInstancePoses) ? 1 : 0);
 	shadowRenderer_unis[isAnimated]->update();
 	shadowRenderer[isAnimated]->use();
 
@@ -162,26 +327,101 @@ void GL::OverheadShadowRenderer::calcPVMatrix(vec3 lightDir, BoundingBox sceneBB
 	vec3 up = normalize(orthogonalTo(lightDir));
 	r *= 2.0f; r_depth *= 2.0f;
 	
-	if (isOuter) {
+	unsigned int map = (isOuter) ? 1u : 0u;
+	farPlanes[map] = r_depth;
+	PVs[map] = ortho(vec2(r), r_depth) * lookAt(planeCenter, center, up);
+
+}
+
+void GL::OverheadShadowRenderer::calcCascadePVMatrices(vec3 lightDir, BoundingBox sceneBB, vec3 cameraPosition, vec3 lookingAt, vec3 up, float FoV, float aspectRatio, float zNear, float zFar) {
+
+	float n = zNear;
+	float f = (shadowDistance > 0.0f) ? min(shadowDistance, zFar) : zFar;
 
-		outerFarPlane = r_depth;
-		outerPV = ortho(vec2(r), r_depth) * lookAt(planeCenter, center, up);
+	for (unsigned int i = 0u; i <= numMaps; i++) {
+
+		float k = (float)i / (float)numMaps;
+		cascadeSplits[i] = splitLambda * n * std::pow(f / n, k) + (1.0f - splitLambda) * (n + (f - n) * k);
 
 	}
-	else {
 
-		farPlane = r_depth;
-		PV = ortho(vec2(r), r_depth) * lookAt(planeCenter, center, up);
+	mat3 cameraRot = cameraRotation(lookingAt - cameraPosition, up);
+	vec3 cameraRight = cameraRot[0], cameraUp = cameraRot[1], cameraForward = 0.0f - cameraRot[2];
+
+	vec3 lightUp = normalize(orthogonalTo(lightDir));
+	mat3 lightRot = transpose(cameraRotation(lightDir, lightUp));
+	mat3 lightRotInverse = transpose(lightRot);
+
+	vec3 sceneCorners[8];
+	for (unsigned int i = 0u; i < 8u; i++) sceneCorners[i] = vec3((i & 1u) ? sceneBB.end.x : sceneBB.start.x, (i & 2u) ? sceneBB.end.y : sceneBB.start.y, (i & 4u) ? sceneBB.end.z : sceneBB.start.z);
+
+	for (unsigned int i = 0u; i < numMaps; i++) {
+
+		vec3 corners[8];
+		vec3 center = vec3(0.0f);
+
+		for (unsigned int j = 0u; j < 2u; j++) {
+
+			float depth = cascadeSplits[i + j];
+			vec2 halfDims = getScreenDims(FoV, aspectRatio, depth) / 2.0f;
+			vec3 planeCenter = cameraPosition + cameraForward * depth;
+
+			for (unsigned int k = 0u; k < 4u; k++) {
+
+				corners[4u * j + k] = planeCenter + cameraRight * ((k & 1u) ? halfDims.x : -halfDims.x) + cameraUp * ((k & 2u) ? halfDims.y : -halfDims.y);
+				center += corners[4u * j + k] / 8.0f;
+
+			}
+
+		}
+
+		float r = 0.0f;
+		for (unsigned int j = 0u; j < 8u; j++) r = max(r, length(corners[j] - center));
+		r = std::ceil(r * 16.0f) / 16.0f;
+
+		float texelSize = 2.0f * r / (float)sideLength;
+		vec3 lightSpaceCenter = lightRot * center;
+		lightSpaceCenter = vec3(std::floor(lightSpaceCenter.x / texelSize), std::floor(lightSpaceCenter.y / texelSize), std::floor(lightSpaceCenter.z / texelSize)) * texelSize;
+		center = lightRotInverse * lightSpaceCenter;
+
+		float back = r;
+		for (unsigned int j = 0u; j < 8u; j++) back = max(back, dot(center - sceneCorners[j], lightDir));
+
+		farPlanes[i] = back + r;
+		PVs[i] = ortho(vec2(2.0f * r), farPlanes[i]) * lookAt(center - back * lightDir, center, lightUp);
 
 	}
 
 }
 
-GL::OverheadShadowRenderer::~OverheadShadowRenderer() { if (outerFb) { delete outerDepthTexture; delete outerFb; }; }
+GL::OverheadShadowRenderer::~OverheadShadowRenderer() {
+	
+	if (fbo) glDeleteFramebuffers(1, &fbo);
+	if (depthArray) glDeleteTextures(1, &depthArray);
+	if (staticDepthArray) glDeleteTextures(1, &staticDepthArray);
+
+}
+
+GLuint GL::OverheadShadowRenderer::createDepthArray(unsigned int sideLength, unsigned int numLayers) {
+
+	GLuint ID;
+	glGenTextures(1, &ID);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, ID);
+	glTexStorage3D(GL_TEXTURE_2D_ARRAY, 1, GL_DEPTH_COMPONENT32F, sideLength, sideLength, numLayers);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+	return ID;
+
+}
 
 const char* GL::ShadowRenderer::shadowRenderer_vs = \
 \
 "layout (location = 0) in vec3 inPos; \
+layout (location = 7) in vec4 positionOffset; \
+layout (location = 8) in vec4 positionScale; \
 \
 \n#ifdef ANIMATED\n \
 layout(location = 5) in ivec4 boneIndices; \
@@ -211,6 +451,9 @@ layout(std140, binding = 1) uniform boneData { \
 	mat3 boneNormalMatrices[64]; \
 	\
 }; \
+\
+layout(std430, binding = 5) buffer instanceBoneModelPalettes { mat4 instanceBoneModelMatrices[]; }; \
+uniform int hasInstancePoses; \
 \n#endif\n \
 \
 out vec3 pos; \
@@ -219,13 +462,13 @@ void main() { \
 	\
 	\n#ifdef ANIMATED\n \
 	mat4 boneModelMatrix = mat4(0.0f); \
-	for (uint i = 0u; i < 4u; i++) { boneModelMatrix += boneModelMatrices[boneIndices[i]] * boneWeights[i]; } \
+	for (uint i = 0u; i < 4u; i++) { boneModelMatrix += ((hasInstancePoses == 1) ? instanceBoneModelMatrices[gl_InstanceID * 64 + boneIndices[i]] : boneModelMatrices[boneIndices[i]]) * boneWeights[i]; } \
 	mat4 finalModelMatrix = modelMatrix * boneModelMatrix; \
 	\n#else\n \
 	mat4 finalModelMatrix = modelMatrix; \
 	\n#endif\n \
 	\
-	vec4 worldSpace = finalModelMatrix * vec4(inPos, 1.0f); \
+	vec4 worldSpace = finalModelMatrix * vec4(positionOffset.xyz + inPos * positionScale.xyz, 1.0f); \
 	pos = worldSpace.xyz; \
 	gl_Position = trans * worldSpace; \
 	\
@@ -233,9 +476,12 @@ void main() { \
 
 const char* GL::PointLightShadowRenderer::shadowRenderer_fs = \
 \
-"#version 430 core\n \
-\
+"\n#ifdef LAYERED\n \
+in vec3 layerPos; \
+\n#define pos layerPos\n \
+\n#else\n \
 in vec3 pos; \
+\n#endif\n \
 out vec4 dist; \
 \
 layout(std140, binding = 0) uniform PBR_inputs { \
@@ -253,4 +499,46 @@ uniform uint lightIdx; \
 \
 void main() { dist = vec4(length(pos - lightPositions[lightIdx])); dist.w = 1.0f; }";
 
+const char* GL::PointLightShadowRenderer::layeredShadowRenderer_gs = \
+\
+"#version 430 core\n \
+\
+layout(triangles) in; \
+layout(triangle_strip, max_vertices = 18) out; \
+\
+in vec3 pos[]; \
+out vec3 layerPos; \
+\
+uniform mat4 facePVs[6]; \
+\
+void main() { \
+	\
+	for (int face = 0; face < 6; face++) { \
+		\
+		vec4 clipPos[3]; \
+		for (int i = 0; i < 3; i++) clipPos[i] = facePVs[face] * vec4(pos[i], 1.0f); \
+		\
+		bool culled = false; \
+		for (int axis = 0; axis < 3; axis++) { \
+			\
+			if (clipPos[0][axis] > clipPos[0].w && clipPos[1][axis] > clipPos[1].w && clipPos[2][axis] > clipPos[2].w) culled = true; \
+			if (clipPos[0][axis] < -clipPos[0].w && clipPos[1][axis] < -clipPos[1].w && clipPos[2][axis] < -clipPos[2].w) culled = true; \
+			\
+		} \
+		if (culled) continue; \
+		\
+		for (int i = 0; i < 3; i++) { \
+			\
+			gl_Layer = face; \
+			gl_Position = clipPos[i]; \
+			layerPos = pos[i]; \
+			EmitVertex(); \
+			\
+		} \
+		EndPrimitive(); \
+		\
+	} \
+	\
+}";
+
 const char* GL::OverheadShadowRenderer::shadowRenderer_fs = "#version 430 core\n in vec3 pos; void main(){}";
\ No newline at end of file
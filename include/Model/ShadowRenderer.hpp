@@ -11,9 +11,17 @@
 #include "./../Uniform/UniformBufferTable.hpp"
 #include "./ModelStructs.hpp"
 
+#define _GL_OverheadShadowRenderer_maxMaps 8u
+
 namespace GL {
 
+	enum class ShadowPass { ALL_CASTERS, STATIC_CASTERS, DYNAMIC_CASTERS };
+
 	class ShadowRenderer : public _util {
+	public:
+
+		virtual void setUpShadersForDrawing(bool isAnimated, bool isInstanced, bool hasInstancePoses) = 0;
+
 	protected:
 
 		static const char* shadowRenderer_vs;
@@ -32,9 +40,15 @@ namespace GL {
 
 		void bindTextures();
 
-		void setUpFaceForDrawing(unsigned int face);
+		void setUpFaceForDrawing(unsigned int face, ShadowPass pass = ShadowPass::ALL_CASTERS);
 
-		void setUpShadersForDrawing(bool isAnimated, bool isInstanced);
+		void setUpLayersForDrawing(vec3 lightPos, float zFar, ShadowPass pass = ShadowPass::ALL_CASTERS);
+
+		bool isLayered() const;
+
+		bool hasStaticLayer() const;
+
+		void setUpShadersForDrawing(bool isAnimated, bool isInstanced, bool hasInstancePoses);
 
 		~PointLightShadowRenderer();
 
@@ -47,10 +61,23 @@ namespace GL {
 		GLuint fbo = 0u;
 		unsigned int lightIndex;
 
+		bool layered;
+		GLuint depthCubeMap = 0u;
+		mat4 facePVs[6];
+
+		ImageTextureCubeMap* staticCubeMap = nullptr;
+		GLuint staticDepthCubeMap = 0u;
+
 		static Program* shadowRenderer[2];
 		static UniformTable* shadowRenderer_unis[2];	
 		static const char* shadowRenderer_fs;
 
+		static Program* layeredShadowRenderer[2];
+		static UniformTable* layeredShadowRenderer_unis[2];
+		static const char* layeredShadowRenderer_gs;
+
+		static GLuint createDepthCubeMap(unsigned int sideLength);
+
 	};
 
 	class OverheadShadowRenderer : public ShadowRenderer {
@@ -60,35 +87,48 @@ namespace GL {
 
 		bool isFancy();
 
+		bool isCascaded() const;
+
+		unsigned int getNumMaps() const;
+
 		void bindTextures();
 
-		void setUpForDrawing(bool outerBuffer);
+		void setUpForDrawing(unsigned int map, ShadowPass pass = ShadowPass::ALL_CASTERS);
+
+		bool hasStaticLayer() const;
 
-		void setUpShadersForDrawing(bool isAnimated, bool isInstanced);
+		void setUpShadersForDrawing(bool isAnimated, bool isInstanced, bool hasInstancePoses);
 		
 		void calcPVMatrix(vec3 lightDir, BoundingBox sceneBB, BoundingBox* outerBB, bool isOuter);
 
+		// Splits the camera frustum between zNear and the shadow distance into cascades with the practical split scheme, each fitted
+		// by its bounding sphere and snapped to whole texels so the maps do not shimmer when the camera moves. sceneBB bounds the casters.
+		void calcCascadePVMatrices(vec3 lightDir, BoundingBox sceneBB, vec3 cameraPosition, vec3 lookingAt, vec3 up, float FoV, float aspectRatio, float zNear, float zFar);
+
 		~OverheadShadowRenderer();
 
-		mat4 PV;
-		float farPlane;
-		
-		mat4 outerPV;
-		float outerFarPlane;
+		mat4 PVs[_GL_OverheadShadowRenderer_maxMaps];
+		float farPlanes[_GL_OverheadShadowRenderer_maxMaps];
+		float cascadeSplits[_GL_OverheadShadowRenderer_maxMaps + 1u];
 
 	protected:
 
-		Framebuffer fb;
-		DepthStencilRenderTexture depthTexture;
-		Framebuffer* outerFb = nullptr;
-		DepthStencilRenderTexture* outerDepthTexture;
-
-		vec3 frustumEndpoints[5];
+		GLuint fbo = 0u;
+		GLuint depthArray = 0u;
+		GLuint staticDepthArray = 0u;
+		unsigned int sideLength;
+		unsigned int numMaps;
+		bool fancy;
+		bool cascaded;
+		float splitLambda;
+		float shadowDistance;
 
 		static Program* shadowRenderer[2];
 		static UniformTable* shadowRenderer_unis[2];
 		static const char* shadowRenderer_fs;
 
+		static GLuint createDepthArray(unsigned int sideLength, unsigned int numLayers);
+
 	};
 
 }
@@ -0,0 +1,226 @@
+#include "./SkinnedVertexBuffer.hpp"
+
+GL::Program* GL::SkinnedVertexBuffer::program = nullptr;
+
+GL::UniformTable* GL::SkinnedVertexBuffer::uniforms = nullptr;
+
+GL::SkinnedVertexBuffer::SkinnedVertexBuffer(const GL::Model_types::ModelData& data) {
+
+	if (!program) {
+
+		ShaderLoader skinningShader(ShaderType::COMPUTE);
+		skinningShader.init(skinning_cs, false);
+
+		program = new Program();
+		program->init(skinningShader);
+
+		uniforms = new UniformTable(*program);
+		uniforms->init(
+			"numVertices", UniformType::UINT, 1u,
+			"firstWord", UniformType::UINT, 1u,
+			"vertexWords", UniformType::UINT, 1u,
+			"normalWord", UniformType::UINT, 1u,
+			"tangentWord", UniformType::UINT, 1u,
+			"boneWord", UniformType::UINT, 1u,
+			"compact", UniformType::INT, 1u,
+			"hasNormalMap", UniformType::INT, 1u,
+			"positionOffset", UniformType::VEC3, 1u,
+			"positionScale", UniformType::VEC3, 1u
+		);
+
+	}
+
+	numMeshes = data.numMeshes;
+	buffers = new GLuint[numMeshes]();
+	vaos = new GLuint[numMeshes]();
+
+	for (unsigned int i = 0u; i < numMeshes; i++) {
+
+		if (!data.vaos[i]) continue;
+
+		const Model_types::VertexLayout& layout = data.vertexLayouts[i];
+		bool compact = data.quantization[i].compact;
+		unsigned int skinnedSize = ((layout.hasNormalMap) ? 4u : 2u) * sizeof(vec4);
+
+		glGenBuffers(1, &buffers[i]);
+		glBindBuffer(GL_ARRAY_BUFFER, buffers[i]);
+		glBufferData(GL_ARRAY_BUFFER, layout.numVertices * skinnedSize, nullptr, GL_DYNAMIC_COPY);
+
+		glGenVertexArrays(1, &vaos[i]);
+		glBindVertexArray(vaos[i]);
+
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, skinnedSize, (void*)0);
+		glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, skinnedSize, (void*)sizeof(vec4));
+		glEnableVertexAttribArray(0);
+		glEnableVertexAttribArray(1);
+
+		if (layout.hasNormalMap) {
+
+			glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, skinnedSize, (void*)(2u * sizeof(vec4)));
+			glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, skinnedSize, (void*)(3u * sizeof(vec4)));
+			glEnableVertexAttribArray(3);
+			glEnableVertexAttribArray(4);
+
+		}
+
+		// Texture coordinates are not skinned and are read from the model's own vertices.
+		if (layout.hasTextures) {
+
+			size_t texCoordOffset = layout.baseOffset + ((compact) ? 4u * sizeof(unsigned short) + 2u * sizeof(short) : 2u * sizeof(vec3));
+			glBindBuffer(GL_ARRAY_BUFFER, data.vbos[i]);
+			glVertexAttribPointer(2, 2, (compact) ? GL_HALF_FLOAT : GL_FLOAT, GL_FALSE, layout.vertexSize, (void*)texCoordOffset);
+			glEnableVertexAttribArray(2);
+
+		}
+
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, data.ebos[i]);
+		glBindVertexArray(0);
+
+	}
+
+}
+
+void GL::SkinnedVertexBuffer::skin(const GL::Model_types::ModelData& data) {
+
+	// Skinning can happen in the middle of a shadow pass, so the program of the pass is restored afterwards.
+	GLint currentProgram;
+	glGetIntegerv(GL_CURRENT_PROGRAM, &currentProgram);
+
+	for (unsigned int i = 0u; i < numMeshes; i++) {
+
+		if (!buffers[i]) continue;
+
+		const Model_types::VertexLayout& layout = data.vertexLayouts[i];
+		bool compact = data.quantization[i].compact;
+		unsigned int positionWords = (compact) ? 2u : 3u;
+		unsigned int directionWords = (compact) ? 1u : 3u;
+		unsigned int texCoordWords = (layout.hasTextures) ? ((compact) ? 1u : 2u) : 0u;
+
+		uniforms->set("numVertices", layout.numVertices);
+		uniforms->set("firstWord", (unsigned int)(layout.baseOffset / sizeof(GLuint)));
+		uniforms->set("vertexWords", layout.vertexSize / (unsigned int)sizeof(GLuint));
+		uniforms->set("normalWord", positionWords);
+		uniforms->set("tangentWord", positionWords + directionWords + texCoordWords);
+		uniforms->set("boneWord", positionWords + directionWords + texCoordWords + ((layout.hasNormalMap) ? 2u * directionWords : 0u));
+		uniforms->set("compact", (compact) ? 1 : 0);
+		uniforms->set("hasNormalMap", (layout.hasNormalMap) ? 1 : 0);
+		uniforms->set("positionOffset", data.quantization[i].positionOffset);
+		uniforms->set("positionScale", data.quantization[i].positionScale);
+		uniforms->update();
+
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, _GL_SkinnedVertexBuffer_sourceBinding, data.vbos[i]);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, _GL_SkinnedVertexBuffer_destinationBinding, buffers[i]);
+
+		program->dispatchCompute(uvec3((layout.numVertices + _GL_SkinnedVertexBuffer_groupSize - 1u) / _GL_SkinnedVertexBuffer_groupSize, 1u, 1u), false);
+
+	}
+
+	glMemoryBarrier(GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT);
+	glUseProgram(currentProgram);
+
+}
+
+GLuint GL::SkinnedVertexBuffer::getVertexArray(unsigned int mesh) const { return vaos[mesh]; }
+
+GL::SkinnedVertexBuffer::~SkinnedVertexBuffer() {
+
+	for (unsigned int i = 0u; i < numMeshes; i++) if (buffers[i]) {
+
+		glDeleteBuffers(1, &buffers[i]);
+		glDeleteVertexArrays(1, &vaos[i]);
+
+	}
+
+	delete[] buffers;
+	delete[] vaos;
+
+}
+
+const char* GL::SkinnedVertexBuffer::skinning_cs = \
+\
+"#version 430 core\n \
+\
+layout(local_size_x = 64) in; \
+\
+layout(std430, binding = 4) readonly buffer sourceVertices { uint words[]; }; \
+layout(std430, binding = 7) writeonly buffer skinnedVertices { vec4 skinned[]; }; \
+\
+layout(std140, binding = 1) uniform boneData { \
+	\
+	mat4 boneModelMatrices[64]; \
+	mat3 boneNormalMatrices[64]; \
+	\
+}; \
+\
+uniform uint numVertices; \
+uniform uint firstWord; \
+uniform uint vertexWords; \
+uniform uint normalWord; \
+uniform uint tangentWord; \
+uniform uint boneWord; \
+uniform int compact; \
+uniform int hasNormalMap; \
+uniform vec3 positionOffset; \
+uniform vec3 positionScale; \
+\
+vec3 readPosition(uint word) { \
+	\
+	if (compact == 0) return uintBitsToFloat(uvec3(words[word], words[word + 1u], words[word + 2u])); \
+	return positionOffset + vec3(unpackUnorm2x16(words[word]), unpackUnorm2x16(words[word + 1u]).x) * positionScale; \
+	\
+} \
+\
+vec3 readDirection(uint word) { \
+	\
+	if (compact == 0) return uintBitsToFloat(uvec3(words[word], words[word + 1u], words[word + 2u])); \
+	vec2 direction = unpackSnorm2x16(words[word]); \
+	vec3 n = vec3(direction, 1.0f - abs(direction.x) - abs(direction.y)); \
+	float t = max(-n.z, 0.0f); \
+	n.xy += vec2((n.x >= 0.0f) ? -t : t, (n.y >= 0.0f) ? -t : t); \
+	return normalize(n); \
+	\
+} \
+\
+void main() { \
+	\
+	uint vertex = gl_GlobalInvocationID.x; \
+	if (vertex >= numVertices) return; \
+	uint word = firstWord + vertex * vertexWords; \
+	\
+	ivec4 boneIndices; \
+	vec4 boneWeights; \
+	if (compact == 0) { \
+		\
+		boneIndices = ivec4(words[word + boneWord], words[word + boneWord + 1u], words[word + boneWord + 2u], words[word + boneWord + 3u]); \
+		boneWeights = uintBitsToFloat(uvec4(words[word + boneWord + 4u], words[word + boneWord + 5u], words[word + boneWord + 6u], words[word + boneWord + 7u])); \
+		\
+	} \
+	else { \
+		\
+		uint packedIndices = words[word + boneWord]; \
+		boneIndices = ivec4(packedIndices & 255u, (packedIndices >> 8u) & 255u, (packedIndices >> 16u) & 255u, packedIndices >> 24u); \
+		boneWeights = unpackUnorm4x8(words[word + boneWord + 1u]); \
+		\
+	} \
+	\
+	mat4 boneModelMatrix = mat4(0.0f); \
+	mat3 boneNormalMatrix = mat3(0.0f); \
+	for (uint i = 0u; i < 4u; i++) { \
+		\
+		boneModelMatrix += boneModelMatrices[boneIndices[i]] * boneWeights[i]; \
+		boneNormalMatrix += boneNormalMatrices[boneIndices[i]] * boneWeights[i]; \
+		\
+	} \
+	\
+	uint destination = vertex * ((hasNormalMap == 1) ? 4u : 2u); \
+	skinned[destination] = boneModelMatrix * vec4(readPosition(word), 1.0f); \
+	skinned[destination + 1u] = vec4(boneNormalMatrix * readDirection(word + normalWord), 0.0f); \
+	\
+	if (hasNormalMap == 1) { \
+		\
+		skinned[destination + 2u] = vec4(boneNormalMatrix * readDirection(word + tangentWord), 0.0f); \
+		skinned[destination + 3u] = vec4(boneNormalMatrix * readDirection(word + tangentWord + ((compact == 0) ? 3u : 1u)), 0.0f); \
+		\
+	} \
+	\
+}";
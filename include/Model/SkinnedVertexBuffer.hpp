@@ -0,0 +1,44 @@
+#ifndef SKINNEDVERTEXBUFFER_HPP
+#define SKINNEDVERTEXBUFFER_HPP
+
+#include "./../util/util.hpp"
+#include "./../Program/Program.hpp"
+#include "./../Uniform/UniformTable.hpp"
+#include "./Model_types.hpp"
+
+#define _GL_SkinnedVertexBuffer_groupSize 64u
+#define _GL_SkinnedVertexBuffer_sourceBinding 4u
+#define _GL_SkinnedVertexBuffer_destinationBinding 7u
+
+namespace GL {
+
+	// Holds the vertices of an animated model skinned by a compute shader with the bone palette currently in the bone uniform
+	// buffer. The skinned positions, normals and tangents are stored as floats in model space, so every pass of a frame can draw
+	// them with the non-animated shaders.
+	class SkinnedVertexBuffer : public _util {
+	public:
+
+		SkinnedVertexBuffer(const Model_types::ModelData& data);
+
+		void skin(const Model_types::ModelData& data);
+
+		GLuint getVertexArray(unsigned int mesh) const;
+
+		~SkinnedVertexBuffer();
+
+	private:
+
+		unsigned int numMeshes;
+		GLuint* buffers;
+		GLuint* vaos;
+
+		static Program* program;
+		static UniformTable* uniforms;
+
+		static const char* skinning_cs;
+
+	};
+
+}
+
+#endif
@@ -3,7 +3,7 @@
 
 GL::VertexStructRepresentation::VertexStructRepresentation() { } 
 
-GL::VertexStructRepresentation::VertexStructRepresentation(bool usesTextures, bool usesNormalMap, bool usesAnimations) { 
+GL::VertexStructRepresentation::VertexStructRepresentation(bool usesTextures, bool usesNormalMap, bool usesAnimations, bool compact) : compact(compact) { 
     
     for (int i = 0; i < 7; i++) componentIndices[i] = -1; 
     
@@ -41,6 +41,14 @@ bool GL::VertexStructRepresentation::hasComponent(ComponentType type) {
 
 unsigned int GL::VertexStructRepresentation::getComponentSize(ComponentType type) { 
     
+    if (compact) { 
+        
+        if (type == POSITION) return 4u * sizeof(unsigned short); 
+        if (type == BONE_INDICES || type == BONE_WEIGHTS) return 4u * sizeof(unsigned char); 
+        return 2u * sizeof(unsigned short); 
+        
+    } 
+    
     unsigned int numComps = type == TEX_COORDS ? 2u : (type == BONE_INDICES || type == BONE_WEIGHTS ? 4u : 3u); 
     return numComps * sizeof(float); 
     
@@ -11,13 +11,14 @@ namespace GL {
 		
 		VertexStructRepresentation();
 		
-		VertexStructRepresentation(bool usesTextures, bool usesNormalMap, bool usesAnimations);
+		VertexStructRepresentation(bool usesTextures, bool usesNormalMap, bool usesAnimations, bool compact = false);
 		
 		unsigned int getComponentOffset(ComponentType type); 
 		
 		bool hasComponent(ComponentType type);
 		
 		unsigned int dataSize = 0u; 
+		bool compact = false; 
 		
 	private: 
 		
@@ -25,7 +26,7 @@ namespace GL {
 		unsigned int componentOffsets[7]; 
 		int componentIndices[7]; 
 		
-		static unsigned int getComponentSize(ComponentType type);
+		unsigned int getComponentSize(ComponentType type);
 		
 		void addComponent(ComponentType type); 
 		
@@ -28,7 +28,7 @@ GL::ShaderType GL::ShaderLoader::getType() const { return sType; }
 
 void GL::ShaderLoader::compile(char** shaderSource, unsigned int num) {
 	
-	static const GLenum shaderTypes[] = { GL_VERTEX_SHADER, GL_FRAGMENT_SHADER, GL_COMPUTE_SHADER };
+	static const GLenum shaderTypes[] = { GL_VERTEX_SHADER, GL_FRAGMENT_SHADER, GL_COMPUTE_SHADER, GL_GEOMETRY_SHADER };
 	GLenum shaderType = shaderTypes[(int)sType];
 
 	ID = glCreateShader(shaderType);
@@ -11,6 +11,7 @@
 #include "Framebuffer/RenderTexture.hpp"
 
 #include "Model/Model.hpp"
+#include "Model/ModelLoader.hpp"
 #include "Model/Scene.hpp"
 
 #ifndef SmartGL_NO_PHYSICS
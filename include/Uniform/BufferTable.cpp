@@ -1,12 +1,7 @@
 
 #include "./BufferTable.hpp"
 
-void GL::BufferTable::bind() const {
-
-	glBindBuffer(bufferType, ID);
-	glBindBufferBase(bufferType, bindingPoint, ID);
-
-}
+void GL::BufferTable::bind() const { bindToIndex(bindingPoint); }
 
 void GL::BufferTable::bindToIndex(unsigned int idx) const {
 
@@ -14,7 +9,8 @@ void GL::BufferTable::bindToIndex(unsigned int idx) const {
 	if (idx >= maxBindings) throw Exception("Attempt to bind BufferTable to index " + std::to_string(idx) + ", but the maximum allowed binding point is " + std::to_string(maxBindings) + ".");
 
 	glBindBuffer(bufferType, ID);
-	glBindBufferBase(bufferType, idx, ID);
+	if (streaming) glBindBufferRange(bufferType, idx, ID, streamingOffset, dataSize);
+	else glBindBufferBase(bufferType, idx, ID);
 
 }
 
@@ -22,6 +18,7 @@ void GL::BufferTable::update() {
 
 	if (!isInitialized()) throw Exception("Attempt to call the update function in an uninitialized buffer table.");
 	if (first) return;
+	if (streaming) { updateStreaming(); return; }
 
 	bind();
 	if (bufferNeedsAlloc) { glBufferData(bufferType, dataSize, nullptr, GL_DYNAMIC_DRAW); bufferNeedsAlloc = false; }
@@ -30,36 +27,204 @@ void GL::BufferTable::update() {
 
 }
 
-GL::BufferTable::~BufferTable() { if (ID) glDeleteBuffers(1, &ID); }
+void GL::BufferTable::updateElements(const char* name, const GL::uvec2* ranges, unsigned int numRanges) {
 
-GL::BufferTable::BufferTable(unsigned int bindingPoint, GLenum bufferType) : bindingPoint(bindingPoint), bufferType(bufferType) {
+	if (!isInitialized()) throw Exception("Attempt to call the updateElements function in an uninitialized buffer table.");
 
-	int maxBindings = (bufferType == GL_UNIFORM_BUFFER) ? _util::maxUniformBufferBindings : _util::maxShaderBufferBindings;
-	if (bindingPoint >= maxBindings) throw Exception("Buffer binding point supplied was " + std::to_string(bindingPoint) + ", but the maximum allowed binding point is " + std::to_string(maxBindings) + ".");
+	unsigned int idx = getset_getIndex(name);
+	if (idx == numUniforms) throw Exception("Invalid variable name \"" + std::string(name) + "\" passed to buffer table's updateElements function.");
+
+	for (unsigned int i = 0u; i < numRanges; i++) if (ranges[i].x + ranges[i].y > numElements[idx]) throw Exception("Invalid element range (" + std::to_string(ranges[i].x) + ", " + std::to_string(ranges[i].y) + ") passed to buffer table's updateElements function (variable name passed was \"" + std::string(name) + "\").");
+
+	if (first) return;
+	if (streaming) { updateStreaming(); return; }
+
+	bind();
+	if (bufferNeedsAlloc) { glBufferData(bufferType, dataSize, data, GL_DYNAMIC_DRAW); bufferNeedsAlloc = false; }
+	else for (unsigned int i = 0u; i < numRanges; i++) {
+
+		unsigned int start = offsets[idx] + strides[idx] * ranges[i].x;
+		glBufferSubData(bufferType, start, strides[idx] * ranges[i].y, data + start);
+
+	}
+	first = true;
+
+}
+
+unsigned char* GL::BufferTable::getElementData(const char* name) {
+
+	if (!isInitialized()) throw Exception("Attempt to get the data of the variable \"" + std::string(name) + "\" from an uninitialized buffer table.");
+
+	unsigned int idx = getset_getIndex(name);
+	if (idx == numUniforms) throw Exception("Invalid variable name \"" + std::string(name) + "\" passed to buffer table's getElementData function.");
+
+	return data + offsets[idx];
+
+}
+
+unsigned int GL::BufferTable::getElementStride(const char* name) const {
 
+	if (!isInitialized()) throw Exception("Attempt to get the stride of the variable \"" + std::string(name) + "\" from an uninitialized buffer table.");
+
+	unsigned int idx = getset_getIndex(name);
+	if (idx == numUniforms) throw Exception("Invalid variable name \"" + std::string(name) + "\" passed to buffer table's getElementStride function.");
+
+	return strides[idx];
+
+}
+
+void GL::BufferTable::markElementsAsChanged(const char* name, unsigned int first, unsigned int count) {
+
+	if (!isInitialized()) throw Exception("Attempt to mark elements of the variable \"" + std::string(name) + "\" as changed in an uninitialized buffer table.");
+
+	unsigned int idx = getset_getIndex(name);
+	if (idx == numUniforms) throw Exception("Invalid variable name \"" + std::string(name) + "\" passed to buffer table's markElementsAsChanged function.");
+	if (first + count > numElements[idx]) throw Exception("Invalid element range (" + std::to_string(first) + ", " + std::to_string(count) + ") passed to buffer table's markElementsAsChanged function (variable name passed was \"" + std::string(name) + "\").");
+
+	if (count) markAsChanged(offsets[idx] + strides[idx] * first, offsets[idx] + strides[idx] * (first + count) - 1u);
+
+}
+
+void GL::BufferTable::markAsChanged(unsigned int start, unsigned int end) {
+
+	if (first) {
+
+		s = start; e = end;
+		first = false;
+
+	}
+	else {
+
+		if (start < s) s = start;
+		if (end > e) e = end;
+
+	}
+
+}
+
+void GL::BufferTable::useStreaming(bool use, unsigned int regionSize) {
+
+	if (!isInitialized()) throw Exception("Attempt to change the streaming mode of an uninitialized buffer table.");
+	if (use && !isStreamingSupported()) throw Exception("Streaming buffer tables need OpenGL 4.4 or the GL_ARB_buffer_storage extension.");
+	if (use && regionSize == 0u) throw Exception("The region size of a streaming buffer table must be greater than zero.");
+	if (use == streaming && (!use || regionSize == streamingRegionSize)) return;
+	if (use && (unsigned long long)getStreamingStride() * regionSize * _GL_BufferTable_numStreamingRegions > _GL_BufferTable_maxStreamingBytes)
+		throw Exception("The ring buffer of a streaming buffer table would take " + std::to_string((unsigned long long)getStreamingStride() * regionSize * _GL_BufferTable_numStreamingRegions) + " bytes, use a smaller region size or a non-streaming table.");
+
+	// Buffer storage is immutable, so switching modes always starts over with a new buffer holding the whole table.
+	releaseStreaming();
+	glDeleteBuffers(1, &ID);
 	glGenBuffers(1, &ID);
+	bufferNeedsAlloc = true;
+	streaming = use;
 
-	std140 = (bufferType == GL_UNIFORM_BUFFER);
-	std430 = !std140;
+	if (use) {
+
+		streamingStride = getStreamingStride();
+		streamingRegionSize = regionSize;
+		streamingSlot = 0u;
+		streamingOffset = 0u;
+
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		GLsizeiptr size = (GLsizeiptr)streamingStride * streamingRegionSize * _GL_BufferTable_numStreamingRegions;
+
+		glBindBuffer(bufferType, ID);
+		glBufferStorage(bufferType, size, nullptr, flags);
+		streamingData = (unsigned char*)glMapBufferRange(bufferType, 0, size, flags);
+		if (!streamingData) throw Exception("Failed to map the ring buffer of a streaming buffer table.");
+		bufferNeedsAlloc = false;
+
+	}
+
+	markAsChanged(0u, dataSize - 1u);
+
+}
+
+bool GL::BufferTable::usesStreaming() const { return streaming; }
+
+unsigned int GL::BufferTable::getStreamingStride() const {
+
+	GLint alignment = (bufferType == GL_UNIFORM_BUFFER) ? _util::uniformBufferOffsetAlignment : _util::shaderBufferOffsetAlignment;
+	if (alignment <= 0) alignment = 1;
+
+	return ((dataSize + alignment - 1u) / alignment) * alignment;
 
 }
 
-unsigned int GL::BufferTable::getset_getIndex(const char* name) const {
+bool GL::BufferTable::isStreamingSupported() { return _util::hasBufferStorage; }
+
+void GL::BufferTable::updateStreaming() {
 
-	unsigned int idx = numUniforms;
-	for (unsigned int i = 0u; i < numUniforms; i++)
+	unsigned int region = streamingSlot / streamingRegionSize;
 
-		if (!strcmp(name, uniforms[i])) {
+	if (streamingSlot % streamingRegionSize == 0u) {
 
-			idx = i;
-			break;
+		// Everything reading the previous region has been issued by now.
+		unsigned int previousRegion = (region + _GL_BufferTable_numStreamingRegions - 1u) % _GL_BufferTable_numStreamingRegions;
+		if (!streamingFences[previousRegion]) streamingFences[previousRegion] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+		if (streamingFences[region]) {
+
+			GLenum result;
+			do result = glClientWaitSync(streamingFences[region], GL_SYNC_FLUSH_COMMANDS_BIT, _GL_BufferTable_streamingWaitTimeout);
+			while (result == GL_TIMEOUT_EXPIRED);
+
+			glDeleteSync(streamingFences[region]);
+			streamingFences[region] = nullptr;
 
 		}
-	
-	return idx;
+
+	}
+
+	streamingOffset = streamingSlot * streamingStride;
+	std::memcpy(streamingData + streamingOffset, data, dataSize);
+	streamingSlot = (streamingSlot + 1u) % (streamingRegionSize * _GL_BufferTable_numStreamingRegions);
+
+	bind();
+	first = true;
+
+}
+
+void GL::BufferTable::releaseStreaming() {
+
+	for (unsigned int i = 0u; i < _GL_BufferTable_numStreamingRegions; i++) if (streamingFences[i]) {
+
+		glDeleteSync(streamingFences[i]);
+		streamingFences[i] = nullptr;
+
+	}
+
+	if (streamingData) {
+
+		glBindBuffer(bufferType, ID);
+		glUnmapBuffer(bufferType);
+		streamingData = nullptr;
+
+	}
 
 }
 
+GL::BufferTable::~BufferTable() {
+
+	releaseStreaming();
+	if (ID) glDeleteBuffers(1, &ID);
+
+}
+
+GL::BufferTable::BufferTable(unsigned int bindingPoint, GLenum bufferType) : bindingPoint(bindingPoint), bufferType(bufferType) {
+
+	int maxBindings = (bufferType == GL_UNIFORM_BUFFER) ? _util::maxUniformBufferBindings : _util::maxShaderBufferBindings;
+	if (bindingPoint >= maxBindings) throw Exception("Buffer binding point supplied was " + std::to_string(bindingPoint) + ", but the maximum allowed binding point is " + std::to_string(maxBindings) + ".");
+
+	glGenBuffers(1, &ID);
+
+	std140 = (bufferType == GL_UNIFORM_BUFFER);
+	std430 = !std140;
+
+}
+
+unsigned int GL::BufferTable::getset_getIndex(const char* name) const { return findUniform(name); }
+
 #define _GL_BufferTable_get_commonCode_specialization(T) \
 template <> \
 T GL::BufferTable::get_commonCode<T>(unsigned int idx, unsigned int index) const { \
@@ -5,6 +5,11 @@
 
 #include "./ProgramUniforms.hpp"
 
+#define _GL_BufferTable_numStreamingRegions 3u
+#define _GL_BufferTable_streamingRegionSize 256u
+#define _GL_BufferTable_streamingWaitTimeout 1000000000ull
+#define _GL_BufferTable_maxStreamingBytes (32u << 20)
+
 namespace GL {
 
 	class BufferTable : public ProgramUniforms {
@@ -26,8 +31,51 @@ namespace GL {
 		template <typename T>
 		void setElement(const char* name, unsigned int index, T value);
 
+		template <typename T>
+		UniformHandle<T> handle(const char* name) const;
+
+		template <typename T>
+		T get(UniformHandle<T> handle) const;
+
+		template <typename T>
+		void set(UniformHandle<T> handle, typename UniformHandle<T>::Type value);
+
+		template <typename T>
+		T getElement(UniformHandle<T> handle, unsigned int index) const;
+
+		template <typename T>
+		void setElement(UniformHandle<T> handle, unsigned int index, typename UniformHandle<T>::Type value);
+
 		void update();
 
+		// Uploads only the element ranges (first, count) of the array name, all changes since the last update must lie inside them.
+		void updateElements(const char* name, const uvec2* ranges, unsigned int numRanges);
+
+		// Direct access to the storage of the array name, whose elements are getElementStride bytes apart.
+		// Elements written through it must be passed to markElementsAsChanged before the next update.
+		unsigned char* getElementData(const char* name);
+
+		unsigned int getElementStride(const char* name) const;
+
+		void markElementsAsChanged(const char* name, unsigned int first, unsigned int count);
+
+		template <typename T>
+		unsigned char* getElementData(UniformHandle<T> handle);
+
+		template <typename T>
+		void markElementsAsChanged(UniformHandle<T> handle, unsigned int first, unsigned int count);
+
+		// In streaming mode every update writes the whole table to the next slot of a persistently mapped ring buffer and binds
+		// only that slot, so draws still reading an earlier update never make the driver stall. The ring is split into regions of
+		// regionSize slots, a region is reused only after the GPU has passed a fence placed when the next region was started.
+		// The ring takes 3 * regionSize copies of the table (rounded up to the buffer offset alignment) and every update copies the
+		// whole table, so streaming is meant for small, frequently changed tables. Rings above _GL_BufferTable_maxStreamingBytes are rejected.
+		void useStreaming(bool use, unsigned int regionSize = _GL_BufferTable_streamingRegionSize);
+
+		bool usesStreaming() const;
+
+		static bool isStreamingSupported();
+
 		~BufferTable();
 
 	protected:
@@ -36,6 +84,14 @@ namespace GL {
 		GLenum bufferType;
 		bool bufferNeedsAlloc = true;
 
+		bool streaming = false;
+		unsigned char* streamingData = nullptr;
+		unsigned int streamingStride = 0u;
+		unsigned int streamingRegionSize = 0u;
+		unsigned int streamingSlot = 0u;
+		unsigned int streamingOffset = 0u;
+		GLsync streamingFences[_GL_BufferTable_numStreamingRegions] = { };
+
 		BufferTable(unsigned int bindingPoint, GLenum bufferType);
 
 		unsigned int getset_getIndex(const char* name) const;
@@ -48,6 +104,14 @@ namespace GL {
 
 		unsigned int getMatrixStride(UniformType type) const;
 
+		void markAsChanged(unsigned int start, unsigned int end);
+
+		unsigned int getStreamingStride() const;
+
+		void updateStreaming();
+
+		void releaseStreaming();
+
 	};
 
 }
@@ -110,6 +174,78 @@ void GL::BufferTable::setElement(const char* name, unsigned int index, T value)
 
 }
 
+template <typename T>
+GL::UniformHandle<T> GL::BufferTable::handle(const char* name) const {
+
+	if (!isInitialized()) throw Exception("Attempt to get a handle to the variable \"" + std::string(name) + "\" from an uninitialized buffer table.");
+
+	unsigned int idx = getset_getIndex(name);
+
+	if (idx == numUniforms) throw Exception("Invalid variable name \"" + std::string(name) + "\" passed to buffer table's handle function.");
+	if (!typeIsValid<T>(types[idx])) throw Exception("Invalid data type passed to buffer table's handle function (variable name passed was \"" + std::string(name) + "\").");
+
+	UniformHandle<T> ret;
+	ret.owner = this;
+	ret.index = idx;
+	return ret;
+
+}
+
+template <typename T>
+T GL::BufferTable::get(GL::UniformHandle<T> handle) const {
+
+	_GL_UniformHandle_check(handle, get);
+
+	return get_commonCode<T>(handle.index, 0u);
+
+}
+
+template <typename T>
+void GL::BufferTable::set(GL::UniformHandle<T> handle, typename GL::UniformHandle<T>::Type value) {
+
+	_GL_UniformHandle_check(handle, set);
+
+	set_commonCode<T>(handle.index, 0u, value);
+
+}
+
+template <typename T>
+T GL::BufferTable::getElement(GL::UniformHandle<T> handle, unsigned int index) const {
+
+	_GL_UniformHandle_checkElement(handle, index, getElement);
+
+	return get_commonCode<T>(handle.index, index);
+
+}
+
+template <typename T>
+void GL::BufferTable::setElement(GL::UniformHandle<T> handle, unsigned int index, typename GL::UniformHandle<T>::Type value) {
+
+	_GL_UniformHandle_checkElement(handle, index, setElement);
+
+	set_commonCode<T>(handle.index, index, value);
+
+}
+
+template <typename T>
+unsigned char* GL::BufferTable::getElementData(GL::UniformHandle<T> handle) {
+
+	_GL_UniformHandle_check(handle, getElementData);
+
+	return data + offsets[handle.index];
+
+}
+
+template <typename T>
+void GL::BufferTable::markElementsAsChanged(GL::UniformHandle<T> handle, unsigned int first, unsigned int count) {
+
+	_GL_UniformHandle_check(handle, markElementsAsChanged);
+	if (first + count > numElements[handle.index]) throw Exception("Invalid element range (" + std::to_string(first) + ", " + std::to_string(count) + ") passed to buffer table's markElementsAsChanged function (variable name was \"" + std::string(uniforms[handle.index]) + "\").");
+
+	if (count) markAsChanged(offsets[handle.index] + strides[handle.index] * first, offsets[handle.index] + strides[handle.index] * (first + count) - 1u);
+
+}
+
 template <typename T>
 T GL::BufferTable::get_commonCode(unsigned int idx, unsigned int index) const {
 
@@ -260,18 +396,7 @@ void GL::BufferTable::set_commonCode(unsigned int idx, unsigned int index, T val
 		sizeof(T)
 	);
 
-	if (first) {
-
-		s = potentialS; e = potentialE;
-		first = false;
-
-	}
-	else {
-
-		if (potentialS < s) s = potentialS;
-		if (potentialE > e) e = potentialE;
-
-	}
+	markAsChanged(potentialS, potentialE);
 
 }
 
@@ -14,6 +14,50 @@ unsigned int GL::ProgramUniforms::getUniformCount(const char* name, GL::UniformT
 
 }
 
+void GL::ProgramUniforms::useHashedLookup(bool use) {
+
+	if (!isInitialized()) throw Exception("Attempt to call useHashedLookup() on an uninitialized ProgramUniforms object.");
+	if (use == usesHashedLookup()) return;
+
+	if (use) {
+
+		hashes = new unsigned int[numUniforms];
+		for (unsigned int i = 0u; i < numUniforms; i++) hashes[i] = hashName(uniforms[i]);
+
+	}
+	else {
+
+		delete[] hashes;
+		hashes = nullptr;
+
+	}
+
+}
+
+bool GL::ProgramUniforms::usesHashedLookup() const { return hashes; }
+
+unsigned int GL::ProgramUniforms::findUniform(const char* name) const {
+
+	if (hashes) {
+
+		unsigned int hash = hashName(name);
+		for (unsigned int i = 0u; i < numUniforms; i++) if (hashes[i] == hash && !std::strcmp(name, uniforms[i])) return i;
+
+	}
+	else for (unsigned int i = 0u; i < numUniforms; i++) if (!std::strcmp(name, uniforms[i])) return i;
+
+	return numUniforms;
+
+}
+
+unsigned int GL::ProgramUniforms::hashName(const char* name) {
+
+	unsigned int hash = 2166136261u;
+	for (; *name; name++) hash = (hash ^ (unsigned char)*name) * 16777619u;
+	return hash;
+
+}
+
 GL::ProgramUniforms::~ProgramUniforms() {
 
 	if (uniforms) {
@@ -24,6 +68,7 @@ GL::ProgramUniforms::~ProgramUniforms() {
 		delete[] strides;
 		delete[] numElements;
 		if (IDs) delete[] IDs;
+		if (hashes) delete[] hashes;
 		if (data) delete[] data;
 
 	}
@@ -6,6 +6,7 @@
 #include "./../util/GL-math.hpp"
 #include "./../util/enums.hpp"
 #include "./../util/util.hpp"
+#include "./UniformHandle.hpp"
 
 namespace GL {
 
@@ -19,6 +20,12 @@ namespace GL {
 
 		unsigned int getUniformCount(const char* name, UniformType dtype) const;
 
+		// Looks names up by their FNV-1a hash first, so only a matching name is compared as a string.
+		// Worth it for tables with many variables that are set by names only known at run time.
+		void useHashedLookup(bool use);
+
+		bool usesHashedLookup() const;
+
 		virtual void update() = 0;
 
 		~ProgramUniforms();
@@ -31,6 +38,7 @@ namespace GL {
 		unsigned int* strides = nullptr;
 		unsigned int* numElements = nullptr;
 		GLint* IDs = nullptr;
+		unsigned int* hashes = nullptr;
 		unsigned int numUniforms = 0u;
 		unsigned int s, e;
 		bool first = true;
@@ -52,6 +60,10 @@ namespace GL {
 
 		void addUniform_commonCode(unsigned int idx, unsigned int& offset, const char* name, UniformType dtype, unsigned int count);
 
+		unsigned int findUniform(const char* name) const;
+
+		static unsigned int hashName(const char* name);
+
 	};
 
 }
@@ -0,0 +1,43 @@
+#ifndef UNIFORMHANDLE_HPP
+#define UNIFORMHANDLE_HPP
+
+namespace GL {
+
+	class UniformTable;
+	class BufferTable;
+
+	// A variable of a UniformTable or BufferTable that was looked up once by name (see their handle functions),
+	// so getting and setting it goes straight to its storage. The name and type are checked once when the handle is created,
+	// the owner and array index checks on every access run only in debug builds.
+	template <typename T>
+	class UniformHandle {
+	public:
+
+		typedef T Type;
+
+		bool isValid() const { return owner; }
+
+	private:
+
+		const void* owner = nullptr;
+		unsigned int index = 0u;
+
+		friend class UniformTable;
+		friend class BufferTable;
+
+	};
+
+}
+
+#ifdef NDEBUG
+#define _GL_UniformHandle_check(handle, function)
+#define _GL_UniformHandle_checkElement(handle, element, function)
+#else
+#define _GL_UniformHandle_check(handle, function) \
+if (handle.owner != (const void*)this) throw Exception("Invalid handle passed to the " # function " function (it is empty or belongs to another table).");
+#define _GL_UniformHandle_checkElement(handle, element, function) \
+_GL_UniformHandle_check(handle, function) \
+if (element >= numElements[handle.index]) throw Exception("Invalid array index " + std::to_string(element) + " passed to the " # function " function (variable name was \"" + std::string(uniforms[handle.index]) + "\").");
+#endif
+
+#endif
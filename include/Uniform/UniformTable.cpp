@@ -85,21 +85,7 @@ void GL::UniformTable::update_commonCode(unsigned int progID) {
 
 }
 
-unsigned int GL::UniformTable::get_commonCode(const char* name) const {
-
-	unsigned int idx = numUniforms;
-	for (unsigned int i = 0u; i < numUniforms; i++)
-
-		if (!strcmp(name, uniforms[i])) {
-
-			idx = i;
-			break;
-
-		}
-
-	return idx;
-
-}
+unsigned int GL::UniformTable::get_commonCode(const char* name) const { return findUniform(name); }
 
  void GL::UniformTable::updateSE(unsigned int idx) {
 
@@ -27,6 +27,21 @@ namespace GL {
 		template <typename T>
 		void setElement(const char* name, unsigned int index, T value);
 
+		template <typename T>
+		UniformHandle<T> handle(const char* name) const;
+
+		template <typename T>
+		T get(UniformHandle<T> handle) const;
+
+		template <typename T>
+		void set(UniformHandle<T> handle, typename UniformHandle<T>::Type value);
+
+		template <typename T>
+		T getElement(UniformHandle<T> handle, unsigned int index) const;
+
+		template <typename T>
+		void setElement(UniformHandle<T> handle, unsigned int index, typename UniformHandle<T>::Type value);
+
 		void update();
 
 		void update(Program& program);
@@ -93,4 +108,59 @@ void GL::UniformTable::setElement(const char* name, unsigned int index, T value)
 
 }
 
+template <typename T>
+GL::UniformHandle<T> GL::UniformTable::handle(const char* name) const {
+
+	if (!isInitialized()) throw Exception("Attempt to get a handle to the uniform \"" + std::string(name) + "\" from an uninitialized uniform table.");
+
+	unsigned int idx = get_commonCode(name);
+
+	if (idx == numUniforms) throw Exception("Invalid uniform name \"" + std::string(name) + "\" passed to uniform table's handle function.");
+	if (!typeIsValid<T>(types[idx])) throw Exception("Invalid data type passed to uniform table's handle function (uniform name passed was \"" + std::string(name) + "\").");
+
+	UniformHandle<T> ret;
+	ret.owner = this;
+	ret.index = idx;
+	return ret;
+
+}
+
+template <typename T>
+T GL::UniformTable::get(GL::UniformHandle<T> handle) const {
+
+	_GL_UniformHandle_check(handle, get);
+
+	return *(T*)(data + offsets[handle.index]);
+
+}
+
+template <typename T>
+void GL::UniformTable::set(GL::UniformHandle<T> handle, typename GL::UniformHandle<T>::Type value) {
+
+	_GL_UniformHandle_check(handle, set);
+
+	updateSE(handle.index);
+	*(T*)(data + offsets[handle.index]) = value;
+
+}
+
+template <typename T>
+T GL::UniformTable::getElement(GL::UniformHandle<T> handle, unsigned int index) const {
+
+	_GL_UniformHandle_checkElement(handle, index, getElement);
+
+	return *(T*)(data + offsets[handle.index] + index * strides[handle.index]);
+
+}
+
+template <typename T>
+void GL::UniformTable::setElement(GL::UniformHandle<T> handle, unsigned int index, typename GL::UniformHandle<T>::Type value) {
+
+	_GL_UniformHandle_checkElement(handle, index, setElement);
+
+	updateSE(handle.index);
+	*(T*)(data + offsets[handle.index] + index * strides[handle.index]) = value;
+
+}
+
 #endif
\ No newline at end of file
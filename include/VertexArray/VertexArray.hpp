@@ -40,6 +40,8 @@ namespace GL {
 
 		void setElementBuffer(StaticElementBuffer& buffer);
 		void setElementBuffer(DynamicElementBuffer& buffer);
+		void setElementBuffer(StaticElementBuffer16& buffer);
+		void setElementBuffer(DynamicElementBuffer16& buffer);
 		
 		void draw(int start, unsigned int numVertices, DrawMode mode = DrawMode::TRIANGLES, bool instanced = false, unsigned int numInstances = 1u) const;
 		void draw(int start = 0, DrawMode mode = DrawMode::TRIANGLES, bool instanced = false, unsigned int numInstances = 1u) const;
@@ -69,6 +71,7 @@ namespace GL {
 
 		GLuint vao = 0u;
 		unsigned int numEls = 0u;
+		GLenum elementType = GL_UNSIGNED_INT;
 		unsigned int len = 0u;
 		bool hasAttributes = false;
 
@@ -113,6 +116,7 @@ void GL::VertexArray<S>::setElementBuffer(StaticElementBuffer& buffer) {
 	glBindVertexArray(vao);
 	buffer.bind();
 	numEls = buffer.getLength();
+	elementType = GL_UNSIGNED_INT;
 
 }
 
@@ -122,6 +126,27 @@ void GL::VertexArray<S>::setElementBuffer(DynamicElementBuffer& buffer) {
 	glBindVertexArray(vao);
 	buffer.bind();
 	numEls = buffer.getLength();
+	elementType = GL_UNSIGNED_INT;
+
+}
+
+template <typename S>
+void GL::VertexArray<S>::setElementBuffer(StaticElementBuffer16& buffer) {
+
+	glBindVertexArray(vao);
+	buffer.bind();
+	numEls = buffer.getLength();
+	elementType = GL_UNSIGNED_SHORT;
+
+}
+
+template <typename S>
+void GL::VertexArray<S>::setElementBuffer(DynamicElementBuffer16& buffer) {
+
+	glBindVertexArray(vao);
+	buffer.bind();
+	numEls = buffer.getLength();
+	elementType = GL_UNSIGNED_SHORT;
 
 }
 
@@ -193,8 +218,8 @@ void GL::VertexArray<S>::drawElements(unsigned int numVertices, DrawMode mode, b
 
 	glBindVertexArray(vao);
 
-	if (instanced) glDrawElementsInstanced(_util::drawModes[(int)mode], numVertices, GL_UNSIGNED_INT, nullptr, numInstances);
-	else glDrawElements(_util::drawModes[(int)mode], numVertices, GL_UNSIGNED_INT, nullptr);
+	if (instanced) glDrawElementsInstanced(_util::drawModes[(int)mode], numVertices, elementType, nullptr, numInstances);
+	else glDrawElements(_util::drawModes[(int)mode], numVertices, elementType, nullptr);
 
 }
 
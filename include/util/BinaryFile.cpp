@@ -1,11 +1,21 @@
 
 #include "./BinaryFile.hpp"
 
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
 bool ReadBinaryFile::isEOF() { return (pos >= fileLength); }
 
 int ReadBinaryFile::getFileLength() { return fileLength; }
 
-ReadBinaryFile::ReadBinaryFile(const char* filepath, int buffer_size) : file(filepath, std::ios::binary) {
+ReadBinaryFile::ReadBinaryFile(const char* filepath, int buffer_size, bool memoryMapped) : file(filepath, std::ios::binary) {
 
 	if (!file.is_open()) throw GL::Exception("Failed to read binary file from filepath \"" + std::string(filepath) + "\".");
 
@@ -15,21 +25,52 @@ ReadBinaryFile::ReadBinaryFile(const char* filepath, int buffer_size) : file(fil
 	file.seekg(0, file.beg);
 	fileLength -= file.tellg();
 
-	bufferSize = buffer_size;
-	buffer = new char[bufferSize];
 	pos = 0;
 	bytePos = 0;
 	bitPos = 0;
 
-	file.read(buffer, bufferSize);
-
 	uint16_t x = 1u;
 	isLittleEndian = *((uint8_t*)&x) == 1u;
 
+	if (memoryMapped) {
+
+		file.close();
+		mapFile(filepath);
+		return;
+
+	}
+
+	bufferSize = buffer_size;
+	buffer = new char[bufferSize];
+
+	file.read(buffer, bufferSize);
+
 }
 
+bool ReadBinaryFile::isMemoryMapped() const { return !buffer; }
+
+bool ReadBinaryFile::isZeroCopy() const { return !buffer && isLittleEndian; }
+
 bool ReadBinaryFile::readBit() {
 
+	if (!buffer) {
+
+		checkMappedRead(1u);
+
+		bool bit = (bool)((((uint8_t)mapping[pos]) >> bitPos) % 2);
+		bitPos++;
+
+		if (bitPos == 8) {
+
+			bitPos = 0;
+			pos++;
+
+		}
+
+		return bit;
+
+	}
+
 	bool bit = (bool)((((uint8_t)buffer[bytePos]) >> bitPos) % 2);
 	bitPos++;
 
@@ -53,6 +94,20 @@ bool ReadBinaryFile::readBit() {
 
 char ReadBinaryFile::readByte() {
 
+	if (!buffer) {
+
+		if (bitPos > 0) {
+
+			bitPos = 0;
+			pos++;
+
+		}
+
+		checkMappedRead(1u);
+		return mapping[pos++];
+
+	}
+
 	if (bitPos > 0) {
 
 		bitPos = 0;
@@ -82,10 +137,157 @@ char ReadBinaryFile::readByte() {
 
 }
 
+const char* ReadBinaryFile::view(unsigned int numBytes) {
+
+	if (bitPos > 0) {
+
+		bitPos = 0;
+		pos++;
+
+		if (buffer) {
+
+			bytePos++;
+			if (bytePos == bufferSize) {
+
+				bytePos = 0;
+				file.read(buffer, bufferSize);
+
+			}
+
+		}
+
+	}
+
+	if (!buffer) {
+
+		checkMappedRead(numBytes);
+
+		const char* data = mapping + pos;
+		pos += numBytes;
+		return data;
+
+	}
+
+	reserveScratch(numBytes);
+
+	unsigned int numCopied = 0u;
+	while (numCopied < numBytes) {
+
+		unsigned int numAvailable = (unsigned int)(bufferSize - bytePos);
+		unsigned int numToCopy = (numBytes - numCopied < numAvailable) ? numBytes - numCopied : numAvailable;
+
+		std::memcpy(scratch + numCopied, buffer + bytePos, numToCopy);
+		numCopied += numToCopy;
+		pos += numToCopy;
+		bytePos += numToCopy;
+
+		if (bytePos == bufferSize) {
+
+			bytePos = 0;
+			file.read(buffer, bufferSize);
+
+		}
+
+	}
+
+	return scratch;
+
+}
+
+int ReadBinaryFile::getPosition() const { return pos; }
+
+void ReadBinaryFile::seek(int position) {
+
+	if (position < 0 || position > fileLength) throw GL::Exception("Attempt to seek to position " + std::to_string(position) + " in a binary file of length " + std::to_string(fileLength) + ".");
+
+	pos = position;
+	bitPos = 0;
+
+	if (buffer) {
+
+		bytePos = 0;
+		file.clear();
+		file.seekg(position, file.beg);
+		file.read(buffer, bufferSize);
+
+	}
+
+}
+
+void ReadBinaryFile::align(int alignment) {
+
+	if (bitPos > 0) view(0u);
+	view((unsigned int)((alignment - pos % alignment) % alignment));
+
+}
+
 ReadBinaryFile::~ReadBinaryFile() {
 
-	file.close();
-	delete[] buffer;
+	if (buffer) {
+
+		file.close();
+		delete[] buffer;
+
+	}
+
+#ifdef _WIN32
+	if (mapping) UnmapViewOfFile(mapping);
+	if (mappingHandle) CloseHandle((HANDLE)mappingHandle);
+	if (fileHandle) CloseHandle((HANDLE)fileHandle);
+#else
+	if (mapping) munmap((void*)mapping, (size_t)fileLength);
+#endif
+
+	if (scratch) delete[] scratch;
+
+}
+
+void ReadBinaryFile::mapFile(const char* filepath) {
+
+	if (fileLength == 0) return;
+
+#ifdef _WIN32
+	fileHandle = (void*)CreateFileA(filepath, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if ((HANDLE)fileHandle == INVALID_HANDLE_VALUE) { fileHandle = nullptr; throw GL::Exception("Failed to open binary file \"" + std::string(filepath) + "\" for memory mapping."); }
+
+	mappingHandle = (void*)CreateFileMappingA((HANDLE)fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mappingHandle) mapping = (const char*)MapViewOfFile((HANDLE)mappingHandle, FILE_MAP_READ, 0, 0, 0);
+
+	if (!mapping) {
+
+		if (mappingHandle) CloseHandle((HANDLE)mappingHandle);
+		CloseHandle((HANDLE)fileHandle);
+		throw GL::Exception("Failed to memory map binary file \"" + std::string(filepath) + "\".");
+
+	}
+#else
+	int fd = open(filepath, O_RDONLY);
+	if (fd < 0) throw GL::Exception("Failed to open binary file \"" + std::string(filepath) + "\" for memory mapping.");
+
+	void* addr = mmap(nullptr, (size_t)fileLength, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+
+	if (addr == MAP_FAILED) throw GL::Exception("Failed to memory map binary file \"" + std::string(filepath) + "\".");
+	madvise(addr, (size_t)fileLength, MADV_SEQUENTIAL);
+
+	mapping = (const char*)addr;
+#endif
+
+}
+
+void ReadBinaryFile::reserveScratch(unsigned int numBytes) {
+
+	if (numBytes <= scratchSize) return;
+
+	if (scratch) delete[] scratch;
+	scratch = new char[numBytes];
+	scratchSize = numBytes;
+
+}
+
+void ReadBinaryFile::checkMappedRead(unsigned int numBytes) {
+
+	if (pos > fileLength || numBytes > (unsigned int)(fileLength - pos)) throw GL::Exception("Attempt to read " + std::to_string(numBytes) + " bytes beyond the end of a memory-mapped binary file.");
 
 }
 
@@ -169,6 +371,12 @@ void WriteBinaryFile::writeRawData(char* data, int numElements) {
 
 }
 
+void WriteBinaryFile::align(int alignment) {
+
+	while (fileSize % alignment) writeByte(0);
+
+}
+
 void WriteBinaryFile::forceBufferWrite() {
 
 	if (bitPos > 0) {
@@ -2,6 +2,7 @@
 #define BINARY_FILE_HPP
 
 #include <fstream>
+#include <cstring>
 #include <stdint.h>
 #include "./Exception.hpp"
 
@@ -12,7 +13,11 @@ public:
 	
 	int getFileLength();
 
-	ReadBinaryFile(const char* filepath, int buffer_size = 1024);
+	ReadBinaryFile(const char* filepath, int buffer_size = 1024, bool memoryMapped = false);
+
+	bool isMemoryMapped() const;
+
+	bool isZeroCopy() const;
 
 	bool readBit();
 
@@ -21,19 +26,46 @@ public:
 	template <typename T>
 	T read();
 
+	// Returns a pointer to the next count elements of type T and advances past them.
+	// When isZeroCopy() is true the pointer points straight into the mapping and stays valid for the lifetime of the reader;
+	// otherwise the data is copied into an internal buffer that is only valid until the next call to readSpan or view.
+	template <typename T>
+	const T* readSpan(unsigned int count);
+
+	const char* view(unsigned int numBytes);
+
+	int getPosition() const;
+
+	void seek(int position);
+
+	void align(int alignment);
+
 	~ReadBinaryFile();
 
 private:
 
 	std::ifstream file;
 	int fileLength;
-	char* buffer;
+	char* buffer = nullptr;
 	int bufferSize;
 	int pos;
 	int bytePos;
 	int bitPos;
 	bool isLittleEndian;
 
+	const char* mapping = nullptr;
+	void* fileHandle = nullptr;
+	void* mappingHandle = nullptr;
+
+	char* scratch = nullptr;
+	unsigned int scratchSize = 0u;
+
+	void mapFile(const char* filepath);
+
+	void reserveScratch(unsigned int numBytes);
+
+	void checkMappedRead(unsigned int numBytes);
+
 };
 
 class WriteBinaryFile {
@@ -52,6 +84,11 @@ public:
 
 	void writeRawData(char* data, int numElements);
 
+	void align(int alignment);
+
+	template <typename T>
+	void writeAt(int position, T val);
+
 	void forceBufferWrite();
 
 	~WriteBinaryFile();
@@ -74,6 +111,30 @@ T ReadBinaryFile::read() {
 	if (sizeof(T) == 1)
 		return (T)readByte();
 
+	else if (!buffer) {
+
+		if (bitPos > 0) {
+
+			bitPos = 0;
+			pos++;
+
+		}
+
+		checkMappedRead(sizeof(T));
+
+		union {
+			T a;
+			char b[sizeof(T)];
+		} src;
+
+		if (isLittleEndian) std::memcpy(src.b, mapping + pos, sizeof(T));
+		else for (unsigned int i = 0u; i < sizeof(T); i++) src.b[i] = mapping[pos + sizeof(T) - 1u - i];
+
+		pos += sizeof(T);
+		return src.a;
+
+	}
+
 	else {
 
 		if (bitPos > 0) {
@@ -127,6 +188,32 @@ T ReadBinaryFile::read() {
 	}
 }
 
+template <typename T>
+const T* ReadBinaryFile::readSpan(unsigned int count) {
+
+	const char* bytes = view(count * sizeof(T));
+	if (isLittleEndian || sizeof(T) == 1) return (const T*)bytes;
+
+	if (bytes != scratch) {
+
+		reserveScratch(count * sizeof(T));
+		std::memcpy(scratch, bytes, count * sizeof(T));
+
+	}
+
+	for (unsigned int i = 0u; i < count; i++)
+		for (unsigned int j = 0u; j < sizeof(T) / 2u; j++) {
+
+			char temp = scratch[i * sizeof(T) + j];
+			scratch[i * sizeof(T) + j] = scratch[i * sizeof(T) + sizeof(T) - 1u - j];
+			scratch[i * sizeof(T) + sizeof(T) - 1u - j] = temp;
+
+		}
+
+	return (const T*)scratch;
+
+}
+
 template <typename T>
 void WriteBinaryFile::write(T val) {
 
@@ -186,4 +273,24 @@ void WriteBinaryFile::write(T val) {
 	}
 }
 
-#endif
\ No newline at end of file
+template <typename T>
+void WriteBinaryFile::writeAt(int position, T val) {
+
+	forceBufferWrite();
+
+	union {
+		T a;
+		char b[sizeof(T)];
+	} src;
+	src.a = val;
+
+	char dst[sizeof(T)];
+	for (unsigned int i = 0u; i < sizeof(T); i++) dst[i] = (isLittleEndian) ? src.b[i] : src.b[sizeof(T) - 1u - i];
+
+	file.seekp(position, file.beg);
+	file.write(dst, sizeof(T));
+	file.seekp(0, file.end);
+
+}
+
+#endif
\ No newline at end of file
@@ -14,7 +14,7 @@ namespace GL {
 		MAT2, DMAT2, MAT3, DMAT3, MAT4, DMAT4, MAT2x3, DMAT2x3, MAT2x4, DMAT2x4, MAT3x2, DMAT3x2, MAT3x4, DMAT3x4, MAT4x2, DMAT4x2, MAT4x3, DMAT4x3,
 		SAMPLER = INT
 	};
-	enum class ShaderType { VERTEX, FRAGMENT, COMPUTE };
+	enum class ShaderType { VERTEX, FRAGMENT, COMPUTE, GEOMETRY };
 	enum class AccessType { READ_ONLY, WRITE_ONLY, READ_WRITE };
 	enum class CullMode { NONE, FRONT_FACE, BACK_FACE };
 	enum class TextureType { ALBEDO, NORMAL, METALLIC, ROUGHNESS };
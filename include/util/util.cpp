@@ -1,3 +1,4 @@
+#include <cstring>
 
 #include "./util.hpp"
 
@@ -87,6 +88,9 @@ GLint GL::_util::maxShaderBufferBindings = 0;
 GLint GL::_util::maxComputeWorkGroupSize[3] = { 0, 0, 0 };
 GLint GL::_util::maxComputeWorkGroupCount[3] = { 0, 0, 0 };
 GLint GL::_util::maxComputeWorkGroupInvocations = 0;
+GLint GL::_util::uniformBufferOffsetAlignment = 0;
+GLint GL::_util::shaderBufferOffsetAlignment = 0;
+bool GL::_util::hasBufferStorage = false;
 GLuint GL::_util::dummyVao = 0;
 
 void* GL::_util::cubeMapIrradianceProgram = nullptr;
@@ -145,6 +149,8 @@ GL::_util::_util() {
 		for (unsigned int i = 0u; i < 3u; i++) glGetIntegeri_v(GL_MAX_COMPUTE_WORK_GROUP_SIZE, 0, &maxComputeWorkGroupSize[i]);
 		for (unsigned int i = 0u; i < 3u; i++) glGetIntegeri_v(GL_MAX_COMPUTE_WORK_GROUP_COUNT, 0, &maxComputeWorkGroupCount[i]);
 		glGetIntegerv(GL_MAX_COMPUTE_WORK_GROUP_INVOCATIONS, &maxComputeWorkGroupInvocations);
+		glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uniformBufferOffsetAlignment);
+		glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &shaderBufferOffsetAlignment);
 		glGenVertexArrays(1, &dummyVao);
 		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 
@@ -155,6 +161,11 @@ GL::_util::_util() {
 		if (!version[2]) throw Exception("Failed to check OpenGL minor version.");
 		if ((int)version[2] - (int)'3' < 0) throw Exception("OpenGL version must be 4.3 or greater.");
 
+		hasBufferStorage = (int)version[2] - (int)'4' >= 0;
+		GLint numExtensions = 0;
+		glGetIntegerv(GL_NUM_EXTENSIONS, &numExtensions);
+		for (GLint i = 0; i < numExtensions && !hasBufferStorage; i++) hasBufferStorage = !strcmp((const char*)glGetStringi(GL_EXTENSIONS, i), "GL_ARB_buffer_storage");
+
 	}
 
 }
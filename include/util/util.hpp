@@ -43,6 +43,9 @@ namespace GL {
 		static GLint maxComputeWorkGroupSize[3];
 		static GLint maxComputeWorkGroupCount[3];
 		static GLint maxComputeWorkGroupInvocations;
+		static GLint uniformBufferOffsetAlignment;
+		static GLint shaderBufferOffsetAlignment;
+		static bool hasBufferStorage;
 		static GLuint dummyVao;
 
 		static void* cubeMapIrradianceProgram;
@@ -0,0 +1,73 @@
+#include <iostream>
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include "Model/Model_types.hpp"
+
+// Compares the keyframe lookups of Animation: the linear scan it used to do, the binary search and the binary search with a
+// cached cursor, for sequential playback and for random seeks on one long channel.
+
+#define _GL_BenchKeyframes_numKeys 5000u
+#define _GL_BenchKeyframes_numLookups 1000000u
+
+unsigned int findTimestampIndexLinear(float t, float* timestamps, unsigned int numTimestamps) {
+
+    for (unsigned int i = 0u; i < numTimestamps; i++) if (timestamps[i] > t) return i;
+    return 0u;
+
+}
+
+template <typename F>
+double timeLookups(const std::vector<float>& times, F lookup, unsigned long long& checksum) {
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (unsigned int i = 0u; i < times.size(); i++) checksum += lookup(times[i]);
+
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+}
+
+int main() {
+
+    std::vector<float> timestamps(_GL_BenchKeyframes_numKeys);
+    for (unsigned int i = 0u; i < timestamps.size(); i++) timestamps[i] = (float)i;
+    float duration = timestamps.back();
+
+    std::vector<float> sequential(_GL_BenchKeyframes_numLookups);
+    for (unsigned int i = 0u; i < sequential.size(); i++) sequential[i] = duration * (float)i / (float)sequential.size();
+
+    std::mt19937 generator(0u);
+    std::uniform_real_distribution<float> distribution(0.0f, duration);
+    std::vector<float> random(_GL_BenchKeyframes_numLookups);
+    for (unsigned int i = 0u; i < random.size(); i++) random[i] = distribution(generator);
+
+    const std::vector<float>* workloads[] = { &sequential, &random };
+    const char* names[] = { "sequential playback", "random seeks" };
+
+    for (unsigned int w = 0u; w < 2u; w++) {
+
+        const std::vector<float>& times = *workloads[w];
+        unsigned long long linearSum = 0ull, binarySum = 0ull, cursorSum = 0ull;
+        unsigned int cursor = 0u;
+
+        double linear = timeLookups(times, [&](float t) { return findTimestampIndexLinear(t, timestamps.data(), timestamps.size()); }, linearSum);
+        double binary = timeLookups(times, [&](float t) { return GL::Model_types::Animation::findTimestampIndex(t, timestamps.data(), timestamps.size()); }, binarySum);
+        double cached = timeLookups(times, [&](float t) { return GL::Model_types::Animation::findTimestampIndex(t, timestamps.data(), timestamps.size(), cursor); }, cursorSum);
+
+        std::cout << names[w] << " (" << times.size() << " lookups, " << timestamps.size() << " keys):\n";
+        std::cout << "    linear scan:   " << linear << " ms\n";
+        std::cout << "    binary search: " << binary << " ms\n";
+        std::cout << "    cached cursor: " << cached << " ms\n";
+        if (linearSum != binarySum || linearSum != cursorSum) {
+
+            std::cout << "    Lookups returned different keys.\n";
+            return 1;
+
+        }
+
+    }
+
+    return 0;
+
+}
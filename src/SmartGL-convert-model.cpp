@@ -1,18 +1,52 @@
-
 #include <iostream>
+#include <cstdlib>
 
 #include "Model/ModelConverter.hpp"
 
 int main(int argc, char** argv) {
 
-    if (argc != 3) {
+    unsigned int fileVersion = _GL_ModelFile_version;
+    bool compactVertices = false;
+    bool optimizeVertexCache = true;
+    bool optimizeOverdraw = false;
+    unsigned int numLods = 0u;
+    bool validArguments = argc >= 3;
+
+    for (int i = 3; i < argc; i++) {
+
+        std::string option(argv[i]);
+        if (option == "--v1") fileVersion = 1u;
+        else if (option == "--compact") compactVertices = true;
+        else if (option == "--no-optimize") optimizeVertexCache = false;
+        else if (option == "--overdraw") optimizeOverdraw = true;
+        else if (option == "--lods" && i + 1 < argc) numLods = (unsigned int)std::strtoul(argv[++i], nullptr, 10);
+        else validArguments = false;
+
+    }
+
+    if (!validArguments) {
 
-        std::cout << "Invalid number of arguments. Usage: [input filename] [output filename]\n";
+        std::cout << "Invalid arguments. Usage: [input filename] [output filename] [--v1 (optional, writes the legacy file format)] [--compact (optional, stores quantized vertices)] [--no-optimize (optional, keeps the original triangle order)] [--overdraw (optional, also orders triangles to reduce overdraw)] [--lods N (optional, adds N simplified levels of detail per mesh)]\n";
         return 1;
 
     }
 
-    try { GL::ModelConverter converter(argv[1], argv[2]); }
+    try { 
+        
+        GL::ModelConverter converter(argv[1], argv[2], fileVersion, compactVertices, optimizeVertexCache, optimizeOverdraw && optimizeVertexCache, numLods);
+        const std::vector<GL::ModelConverter_types::MeshStatistics>& statistics = converter.getMeshStatistics();
+
+        for (unsigned int i = 0u; i < statistics.size(); i++) {
+
+            std::cout << "Mesh " << i << ": " << statistics[i].numVertices << " vertices, " << statistics[i].numTriangles << " triangles, ";
+            std::cout << "ACMR " << statistics[i].ACMRBefore << " -> " << statistics[i].ACMRAfter << ", ";
+            std::cout << "ATVR " << statistics[i].ATVRBefore << " -> " << statistics[i].ATVRAfter;
+            for (unsigned int j = 0u; j < statistics[i].lodTriangles.size(); j++) std::cout << ", LOD " << j + 1u << ": " << statistics[i].lodTriangles[j] << " triangles";
+            std::cout << "\n";
+
+        }
+
+    }
     catch (GL::Exception e) { 
         
         std::cout << e.getMessage() << "\n";